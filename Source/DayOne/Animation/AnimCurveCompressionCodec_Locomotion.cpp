@@ -0,0 +1,282 @@
+#include "AnimCurveCompressionCodec_Locomotion.h"
+
+#include "Animation/AnimCompressionTypes.h"
+#include "Animation/AnimCurveTypes.h"
+
+namespace LocomotionCurveCodec
+{
+	// Set in a segment end for a linear piece.
+	static constexpr uint16 LinearFlag = 0x8000;
+	// Bump on every change to the stream or the encoder, so the derived data rebuilds.
+	static constexpr int32 Version = 1;
+
+	template <typename T>
+	FORCEINLINE T Read(const uint8*& Cursor)
+	{
+		T Value;
+		FMemory::Memcpy(&Value, Cursor, sizeof(T));
+		Cursor += sizeof(T);
+		return Value;
+	}
+
+	template <typename T>
+	FORCEINLINE void Write(TArray<uint8>& Stream, T Value)
+	{
+		const int32 Offset = Stream.AddUninitialized(sizeof(T));
+		FMemory::Memcpy(Stream.GetData() + Offset, &Value, sizeof(T));
+	}
+
+	// Value of the curve at Cursor at Frame, and move Cursor to the next curve.
+	FORCEINLINE float DecodeNext(const uint8*& Cursor, float Frame)
+	{
+		const int32 NumSegments = Read<uint16>(Cursor);
+		const int32 NumValues = Read<uint16>(Cursor);
+		const uint8* Ends = Cursor;
+		const uint8* Values = Ends + NumSegments * sizeof(uint16);
+		Cursor = Values + NumValues * sizeof(float);
+
+		int32 ValueIndex = 0;
+		float SegmentStart = 0.0f;
+		for (int32 Segment = 0; Segment < NumSegments; ++Segment)
+		{
+			const uint16 End = Read<uint16>(Ends);
+			const bool bLinear = (End & LinearFlag) != 0;
+			const float SegmentEnd = static_cast<float>(End & ~LinearFlag);
+			// Past the last frame, hold the last value.
+			if (Frame <= SegmentEnd || Segment == NumSegments - 1)
+			{
+				const uint8* Value = Values + ValueIndex * sizeof(float);
+				const float StartValue = Read<float>(Value);
+				if (!bLinear)
+				{
+					return StartValue;
+				}
+				const float EndValue = Read<float>(Value);
+				return FMath::Lerp(StartValue, EndValue, FMath::Clamp((Frame - SegmentStart) / (SegmentEnd - SegmentStart), 0.0f, 1.0f));
+			}
+			ValueIndex += bLinear ? 2 : 1;
+			SegmentStart = SegmentEnd;
+		}
+		return 0.0f;
+	}
+
+	FORCEINLINE void SkipNext(const uint8*& Cursor)
+	{
+		const int32 NumSegments = Read<uint16>(Cursor);
+		const int32 NumValues = Read<uint16>(Cursor);
+		Cursor += NumSegments * sizeof(uint16) + NumValues * sizeof(float);
+	}
+
+	// Are the samples between Start and End within MaxError of the line through both?
+	static bool FitsLine(TArrayView<const float> Samples, int32 Start, int32 End, float MaxError)
+	{
+		const float Step = 1.0f / static_cast<float>(End - Start);
+		for (int32 Frame = Start + 1; Frame < End; ++Frame)
+		{
+			const float Value = FMath::Lerp(Samples[Start], Samples[End], (Frame - Start) * Step);
+			if (FMath::Abs(Value - Samples[Frame]) > MaxError)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+UAnimCurveCompressionCodec_Locomotion::UAnimCurveCompressionCodec_Locomotion()
+{
+	MaxError = 0.001f;
+}
+
+#if WITH_EDITORONLY_DATA
+bool UAnimCurveCompressionCodec_Locomotion::Compress(const FCompressibleAnimData& AnimSeq, FAnimCurveCompressionResult& OutResult)
+{
+	using namespace LocomotionCurveCodec;
+
+	const TArray<FFloatCurve>& FloatCurves = AnimSeq.RawCurveData.FloatCurves;
+	const int32 NumFrames = FMath::Max(AnimSeq.NumberOfKeys, 1);
+	if (NumFrames > MaxFrames)
+	{
+		UE_LOG(LogTemp, Error, TEXT("UAnimCurveCompressionCodec_Locomotion: %s has %d frames, at most %d are supported"), *AnimSeq.Name, NumFrames, MaxFrames);
+		return false;
+	}
+	const float SequenceLength = static_cast<float>(AnimSeq.SequenceLength);
+	const float FrameRate = NumFrames > 1 && SequenceLength > 0.0f ? (NumFrames - 1) / SequenceLength : 0.0f;
+
+	TArray<uint8> Stream;
+	BeginStream(FrameRate, Stream);
+	TArray<float> Samples;
+	Samples.SetNumUninitialized(NumFrames);
+	for (const FFloatCurve& Curve : FloatCurves)
+	{
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			Samples[Frame] = Curve.FloatCurve.Eval(FrameRate > 0.0f ? Frame / FrameRate : 0.0f);
+		}
+		EncodeCurve(Samples, MaxError, Stream);
+	}
+
+	// Only the raw keys are known here. DayOne.Anim.CurveCodecReport compares with the codec a sequence used before.
+	int32 RawKeyBytes = 0;
+	for (const FFloatCurve& Curve : FloatCurves)
+	{
+		RawKeyBytes += Curve.FloatCurve.GetNumKeys() * sizeof(FRichCurveKey);
+	}
+	UE_LOG(LogTemp, Verbose, TEXT("UAnimCurveCompressionCodec_Locomotion: %s, %d curves x %d frames: %d bytes, raw keys %d bytes"),
+	       *AnimSeq.Name, FloatCurves.Num(), NumFrames, Stream.Num(), RawKeyBytes);
+
+	OutResult.CompressedBytes = MoveTemp(Stream);
+	OutResult.Codec = this;
+	return true;
+}
+
+#if UE_VERSION_OLDER_THAN(5, 1, 0)
+void UAnimCurveCompressionCodec_Locomotion::PopulateDDCKey(FArchive& Ar)
+{
+	Super::PopulateDDCKey(Ar);
+#else
+void UAnimCurveCompressionCodec_Locomotion::PopulateDDCKey(const UE::Anim::Compression::FAnimDDCKeyArgs& KeyArgs, FArchive& Ar)
+{
+	Super::PopulateDDCKey(KeyArgs, Ar);
+#endif
+
+	int32 Version = LocomotionCurveCodec::Version;
+	Ar << Version;
+	Ar << MaxError;
+}
+#endif
+
+void UAnimCurveCompressionCodec_Locomotion::BeginStream(float FrameRate, TArray<uint8>& OutStream)
+{
+	LocomotionCurveCodec::Write<float>(OutStream, FrameRate);
+}
+
+void UAnimCurveCompressionCodec_Locomotion::EncodeCurve(TArrayView<const float> Samples, float MaxError, TArray<uint8>& OutStream)
+{
+	using namespace LocomotionCurveCodec;
+
+	const int32 NumFrames = Samples.Num();
+	check(NumFrames > 0 && NumFrames <= MaxFrames);
+
+	TArray<uint16, TInlineAllocator<64>> Ends;
+	TArray<float, TInlineAllocator<128>> Values;
+	// First frame not covered yet, and the frame a linear piece would start from.
+	int32 Next = 0;
+	int32 Anchor = 0;
+	while (Next < NumFrames)
+	{
+		// Longest constant run from Next.
+		float Min = Samples[Next];
+		float Max = Samples[Next];
+		int32 ConstantEnd = Next;
+		while (ConstantEnd + 1 < NumFrames)
+		{
+			const float Sample = Samples[ConstantEnd + 1];
+			if (FMath::Max(Max, Sample) - FMath::Min(Min, Sample) > 2.0f * MaxError)
+			{
+				break;
+			}
+			Min = FMath::Min(Min, Sample);
+			Max = FMath::Max(Max, Sample);
+			++ConstantEnd;
+		}
+
+		// Longest linear piece from Anchor covering Next.
+		int32 LinearEnd = INDEX_NONE;
+		for (int32 End = FMath::Max(Next, Anchor + 1); End < NumFrames && FitsLine(Samples, Anchor, End, MaxError); ++End)
+		{
+			LinearEnd = End;
+		}
+
+		// Whichever costs fewer bytes per covered frame: a run is one end and one value, a piece one end and two values.
+		const int32 ConstantBytes = sizeof(uint16) + sizeof(float);
+		const int32 LinearBytes = sizeof(uint16) + 2 * sizeof(float);
+		if (LinearEnd != INDEX_NONE && LinearBytes * (ConstantEnd - Next + 1) < ConstantBytes * (LinearEnd - Next + 1))
+		{
+			Ends.Add(static_cast<uint16>(LinearEnd) | LinearFlag);
+			Values.Add(Samples[Anchor]);
+			Values.Add(Samples[LinearEnd]);
+			Next = LinearEnd + 1;
+			Anchor = LinearEnd;
+		}
+		else
+		{
+			Ends.Add(static_cast<uint16>(ConstantEnd));
+			Values.Add(0.5f * (Min + Max));
+			Next = ConstantEnd + 1;
+			Anchor = ConstantEnd;
+		}
+	}
+	check(Values.Num() <= MAX_uint16);
+
+	Write<uint16>(OutStream, static_cast<uint16>(Ends.Num()));
+	Write<uint16>(OutStream, static_cast<uint16>(Values.Num()));
+	for (const uint16 End : Ends)
+	{
+		Write<uint16>(OutStream, End);
+	}
+	for (const float Value : Values)
+	{
+		Write<float>(OutStream, Value);
+	}
+}
+
+void UAnimCurveCompressionCodec_Locomotion::DecodeCurves(const uint8* Stream, int32 NumCurves, float Time, float* OutValues)
+{
+	using namespace LocomotionCurveCodec;
+
+	const uint8* Cursor = Stream;
+	const float Frame = Time * Read<float>(Cursor);
+	for (int32 CurveIndex = 0; CurveIndex < NumCurves; ++CurveIndex)
+	{
+		OutValues[CurveIndex] = DecodeNext(Cursor, Frame);
+	}
+}
+
+float UAnimCurveCompressionCodec_Locomotion::DecodeCurve(const uint8* Stream, int32 CurveIndex, float Time)
+{
+	using namespace LocomotionCurveCodec;
+
+	const uint8* Cursor = Stream;
+	const float Frame = Time * Read<float>(Cursor);
+	for (int32 Index = 0; Index < CurveIndex; ++Index)
+	{
+		SkipNext(Cursor);
+	}
+	return DecodeNext(Cursor, Frame);
+}
+
+void UAnimCurveCompressionCodec_Locomotion::DecompressCurves(const FCompressedAnimSequence& AnimSeq, FBlendedCurve& Curves, float CurrentTime) const
+{
+	using namespace LocomotionCurveCodec;
+
+	const TArray<FSmartName>& CurveNames = AnimSeq.CompressedCurveNames;
+	if (CurveNames.Num() == 0)
+	{
+		return;
+	}
+
+	// One pass: every curve is decoded straight into the pose curves, or skipped if the pose does not use it.
+	const uint8* Cursor = AnimSeq.CompressedCurveByteStream.GetData();
+	const float Frame = CurrentTime * Read<float>(Cursor);
+	for (const FSmartName& CurveName : CurveNames)
+	{
+		if (Curves.IsEnabled(CurveName.UID))
+		{
+			Curves.Set(CurveName.UID, DecodeNext(Cursor, Frame));
+		}
+		else
+		{
+			SkipNext(Cursor);
+		}
+	}
+}
+
+float UAnimCurveCompressionCodec_Locomotion::DecompressCurve(const FCompressedAnimSequence& AnimSeq, SmartName::UID_Type CurveUID, float CurrentTime) const
+{
+	const int32 CurveIndex = AnimSeq.CompressedCurveNames.IndexOfByPredicate([CurveUID](const FSmartName& CurveName)
+	{
+		return CurveName.UID == CurveUID;
+	});
+	return CurveIndex != INDEX_NONE ? DecodeCurve(AnimSeq.CompressedCurveByteStream.GetData(), CurveIndex, CurrentTime) : 0.0f;
+}
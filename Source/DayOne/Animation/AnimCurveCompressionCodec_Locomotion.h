@@ -0,0 +1,54 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Animation/AnimCurveCompressionCodec.h"
+#include "Misc/EngineVersionComparison.h"
+#include "AnimCurveCompressionCodec_Locomotion.generated.h"
+
+/**
+ * Curve codec for the dense locomotion curve set of the ALS sequences (Layering_*, Enable_FootIK_*, FootLock_*, Mask_*, ...).
+ * Most of those curves are constant over long spans or step between a few values, the rest ramp between them,
+ * so every curve is sampled at the sequence frame rate and stored as a run of segments within MaxError of the samples:
+ * constant runs (one value) and linear pieces (two values). A step is a constant run starting right after a frame.
+ *
+ * Stream: float FrameRate, then per curve, in compressed curve name order:
+ * uint16 NumSegments, uint16 NumValues, uint16 SegmentEnds[NumSegments] (last frame, top bit set for linear), float Values[NumValues].
+ * A linear piece starts at the last frame of the segment before it (frame 0 for the first one), a constant run right after it.
+ * Decoding all curves is one forward pass over the stream, see DecodeCurves.
+ */
+UCLASS(meta = (DisplayName = "Locomotion Curves (Run Length + Piecewise Linear)"))
+class DAYONE_API UAnimCurveCompressionCodec_Locomotion : public UAnimCurveCompressionCodec
+{
+	GENERATED_BODY()
+
+public:
+	UAnimCurveCompressionCodec_Locomotion();
+
+	// Largest difference allowed between a decoded and a sampled value.
+	UPROPERTY(EditAnywhere, Category = "Compression", meta = (ClampMin = "0"))
+	float MaxError;
+
+#if WITH_EDITORONLY_DATA
+	virtual bool Compress(const FCompressibleAnimData& AnimSeq, FAnimCurveCompressionResult& OutResult) override;
+#if UE_VERSION_OLDER_THAN(5, 1, 0)
+	virtual void PopulateDDCKey(FArchive& Ar) override;
+#else
+	virtual void PopulateDDCKey(const UE::Anim::Compression::FAnimDDCKeyArgs& KeyArgs, FArchive& Ar) override;
+#endif
+#endif
+
+	virtual void DecompressCurves(const FCompressedAnimSequence& AnimSeq, FBlendedCurve& Curves, float CurrentTime) const override;
+	virtual float DecompressCurve(const FCompressedAnimSequence& AnimSeq, SmartName::UID_Type CurveUID, float CurrentTime) const override;
+
+	// Segment ends keep 15 bits for the frame, and the value count of a curve fits 16 bits below this.
+	static constexpr int32 MaxFrames = 0x7FFF;
+
+	// Start OutStream for curves sampled at FrameRate frames per second, EncodeCurve then appends them in order.
+	static void BeginStream(float FrameRate, TArray<uint8>& OutStream);
+	// Append the segments of one curve sampled at every frame to OutStream.
+	static void EncodeCurve(TArrayView<const float> Samples, float MaxError, TArray<uint8>& OutStream);
+	// Value of every curve of Stream at Time, in one pass.
+	static void DecodeCurves(const uint8* Stream, int32 NumCurves, float Time, float* OutValues);
+	// Value of one curve of Stream at Time, skips the curves before it.
+	static float DecodeCurve(const uint8* Stream, int32 CurveIndex, float Time);
+};
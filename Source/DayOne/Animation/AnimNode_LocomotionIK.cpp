@@ -0,0 +1,104 @@
+#include "AnimNode_LocomotionIK.h"
+
+#include "AnimationRuntime.h"
+#include "Animation/AnimInstanceProxy.h"
+#include "DayOne/Character/BaseAnimInstance.h"
+
+namespace
+{
+	// Add a world space translation and rotation to the component space transform of Bone.
+	FTransform AddWorldSpaceOffset(FComponentSpacePoseContext& Output, FCompactPoseBoneIndex Bone, const FVector& Translation, const FRotator& Rotation)
+	{
+		const FTransform& ComponentTransform = Output.AnimInstanceProxy->GetComponentTransform();
+		FTransform BoneTransform = Output.Pose.GetComponentSpaceTransform(Bone);
+
+		FAnimationRuntime::ConvertCSTransformToBoneSpace(ComponentTransform, Output.Pose, BoneTransform, Bone, BCS_WorldSpace);
+		BoneTransform.AddToTranslation(Translation);
+		BoneTransform.SetRotation(FQuat(Rotation) * BoneTransform.GetRotation());
+		FAnimationRuntime::ConvertBoneSpaceTransformToCS(ComponentTransform, Output.Pose, BoneTransform, Bone, BCS_WorldSpace);
+
+		return BoneTransform;
+	}
+}
+
+void FAnimNode_LocomotionIKBase::UpdateInternal(const FAnimationUpdateContext& Context)
+{
+	Super::UpdateInternal(Context);
+
+	// UBaseAnimInstance always creates an FBaseAnimInstanceProxy, whose foot IK was written by this update.
+	const UBaseAnimInstance* AnimInstance = Cast<UBaseAnimInstance>(Context.AnimInstanceProxy->GetAnimInstanceObject());
+	Inputs = AnimInstance ? &static_cast<const FBaseAnimInstanceProxy*>(Context.AnimInstanceProxy)->FootIK : nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+void FAnimNode_FootLock::EvaluateSkeletalControl_AnyThread(FComponentSpacePoseContext& Output, TArray<FBoneTransform>& OutBoneTransforms)
+{
+	if (Inputs == nullptr) return;
+
+	const bool bLeft = Foot == EFootIKSide::Left;
+	const float LockAlpha = bLeft ? Inputs->FootLockLAlpha : Inputs->FootLockRAlpha;
+	if (LockAlpha <= 0.0f) return;
+
+	const FCompactPoseBoneIndex Bone = IKFootBone.GetCompactPoseIndex(Output.Pose.GetPose().GetBoneContainer());
+	const FTransform LockedTransform(bLeft ? Inputs->FootLockLRotation : Inputs->FootLockRRotation,
+	                                 bLeft ? Inputs->FootLockLLocation : Inputs->FootLockRLocation);
+
+	FTransform BoneTransform = Output.Pose.GetComponentSpaceTransform(Bone);
+	BoneTransform.SetTranslation(FMath::Lerp(BoneTransform.GetTranslation(), LockedTransform.GetTranslation(), LockAlpha));
+	BoneTransform.SetRotation(FQuat::Slerp(BoneTransform.GetRotation(), LockedTransform.GetRotation(), LockAlpha));
+	OutBoneTransforms.Add(FBoneTransform(Bone, BoneTransform));
+}
+
+bool FAnimNode_FootLock::IsValidToEvaluate(const USkeleton* Skeleton, const FBoneContainer& RequiredBones)
+{
+	return IKFootBone.IsValidToEvaluate(RequiredBones);
+}
+
+void FAnimNode_FootLock::InitializeBoneReferences(const FBoneContainer& RequiredBones)
+{
+	IKFootBone.Initialize(RequiredBones);
+}
+
+// -----------------------------------------------------------------------------
+
+void FAnimNode_FootOffset::EvaluateSkeletalControl_AnyThread(FComponentSpacePoseContext& Output, TArray<FBoneTransform>& OutBoneTransforms)
+{
+	if (Inputs == nullptr) return;
+
+	const bool bLeft = Foot == EFootIKSide::Left;
+	const FCompactPoseBoneIndex Bone = IKFootBone.GetCompactPoseIndex(Output.Pose.GetPose().GetBoneContainer());
+	OutBoneTransforms.Add(FBoneTransform(Bone, AddWorldSpaceOffset(Output, Bone,
+		bLeft ? Inputs->FootOffsetLLocation : Inputs->FootOffsetRLocation,
+		bLeft ? Inputs->FootOffsetLRotation : Inputs->FootOffsetRRotation)));
+}
+
+bool FAnimNode_FootOffset::IsValidToEvaluate(const USkeleton* Skeleton, const FBoneContainer& RequiredBones)
+{
+	return IKFootBone.IsValidToEvaluate(RequiredBones);
+}
+
+void FAnimNode_FootOffset::InitializeBoneReferences(const FBoneContainer& RequiredBones)
+{
+	IKFootBone.Initialize(RequiredBones);
+}
+
+// -----------------------------------------------------------------------------
+
+void FAnimNode_PelvisOffset::EvaluateSkeletalControl_AnyThread(FComponentSpacePoseContext& Output, TArray<FBoneTransform>& OutBoneTransforms)
+{
+	if (Inputs == nullptr || Inputs->PelvisAlpha <= 0.0f) return;
+
+	const FCompactPoseBoneIndex Bone = PelvisBone.GetCompactPoseIndex(Output.Pose.GetPose().GetBoneContainer());
+	OutBoneTransforms.Add(FBoneTransform(Bone, AddWorldSpaceOffset(Output, Bone, Inputs->PelvisOffset * Inputs->PelvisAlpha, FRotator::ZeroRotator)));
+}
+
+bool FAnimNode_PelvisOffset::IsValidToEvaluate(const USkeleton* Skeleton, const FBoneContainer& RequiredBones)
+{
+	return PelvisBone.IsValidToEvaluate(RequiredBones);
+}
+
+void FAnimNode_PelvisOffset::InitializeBoneReferences(const FBoneContainer& RequiredBones)
+{
+	PelvisBone.Initialize(RequiredBones);
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BoneContainer.h"
+#include "BoneControllers/AnimNode_SkeletalControlBase.h"
+#include "AnimNode_LocomotionIK.generated.h"
+
+struct FFootIKPoseInputs;
+
+UENUM()
+enum class EFootIKSide : uint8
+{
+	Left,
+	Right
+};
+
+// Base of the native foot IK nodes. Reads the foot IK results of UBaseAnimInstance straight from its proxy,
+// so the nodes have no pins to copy and the graph needs no property access or Blueprint thunk for them.
+USTRUCT(BlueprintInternalUseOnly)
+struct DAYONE_API FAnimNode_LocomotionIKBase : public FAnimNode_SkeletalControlBase
+{
+	GENERATED_BODY()
+
+protected:
+	virtual void UpdateInternal(const FAnimationUpdateContext& Context) override;
+
+	// Null when the anim instance is not a UBaseAnimInstance.
+	const FFootIKPoseInputs* Inputs = nullptr;
+};
+
+// Foot lock: blends the IK foot toward the locked component space transform by the foot lock alpha.
+USTRUCT(BlueprintInternalUseOnly)
+struct DAYONE_API FAnimNode_FootLock : public FAnimNode_LocomotionIKBase
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	FBoneReference IKFootBone;
+
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	EFootIKSide Foot = EFootIKSide::Left;
+
+	virtual void EvaluateSkeletalControl_AnyThread(FComponentSpacePoseContext& Output, TArray<FBoneTransform>& OutBoneTransforms) override;
+	virtual bool IsValidToEvaluate(const USkeleton* Skeleton, const FBoneContainer& RequiredBones) override;
+
+private:
+	virtual void InitializeBoneReferences(const FBoneContainer& RequiredBones) override;
+};
+
+// Foot offset: adds the world space foot offset location and rotation to the IK foot.
+USTRUCT(BlueprintInternalUseOnly)
+struct DAYONE_API FAnimNode_FootOffset : public FAnimNode_LocomotionIKBase
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	FBoneReference IKFootBone;
+
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	EFootIKSide Foot = EFootIKSide::Left;
+
+	virtual void EvaluateSkeletalControl_AnyThread(FComponentSpacePoseContext& Output, TArray<FBoneTransform>& OutBoneTransforms) override;
+	virtual bool IsValidToEvaluate(const USkeleton* Skeleton, const FBoneContainer& RequiredBones) override;
+
+private:
+	virtual void InitializeBoneReferences(const FBoneContainer& RequiredBones) override;
+};
+
+// Pelvis offset: adds the world space pelvis offset, scaled by the pelvis alpha.
+USTRUCT(BlueprintInternalUseOnly)
+struct DAYONE_API FAnimNode_PelvisOffset : public FAnimNode_LocomotionIKBase
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	FBoneReference PelvisBone;
+
+	virtual void EvaluateSkeletalControl_AnyThread(FComponentSpacePoseContext& Output, TArray<FBoneTransform>& OutBoneTransforms) override;
+	virtual bool IsValidToEvaluate(const USkeleton* Skeleton, const FBoneContainer& RequiredBones) override;
+
+private:
+	virtual void InitializeBoneReferences(const FBoneContainer& RequiredBones) override;
+};
@@ -0,0 +1,67 @@
+#include "AnimNode_MotionMatchingPlayer.h"
+
+#include "Animation/AnimInstanceProxy.h"
+#include "Animation/AnimSequence.h"
+#include "AnimNodes/AnimNode_Inertialization.h"
+#include "DayOne/Character/BaseAnimInstance.h"
+
+void FAnimNode_MotionMatchingPlayer::Initialize_AnyThread(const FAnimationInitializeContext& Context)
+{
+	FAnimNode_Base::Initialize_AnyThread(Context);
+	Source.Initialize(Context);
+	bWasActive = false;
+}
+
+void FAnimNode_MotionMatchingPlayer::CacheBones_AnyThread(const FAnimationCacheBonesContext& Context)
+{
+	Source.CacheBones(Context);
+}
+
+void FAnimNode_MotionMatchingPlayer::Update_AnyThread(const FAnimationUpdateContext& Context)
+{
+	GetEvaluateGraphExposedInputs().Execute(Context);
+
+	// UBaseAnimInstance always creates an FBaseAnimInstanceProxy, whose pose was picked by this update.
+	const UBaseAnimInstance* AnimInstance = Cast<UBaseAnimInstance>(Context.AnimInstanceProxy->GetAnimInstanceObject());
+	Inputs = AnimInstance ? &static_cast<const FBaseAnimInstanceProxy*>(Context.AnimInstanceProxy)->MotionMatching : nullptr;
+
+	const bool bActive = Inputs && Inputs->bActive;
+	if (bActive != bWasActive || (bActive && Inputs->bJumped))
+	{
+		if (UE::Anim::IInertializationRequester* InertializationRequester = Context.GetMessage<UE::Anim::IInertializationRequester>())
+		{
+			InertializationRequester->RequestInertialization(BlendTime);
+		}
+	}
+	bWasActive = bActive;
+
+	// The sequence is sampled at the explicit time, only the source needs its update.
+	if (!bActive)
+	{
+		Source.Update(Context);
+	}
+}
+
+void FAnimNode_MotionMatchingPlayer::Evaluate_AnyThread(FPoseContext& Output)
+{
+	if (!bWasActive)
+	{
+		Source.Evaluate(Output);
+		return;
+	}
+
+	// The capsule drives the character, the root motion of the database sequences is not extracted.
+	FAnimationPoseData AnimationPoseData(Output);
+	Inputs->Sequence->GetAnimationPose(AnimationPoseData, FAnimExtractContext(Inputs->Time, false));
+}
+
+void FAnimNode_MotionMatchingPlayer::GatherDebugData(FNodeDebugData& DebugData)
+{
+	FString DebugLine = DebugData.GetNodeName(this);
+	if (bWasActive)
+	{
+		DebugLine += FString::Printf(TEXT("(Sequence: %s Time: %.3f)"), *GetNameSafe(Inputs->Sequence), Inputs->Time);
+	}
+	DebugData.AddDebugItem(DebugLine);
+	Source.GatherDebugData(DebugData);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Animation/AnimNodeBase.h"
+#include "AnimNode_MotionMatchingPlayer.generated.h"
+
+struct FMotionMatchingPoseInputs;
+
+// Plays the pose motion matching picked in UBaseAnimInstance::UpdateMotionMatching, read straight from its proxy.
+// While motion matching is off it passes its source pose (the blended cycles) through.
+// Every jump, and every switch between the two, requests an inertialization, so an Inertialization node must follow it.
+USTRUCT(BlueprintInternalUseOnly)
+struct DAYONE_API FAnimNode_MotionMatchingPlayer : public FAnimNode_Base
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Links")
+	FPoseLink Source;
+
+	// Duration of the inertial blend requested on a jump.
+	UPROPERTY(EditAnywhere, Category = "Settings", meta = (ClampMin = "0"))
+	float BlendTime = 0.2f;
+
+	virtual void Initialize_AnyThread(const FAnimationInitializeContext& Context) override;
+	virtual void CacheBones_AnyThread(const FAnimationCacheBonesContext& Context) override;
+	virtual void Update_AnyThread(const FAnimationUpdateContext& Context) override;
+	virtual void Evaluate_AnyThread(FPoseContext& Output) override;
+	virtual void GatherDebugData(FNodeDebugData& DebugData) override;
+
+private:
+	// Null when the anim instance is not a UBaseAnimInstance.
+	const FMotionMatchingPoseInputs* Inputs = nullptr;
+	// Was the sequence played on the last update?
+	bool bWasActive = false;
+};
@@ -0,0 +1,155 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Animation/AnimSequence.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+#include "UObject/UObjectIterator.h"
+#include "DayOne/Animation/AnimCurveCompressionCodec_Locomotion.h"
+#include "DayOne/Math/Benchmark.h"
+
+#if !UE_BUILD_SHIPPING
+
+// Memory and decode time of the locomotion curve codec on every loaded sequence with curves, e.g.
+// DayOne -ExecCmds="DayOne.Anim.CurveCodecReport 10000"
+// A sequence compressed with another codec is re-encoded here from its decoded curves, and compared with its current stream.
+namespace LocomotionCurveCodecBenchmark
+{
+	// The curves of Sequence decoded by its current codec at every frame, encoded with the locomotion codec.
+	static bool Encode(const UAnimSequence& Sequence, float MaxError, TArray<uint8>& OutStream)
+	{
+		const FCompressedAnimSequence& CompressedData = Sequence.CompressedData;
+		const int32 NumFrames = FMath::Max(Sequence.GetNumberOfSampledKeys(), 1);
+		if (NumFrames > UAnimCurveCompressionCodec_Locomotion::MaxFrames)
+		{
+			return false;
+		}
+		const float PlayLength = Sequence.GetPlayLength();
+		const float FrameRate = NumFrames > 1 && PlayLength > 0.0f ? (NumFrames - 1) / PlayLength : 0.0f;
+
+		UAnimCurveCompressionCodec_Locomotion::BeginStream(FrameRate, OutStream);
+		TArray<float> Samples;
+		Samples.SetNumUninitialized(NumFrames);
+		for (const FSmartName& CurveName : CompressedData.CompressedCurveNames)
+		{
+			for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+			{
+				Samples[Frame] = CompressedData.CurveCompressionCodec->DecompressCurve(CompressedData, CurveName.UID, FrameRate > 0.0f ? Frame / FrameRate : 0.0f);
+			}
+			UAnimCurveCompressionCodec_Locomotion::EncodeCurve(Samples, MaxError, OutStream);
+		}
+		return true;
+	}
+
+	static void Run(const TArray<FString>& Args)
+	{
+		const int32 Iterations = FMath::Max(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1000, 1);
+		const float MaxError = GetDefault<UAnimCurveCompressionCodec_Locomotion>()->MaxError;
+
+		FRandomStream Random(DayOneBenchmark::Seed);
+		TArray<float> Times;
+		TArray<float> Values;
+		TArray<uint16> CurveUIDToIndex;
+		TArray<uint8> EncodedStream;
+		int64 TotalBytes = 0;
+		int64 TotalCurrentBytes = 0;
+		int32 NumSequences = 0;
+
+		UE_LOG(LogTemp, Display, TEXT("Locomotion curve codec (MaxError %g), %d decodes per sequence, against the current codec of each sequence:"),
+		       MaxError, Iterations);
+		for (TObjectIterator<UAnimSequence> It; It; ++It)
+		{
+			const UAnimSequence* Sequence = *It;
+			const FCompressedAnimSequence& CompressedData = Sequence->CompressedData;
+			const UAnimCurveCompressionCodec* CurrentCodec = CompressedData.CurveCompressionCodec;
+			const int32 NumCurves = CompressedData.CompressedCurveNames.Num();
+			if (!CurrentCodec || NumCurves == 0)
+			{
+				continue;
+			}
+
+			// Already compressed with the locomotion codec: its stream is measured as is, there is nothing to compare with.
+			const bool bLocomotionCodec = Cast<UAnimCurveCompressionCodec_Locomotion>(CurrentCodec) != nullptr;
+			EncodedStream.Reset();
+			if (!bLocomotionCodec && !Encode(*Sequence, MaxError, EncodedStream))
+			{
+				continue;
+			}
+			const uint8* Stream = bLocomotionCodec ? CompressedData.CompressedCurveByteStream.GetData() : EncodedStream.GetData();
+			const int32 Bytes = bLocomotionCodec ? CompressedData.CompressedCurveByteStream.Num() : EncodedStream.Num();
+			const int32 CurrentBytes = CompressedData.CompressedCurveByteStream.Num();
+
+			Times.SetNumUninitialized(Iterations);
+			for (float& Time : Times)
+			{
+				Time = Random.FRandRange(0.0f, Sequence->GetPlayLength());
+			}
+			Values.SetNumUninitialized(NumCurves);
+
+			// Pose curves enabling exactly the curves of the sequence, as the pose extraction fills them.
+			int32 MaxCurveUID = 0;
+			for (const FSmartName& CurveName : CompressedData.CompressedCurveNames)
+			{
+				MaxCurveUID = FMath::Max<int32>(MaxCurveUID, CurveName.UID);
+			}
+			CurveUIDToIndex.Init(MAX_uint16, MaxCurveUID + 1);
+			for (int32 CurveIndex = 0; CurveIndex < NumCurves; ++CurveIndex)
+			{
+				CurveUIDToIndex[CompressedData.CompressedCurveNames[CurveIndex].UID] = static_cast<uint16>(CurveIndex);
+			}
+			const SmartName::UID_Type LastCurveUID = CompressedData.CompressedCurveNames.Last().UID;
+			FBlendedCurve PoseCurves;
+			PoseCurves.InitFrom(&CurveUIDToIndex);
+
+			// Both codecs decode every curve of the sequence into the pose curves at every time, as DecompressCurves does.
+			const double PassNs = DayOneBenchmark::NanosecondsPerElement(Iterations, 1, [&]()
+			{
+				for (const float Time : Times)
+				{
+					UAnimCurveCompressionCodec_Locomotion::DecodeCurves(Stream, NumCurves, Time, Values.GetData());
+					for (int32 CurveIndex = 0; CurveIndex < NumCurves; ++CurveIndex)
+					{
+						PoseCurves.Set(CompressedData.CompressedCurveNames[CurveIndex].UID, Values[CurveIndex]);
+					}
+					DayOneBenchmark::Consume(PoseCurves.Get(LastCurveUID));
+				}
+			});
+			const double CurrentNs = DayOneBenchmark::NanosecondsPerElement(Iterations, 1, [&]()
+			{
+				for (const float Time : Times)
+				{
+					CurrentCodec->DecompressCurves(CompressedData, PoseCurves, Time);
+					DayOneBenchmark::Consume(PoseCurves.Get(LastCurveUID));
+				}
+			});
+
+			if (bLocomotionCodec)
+			{
+				UE_LOG(LogTemp, Display, TEXT("%-48s %3d curves %7d bytes (current codec)  decode %8.1f ns  DecompressCurves %8.1f ns"),
+				       *Sequence->GetName(), NumCurves, Bytes, PassNs, CurrentNs);
+				continue;
+			}
+
+			UE_LOG(LogTemp, Display, TEXT("%-48s %3d curves %7d bytes, %7d with %s (%5.1f%% saved)  decode %8.1f ns  %s %8.1f ns"),
+			       *Sequence->GetName(), NumCurves, Bytes, CurrentBytes, *CurrentCodec->GetName(),
+			       CurrentBytes > 0 ? 100.0 * (1.0 - static_cast<double>(Bytes) / CurrentBytes) : 0.0,
+			       PassNs, *CurrentCodec->GetName(), CurrentNs);
+
+			TotalBytes += Bytes;
+			TotalCurrentBytes += CurrentBytes;
+			++NumSequences;
+		}
+
+		UE_LOG(LogTemp, Display, TEXT("%d sequences on other codecs: %lld bytes with the locomotion codec, %lld with their current codecs (%.1f%% saved)"),
+		       NumSequences, TotalBytes, TotalCurrentBytes, TotalCurrentBytes > 0 ? 100.0 * (1.0 - static_cast<double>(TotalBytes) / TotalCurrentBytes) : 0.0);
+	}
+}
+
+static FAutoConsoleCommand CurveCodecReportCommand(
+	TEXT("DayOne.Anim.CurveCodecReport"),
+	TEXT("Log the curve memory and decode time of the locomotion curve codec on the loaded sequences,\n")
+	TEXT("against the codec each sequence currently uses.\n")
+	TEXT("Usage: DayOne.Anim.CurveCodecReport [Iterations=1000]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&LocomotionCurveCodecBenchmark::Run));
+
+#endif
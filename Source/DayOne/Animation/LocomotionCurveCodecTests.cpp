@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+#include "DayOne/Animation/AnimCurveCompressionCodec_Locomotion.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace LocomotionCurveCodecTests
+{
+	static constexpr EAutomationTestFlags::Type TestFlags = static_cast<EAutomationTestFlags::Type>(EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter);
+
+	// A power of two, so the time of every frame converts back to the exact frame.
+	static constexpr float FrameRate = 32.0f;
+	static constexpr int32 NumFrames = 301;
+
+	// The shapes of the ALS curves: constant, steps, ramps between holds, and noise.
+	static TArray<TArray<float>> MakeCurves()
+	{
+		TArray<TArray<float>> Curves;
+		Curves.SetNum(5);
+		FRandomStream Random(0xD1);
+		float Walk = 0.5f;
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			Curves[0].Add(1.0f);
+			Curves[1].Add((Frame / 40) % 2 == 0 ? 0.0f : 1.0f);
+			Curves[2].Add(FMath::Clamp((Frame % 100 - 30) / 40.0f, 0.0f, 1.0f));
+			Curves[3].Add(FMath::Sin(Frame * 0.05f));
+			Walk = FMath::Clamp(Walk + Random.FRandRange(-0.05f, 0.05f), 0.0f, 1.0f);
+			Curves[4].Add(Walk);
+		}
+		return Curves;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLocomotionCurveCodecRoundTripTest, "DayOne.Anim.CurveCodec.RoundTrip", LocomotionCurveCodecTests::TestFlags)
+
+bool FLocomotionCurveCodecRoundTripTest::RunTest(const FString& Parameters)
+{
+	using namespace LocomotionCurveCodecTests;
+
+	const TArray<TArray<float>> Curves = MakeCurves();
+	for (const float MaxError : { 0.0f, 0.001f, 0.01f, 0.1f })
+	{
+		TArray<uint8> Stream;
+		UAnimCurveCompressionCodec_Locomotion::BeginStream(FrameRate, Stream);
+		for (const TArray<float>& Samples : Curves)
+		{
+			UAnimCurveCompressionCodec_Locomotion::EncodeCurve(Samples, MaxError, Stream);
+		}
+
+		// Every frame decodes within MaxError of its sample, through both decoders, up to float rounding of the interpolation.
+		const float Tolerance = MaxError + 1e-5f;
+		TArray<float> Values;
+		Values.SetNumUninitialized(Curves.Num());
+		float WorstError = 0.0f;
+		bool bDecodersAgree = true;
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			const float Time = Frame / FrameRate;
+			UAnimCurveCompressionCodec_Locomotion::DecodeCurves(Stream.GetData(), Curves.Num(), Time, Values.GetData());
+			for (int32 CurveIndex = 0; CurveIndex < Curves.Num(); ++CurveIndex)
+			{
+				WorstError = FMath::Max(WorstError, FMath::Abs(Values[CurveIndex] - Curves[CurveIndex][Frame]));
+				bDecodersAgree &= Values[CurveIndex] == UAnimCurveCompressionCodec_Locomotion::DecodeCurve(Stream.GetData(), CurveIndex, Time);
+			}
+		}
+
+		TestTrue(*FString::Printf(TEXT("MaxError %g: worst error %g"), MaxError, WorstError), WorstError <= Tolerance);
+		TestTrue(*FString::Printf(TEXT("MaxError %g: DecodeCurve matches DecodeCurves"), MaxError), bDecodersAgree);
+
+		// Past the end, every curve holds its last value.
+		UAnimCurveCompressionCodec_Locomotion::DecodeCurves(Stream.GetData(), Curves.Num(), NumFrames / FrameRate + 1.0f, Values.GetData());
+		for (int32 CurveIndex = 0; CurveIndex < Curves.Num(); ++CurveIndex)
+		{
+			TestTrue(*FString::Printf(TEXT("MaxError %g: curve %d holds its last value"), MaxError, CurveIndex),
+			         FMath::Abs(Values[CurveIndex] - Curves[CurveIndex].Last()) <= Tolerance);
+		}
+	}
+
+	// The codec must pay for itself on the mostly constant curves.
+	TArray<uint8> Stream;
+	UAnimCurveCompressionCodec_Locomotion::BeginStream(FrameRate, Stream);
+	UAnimCurveCompressionCodec_Locomotion::EncodeCurve(Curves[1], 0.001f, Stream);
+	TestTrue(TEXT("A step curve is smaller than its samples"), Stream.Num() < NumFrames * static_cast<int32>(sizeof(float)));
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+#include "UObject/Package.h"
+#include "DayOne/Data/MotionMatchingDatabase.h"
+#include "DayOne/Math/Benchmark.h"
+
+#if !UE_BUILD_SHIPPING
+
+// Search time of the motion matching database for a crowd of characters, on a synthetic database of random poses, e.g.
+// DayOne -ExecCmds="DayOne.Anim.MotionMatching.Benchmark 100 4096 100"
+namespace MotionMatchingBenchmark
+{
+	static void Run(const TArray<FString>& Args)
+	{
+		using namespace MotionMatchingFeatures;
+
+		const int32 NumCharacters = FMath::Max(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 100, 1);
+		const int32 NumPoses = FMath::Max(Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 4096, 1);
+		const int32 NumFrames = FMath::Max(Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 100, 1);
+
+		FRandomStream Random(DayOneBenchmark::Seed);
+		UMotionMatchingDatabase* Database = NewObject<UMotionMatchingDatabase>(GetTransientPackage());
+		Database->BuildRandom(NumPoses, Random);
+
+		TArray<FMotionMatchingQuery> Queries;
+		Queries.SetNumUninitialized(NumCharacters);
+		float Features[Num] = {};
+		for (FMotionMatchingQuery& Query : Queries)
+		{
+			for (int32 Feature = 0; Feature < NumUsed; ++Feature)
+			{
+				Features[Feature] = Random.FRandRange(-100.0f, 100.0f);
+			}
+			Database->Quantize(Features, Query);
+		}
+
+		// Both searches must find the same best pose, or one of equal cost within float rounding.
+		int32 NumMismatches = 0;
+		for (const FMotionMatchingQuery& Query : Queries)
+		{
+			float Cost = MAX_flt;
+			float ScalarCost = MAX_flt;
+			const int32 Pose = Database->SearchRange(Query, 0, NumPoses, Cost);
+			const int32 ScalarPose = Database->SearchRangeScalar(Query, 0, NumPoses, ScalarCost);
+			if (Pose != ScalarPose && !FMath::IsNearlyEqual(Cost, ScalarCost, 1e-3f * FMath::Max(ScalarCost, 1.0f)))
+			{
+				++NumMismatches;
+			}
+		}
+
+		const double SimdSeconds = DayOneBenchmark::Seconds([&]()
+		{
+			for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+			{
+				for (const FMotionMatchingQuery& Query : Queries)
+				{
+					float Cost = MAX_flt;
+					DayOneBenchmark::Consume(Database->SearchRange(Query, 0, NumPoses, Cost));
+				}
+			}
+		});
+
+		const double ScalarSeconds = DayOneBenchmark::Seconds([&]()
+		{
+			for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+			{
+				for (const FMotionMatchingQuery& Query : Queries)
+				{
+					float Cost = MAX_flt;
+					DayOneBenchmark::Consume(Database->SearchRangeScalar(Query, 0, NumPoses, Cost));
+				}
+			}
+		});
+
+		const int32 NumSearches = NumCharacters * NumFrames;
+		const double SimdUs = SimdSeconds * 1e6 / NumSearches;
+		const double ScalarUs = ScalarSeconds * 1e6 / NumSearches;
+		UE_LOG(LogTemp, Display, TEXT("Motion matching, %d characters x %d frames, %d poses of %d features (%d bytes):"),
+		       NumCharacters, NumFrames, NumPoses, Num, NumPoses * Num);
+		UE_LOG(LogTemp, Display, TEXT("  SIMD   %8.2f us per search, %7.3f ms per frame"), SimdUs, SimdUs * NumCharacters * 1e-3);
+		UE_LOG(LogTemp, Display, TEXT("  Scalar %8.2f us per search, %7.3f ms per frame (%.1fx)"), ScalarUs, ScalarUs * NumCharacters * 1e-3,
+		       SimdUs > 0.0 ? ScalarUs / SimdUs : 0.0);
+
+		// A search longer than the budget is sliced over several updates, see UBaseAnimInstance::UpdateMotionMatching.
+		if (const IConsoleVariable* BudgetVariable = IConsoleManager::Get().FindConsoleVariable(TEXT("DayOne.Anim.MotionMatching.BudgetMicroseconds")))
+		{
+			const float BudgetUs = BudgetVariable->GetFloat();
+			UE_LOG(LogTemp, Display, TEXT("  Budget %8.2f us per character per update: %s"), BudgetUs,
+			       BudgetUs <= 0.0f ? TEXT("unlimited") :
+			       SimdUs <= BudgetUs ? TEXT("a search fits in one update") :
+			       *FString::Printf(TEXT("a search takes %d updates"), FMath::CeilToInt(SimdUs / BudgetUs)));
+		}
+
+		if (NumMismatches > 0)
+		{
+			UE_LOG(LogTemp, Error, TEXT("  %d of %d SIMD searches disagree with the scalar search"), NumMismatches, NumCharacters);
+		}
+	}
+}
+
+static FAutoConsoleCommand MotionMatchingBenchmarkCommand(
+	TEXT("DayOne.Anim.MotionMatching.Benchmark"),
+	TEXT("Time the SIMD and scalar motion matching searches on a random pose database and check they agree.\n")
+	TEXT("Usage: DayOne.Anim.MotionMatching.Benchmark [Characters=100] [Poses=4096] [Frames=100]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&MotionMatchingBenchmark::Run));
+
+#endif
@@ -4,11 +4,83 @@
 #include "BaseAnimInstance.h"
 
 #include "Components/CapsuleComponent.h"
-#include "Curves/CurveVector.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "DayOne/DayOne.h"
+#include "DayOne/Math/LocomotionMath.h"
+#include "DayOne/Subsystem/CurveBakeSubsystem.h"
+#include "Engine/AssetManager.h"
+#include "Engine/Engine.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "Kismet/KismetStringLibrary.h"
 #include "Kismet/KismetSystemLibrary.h"
 
+static TAutoConsoleVariable<int32> CVarAnimServerProfile(
+	TEXT("DayOne.Anim.ServerProfile"),
+	1,
+	TEXT("On a dedicated server, only update the anim values gameplay depends on (turn and rotate in place, yaw offsets),\n")
+	TEXT("and skip foot IK, layering, aiming smoothing, lean, stride, play rates and land prediction."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarAnimServerTickRate(
+	TEXT("DayOne.Anim.ServerTickRate"),
+	30.0f,
+	TEXT("On a dedicated server, mesh ticks per second of characters using the server anim profile. 0 ticks every frame.\n")
+	TEXT("UHitboxPoseComponent samples the hitbox pose at this rate. Read when the anim instance initializes."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarAnimServerVisibilityBasedAnimTickOption(
+	TEXT("DayOne.Anim.ServerVisibilityBasedAnimTickOption"),
+	static_cast<int32>(EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones),
+	TEXT("On a dedicated server, EVisibilityBasedAnimTickOption of character meshes using the server anim profile.\n")
+	TEXT("Nothing is rendered there, so: 0 evaluates the pose, curves and bones (default),\n")
+	TEXT(" 1 only ticks montages, notifies and root motion, the curves and bones keep their last evaluated values.\n")
+	TEXT("Read when the anim instance initializes."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarAnimParameterBatchValidate(
+	TEXT("DayOne.Anim.ParameterBatch.Validate"),
+	0,
+	TEXT("Also compute the anim parameters of DayOne.Anim.ParameterBatch on the scalar path,\n")
+	TEXT("and log the characters where they differ by more than the batch tolerance."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarAnimMotionMatching(
+	TEXT("DayOne.Anim.MotionMatching"),
+	0,
+	TEXT("Drive the grounded locomotion of anim instances with a motion matching database by searching it for the pose\n")
+	TEXT("that best continues the current one along the trajectory predicted by ULocomotionComponent,\n")
+	TEXT("instead of the velocity blend, stride blend and play rate math. Not on a dedicated server with DayOne.Anim.ServerProfile."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarAnimMotionMatchingSearchInterval(
+	TEXT("DayOne.Anim.MotionMatching.SearchInterval"),
+	0.1f,
+	TEXT("Seconds between the end of a character's motion matching search and the start of the next one."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarAnimMotionMatchingBudget(
+	TEXT("DayOne.Anim.MotionMatching.BudgetMicroseconds"),
+	20.0f,
+	TEXT("Search time of one character per anim update. A search that does not fit goes on in the next updates. 0 is unlimited.\n")
+	TEXT("Measure the cost of a search with DayOne.Anim.MotionMatching.Benchmark."),
+	ECVF_Default);
+
+DECLARE_CYCLE_STAT(TEXT("Base Anim Update"), STAT_BaseAnimUpdate, STATGROUP_DayOne);
+DECLARE_CYCLE_STAT(TEXT("Motion Matching"), STAT_MotionMatching, STATGROUP_DayOne);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Motion Matching Searches"), STAT_MotionMatchingSearches, STATGROUP_DayOne);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Motion Matching Jumps"), STAT_MotionMatchingJumps, STATGROUP_DayOne);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Base Anim Updates"), STAT_BaseAnimUpdates, STATGROUP_DayOne);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Base Anim Updates (Server Profile)"), STAT_BaseAnimUpdatesServerProfile, STATGROUP_DayOne);
+
+static const FName NAME_IKFootL(TEXT("ik_foot_l"));
+static const FName NAME_IKFootR(TEXT("ik_foot_r"));
+static const FName NAME_Root(TEXT("root"));
+
+// A searched pose replaces the playing one only if it costs less than this much of the playing one's cost.
+static constexpr float MotionMatchingContinuingCostRatio = 0.9f;
+// A searched pose this close to the playing one in the same sequence is the playing one, it does not jump.
+static constexpr float MotionMatchingSamePoseTime = 0.2f;
+
 FBaseAnimInstanceProxy::FBaseAnimInstanceProxy()
 	: Super()
 {
@@ -39,27 +111,28 @@ void FBaseAnimInstanceProxy::PreUpdate(UAnimInstance* InAnimInstance, float Delt
 	// UE_LOG(LogTemp, Warning, TEXT("FBaseAnimInstanceProxy::PreUpdate"));
 	
 	UpdateCharacterInfo();
+	UpdateBoneInfo(InAnimInstance->GetSkelMeshComponent());
 }
 
 void FBaseAnimInstanceProxy::UpdateCharacterInfo()
 {
 	if (Character && MovementComponent)
 	{
-		ActorRotation = Character->GetActorRotation();
-		MaxMovementInput = MovementComponent->GetMaxAcceleration();
-		MaxBrakingDeceleration = MovementComponent->GetMaxBrakingDeceleration();
-		Character->GetEssentialValues(Velocity, PhysicalAcceleration, MovementInput,
-								  bIsMoving,bHasMovementInput, Speed,
-								  MovementInputAmount, AimingRotation,AimYawRate);
-
-		Character->GetCurrentStates(MovementState, PrevMovementState, MovementAction,
-									RotationMode, Gait, Stance);
-
-		bIsMovingOnGround = MovementComponent->IsMovingOnGround();
-		LastUpdateRotation = MovementComponent->GetLastUpdateRotation();
+		// One copy of the snapshot published by the locomotion tick,
+		// the worker thread update never touches the live character.
+		Locomotion = MovementComponent->GetSnapshot();
+		WalkableFloorZ = MovementComponent->GetWalkableFloorZ();
+	}
+}
 
-		CapsuleLocation = Character->GetCapsuleComponent()->GetComponentLocation();
-		Character->GetCapsuleComponent()->GetScaledCapsuleSize(CapsuleRadius, CapsuleHalfHeight);
+void FBaseAnimInstanceProxy::UpdateBoneInfo(const USkeletalMeshComponent* Mesh)
+{
+	// The component space pose may be swapped by the evaluation of this frame, so the update never reads the mesh.
+	if (Mesh)
+	{
+		IKFootLTransform = Mesh->GetSocketTransform(NAME_IKFootL, RTS_Component);
+		IKFootRTransform = Mesh->GetSocketTransform(NAME_IKFootR, RTS_Component);
+		RootTransform = Mesh->GetSocketTransform(NAME_Root, RTS_Component);
 	}
 }
 
@@ -100,6 +173,205 @@ void UBaseAnimInstance::NativeInitializeAnimation()
 	IKTraceDistanceAboveFoot = 50.0f;
 	IKTraceDistanceBelowFoot = 45.0f;
 	FootHeight = 13.5f;
+
+	Curves.Reset();
+	bChangedToTrueLogicGate = true;
+	bChangedToFalseLogicGate = true;
+
+	AnimTraces.QueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(AnimTrace), false, TryGetPawnOwner());
+	LandPredictionSweepPhase = FMath::FRand();
+	LandPredictionSweepAge = LandPredictionSweepPhase * UAnimTraceSubsystem::GetLandPredictionSweepInterval();
+	AnimTraceSubsystem = GetWorld() ? GetWorld()->GetSubsystem<UAnimTraceSubsystem>() : nullptr;
+	if (AnimTraceSubsystem)
+	{
+		AnimTraceSubsystem->RegisterTraceSet(&AnimTraces, GetSkelMeshComponent());
+	}
+
+	AnimEventSubsystem = GetWorld() ? GetWorld()->GetSubsystem<UAnimEventSubsystem>() : nullptr;
+	bHasCharacterInfo = false;
+
+	bMotionMatching = false;
+	bMotionMatchingJumped = false;
+	MotionMatchingSequence = nullptr;
+	MotionMatchingTime = 0.0f;
+	MotionMatchingSequenceIndex = INDEX_NONE;
+	MotionMatchingSearchAge = 0.0f;
+	MotionMatchingSearch = FMotionMatchingSearchState();
+
+	bServerAnimationProfile = false;
+	bDedicatedServer = GetWorld() && GetWorld()->GetNetMode() == NM_DedicatedServer;
+	if (bDedicatedServer && CVarAnimServerProfile.GetValueOnGameThread() != 0)
+	{
+		USkeletalMeshComponent* Mesh = GetSkelMeshComponent();
+		const float TickRate = CVarAnimServerTickRate.GetValueOnGameThread();
+		Mesh->SetComponentTickInterval(TickRate > 0.0f ? 1.0f / TickRate : 0.0f);
+		Mesh->VisibilityBasedAnimTickOption = static_cast<EVisibilityBasedAnimTickOption>(
+			FMath::Clamp(CVarAnimServerVisibilityBasedAnimTickOption.GetValueOnGameThread(), 0, static_cast<int32>(EVisibilityBasedAnimTickOption::AlwaysTickPose)));
+	}
+
+	UCurveBakeSubsystem* CurveBakeSubsystem = GEngine->GetEngineSubsystem<UCurveBakeSubsystem>();
+	check(CurveBakeSubsystem);
+	BakedDiagonalScaleAmountCurve = CurveBakeSubsystem->GetBakedCurve(DiagonalScaleAmountCurve);
+	BakedStrideBlendNWalk = CurveBakeSubsystem->GetBakedCurve(StrideBlendNWalk);
+	BakedStrideBlendNRun = CurveBakeSubsystem->GetBakedCurve(StrideBlendNRun);
+	BakedStrideBlendCWalk = CurveBakeSubsystem->GetBakedCurve(StrideBlendCWalk);
+	BakedYawOffsetFB = CurveBakeSubsystem->GetBakedCurve(YawOffsetFB);
+	BakedYawOffsetLR = CurveBakeSubsystem->GetBakedCurve(YawOffsetLR);
+	BakedLandPredictionCurve = CurveBakeSubsystem->GetBakedCurve(LandPredictionCurve);
+
+	// Turn in place: resolve the asset of every stance and turn now, and load the animations at spawn,
+	// so the first turn of a match does not hitch.
+	const FTurnInPlaceTable::FStanceAssets TurnInPlaceAssets[] =
+	{
+		{ &N_TurnIP_L90, &N_TurnIP_R90, &N_TurnIP_L180, &N_TurnIP_R180 },
+		{ &CLF_TurnIP_L90, &CLF_TurnIP_R90, &CLF_TurnIP_L180, &CLF_TurnIP_R180 },
+	};
+	TurnInPlaceTable.Build(TurnInPlaceAssets, Turn180Threshold);
+	PendingTurnInPlace = nullptr;
+
+	if (TurnInPlaceLoadHandle.IsValid())
+	{
+		TurnInPlaceLoadHandle->CancelHandle();
+		TurnInPlaceLoadHandle.Reset();
+	}
+	TArray<FSoftObjectPath> TurnInPlaceAnimations;
+	TurnInPlaceTable.GetAnimationPaths(TurnInPlaceAnimations);
+	if (TurnInPlaceAnimations.Num() > 0)
+	{
+		TurnInPlaceLoadHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+			TurnInPlaceAnimations, FStreamableDelegate::CreateUObject(this, &ThisClass::OnTurnInPlaceAnimationsLoaded));
+	}
+}
+
+void UBaseAnimInstance::OnTurnInPlaceAnimationsLoaded()
+{
+	// The handle keeps them loaded as long as this instance.
+	TurnInPlaceTable.ResolveAnimations();
+}
+
+void UBaseAnimInstance::UpdateMotionMatching(float DeltaSeconds)
+{
+	bMotionMatchingJumped = false;
+	bMotionMatching = CVarAnimMotionMatching.GetValueOnAnyThread() != 0 && !bServerAnimationProfile
+		&& MotionMatchingDatabase && MotionMatchingDatabase->IsBuilt() && Proxy->Locomotion.MovementState == EMovementState::MS_Grounded;
+	if (!bMotionMatching)
+	{
+		// Start over from the first sequence when the mode comes back.
+		MotionMatchingSearch = FMotionMatchingSearchState();
+		MotionMatchingSequenceIndex = INDEX_NONE;
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_MotionMatching);
+	const UMotionMatchingDatabase& Database = *MotionMatchingDatabase;
+
+	// Before the first search there is no matched pose to continue, continue the first one (the idle) and search now.
+	if (MotionMatchingSequenceIndex == INDEX_NONE)
+	{
+		MotionMatchingSequenceIndex = Database.GetPoseSequence(0);
+		MotionMatchingSequence = Database.GetSequence(MotionMatchingSequenceIndex).Sequence;
+		MotionMatchingTime = Database.GetPoseTime(0);
+		MotionMatchingSearchAge = FLT_MAX;
+	}
+	else
+	{
+		const FMotionMatchingSequence& Playing = Database.GetSequence(MotionMatchingSequenceIndex);
+		const float Length = Playing.Sequence ? Playing.Sequence->GetPlayLength() : 0.0f;
+		MotionMatchingTime += DeltaSeconds;
+		MotionMatchingTime = Playing.bLoop && Length > 0.0f ? FMath::Fmod(MotionMatchingTime, Length) : FMath::Min(MotionMatchingTime, Length);
+		MotionMatchingSearchAge += DeltaSeconds;
+	}
+	const int32 CurrentPose = Database.FindPose(MotionMatchingSequenceIndex, MotionMatchingTime);
+	if (CurrentPose == INDEX_NONE)
+	{
+		return;
+	}
+
+	if (!MotionMatchingSearch.IsRunning())
+	{
+		if (MotionMatchingSearchAge < CVarAnimMotionMatchingSearchInterval.GetValueOnAnyThread())
+		{
+			return;
+		}
+		FMotionMatchingQuery Query;
+		BuildMotionMatchingQuery(CurrentPose, Query);
+		Database.BeginSearch(Query, MotionMatchingSearch);
+	}
+
+	const float BudgetMicroseconds = CVarAnimMotionMatchingBudget.GetValueOnAnyThread();
+	const uint64 BudgetCycles = BudgetMicroseconds > 0.0f ? static_cast<uint64>(BudgetMicroseconds * 1e-6 / FPlatformTime::GetSecondsPerCycle64()) : MAX_uint64;
+	if (!Database.ContinueSearch(MotionMatchingSearch, BudgetCycles))
+	{
+		return;
+	}
+	INC_DWORD_STAT(STAT_MotionMatchingSearches);
+	MotionMatchingSearchAge = 0.0f;
+
+	// Keep playing unless the best pose is somewhere else and clearly better.
+	const int32 BestPose = MotionMatchingSearch.BestPose;
+	if (BestPose == INDEX_NONE)
+	{
+		return;
+	}
+	if (Database.GetPoseSequence(BestPose) == MotionMatchingSequenceIndex
+		&& FMath::Abs(Database.GetPoseTime(BestPose) - MotionMatchingTime) < MotionMatchingSamePoseTime)
+	{
+		return;
+	}
+	if (MotionMatchingSearch.BestCost >= Database.ComputeCost(MotionMatchingSearch.Query, CurrentPose) * MotionMatchingContinuingCostRatio)
+	{
+		return;
+	}
+
+	INC_DWORD_STAT(STAT_MotionMatchingJumps);
+	MotionMatchingSequenceIndex = Database.GetPoseSequence(BestPose);
+	MotionMatchingSequence = Database.GetSequence(MotionMatchingSequenceIndex).Sequence;
+	MotionMatchingTime = Database.GetPoseTime(BestPose);
+	bMotionMatchingJumped = true;
+}
+
+void UBaseAnimInstance::BuildMotionMatchingQuery(int32 CurrentPose, FMotionMatchingQuery& OutQuery) const
+{
+	using namespace MotionMatchingFeatures;
+
+	// The pose features of the playing pose, so the search prefers poses that continue it.
+	float Features[Num];
+	MotionMatchingDatabase->GetPoseFeatures(CurrentPose, Features);
+
+	// The database trajectories are in the mesh component space of their sequences.
+	FVector Locations[NumTrajectoryPoints];
+	FVector Facings[NumTrajectoryPoints];
+	ULocomotionComponent::PredictTrajectory(Proxy->Locomotion, TrajectoryTimes, Locations, Facings);
+	const FTransform& ComponentTransform = Proxy->GetComponentTransform();
+	for (int32 Point = 0; Point < NumTrajectoryPoints; ++Point)
+	{
+		const FVector Location = ComponentTransform.InverseTransformVectorNoScale(Locations[Point]);
+		const FVector Facing = ComponentTransform.InverseTransformVectorNoScale(Facings[Point]);
+		Features[TrajectoryPosition + 2 * Point] = Location.X;
+		Features[TrajectoryPosition + 2 * Point + 1] = Location.Y;
+		Features[TrajectoryFacing + 2 * Point] = Facing.X;
+		Features[TrajectoryFacing + 2 * Point + 1] = Facing.Y;
+	}
+
+	MotionMatchingDatabase->Quantize(Features, OutQuery);
+}
+
+void UBaseAnimInstance::NativeUninitializeAnimation()
+{
+	if (AnimTraceSubsystem)
+	{
+		AnimTraceSubsystem->UnregisterTraceSet(&AnimTraces, GetSkelMeshComponent());
+		AnimTraceSubsystem = nullptr;
+	}
+
+	if (TurnInPlaceLoadHandle.IsValid())
+	{
+		TurnInPlaceLoadHandle->CancelHandle();
+		TurnInPlaceLoadHandle.Reset();
+	}
+	PendingTurnInPlace = nullptr;
+
+	Super::NativeUninitializeAnimation();
 }
 
 void UBaseAnimInstance::NativeThreadSafeUpdateAnimation(float DeltaSeconds)
@@ -110,18 +382,46 @@ void UBaseAnimInstance::NativeThreadSafeUpdateAnimation(float DeltaSeconds)
 	if (DeltaSeconds == 0.0f) return;
 	if (Proxy->Character == nullptr) return;
 
+	SCOPE_CYCLE_COUNTER(STAT_BaseAnimUpdate);
+	// Anim ms per character is "Base Anim Update" over "Base Anim Updates", compare it with DayOne.Anim.ServerProfile on and off.
+	bServerAnimationProfile = bDedicatedServer && CVarAnimServerProfile.GetValueOnAnyThread() != 0;
+	INC_DWORD_STAT(STAT_BaseAnimUpdates);
+	if (bServerAnimationProfile)
+	{
+		INC_DWORD_STAT(STAT_BaseAnimUpdatesServerProfile);
+	}
+
+	// Every curve read below comes from this, the curves only change when the pose is evaluated.
+	Curves.Read(Proxy->GetAnimationCurves(EAnimCurveType::AttributeCurve));
+
+	// The batch interpolates with the frame delta time, which this update may not have (e.g. after a skipped frame).
+	bUseBatchedParameters = BatchedParameters.bValid && FMath::IsNearlyEqual(BatchedParameters.DeltaSeconds, DeltaSeconds);
+	BatchedParameters.bValid = false;
+
 	UpdateCharacterInfo(DeltaSeconds);
-	UpdateAimingValues(DeltaSeconds);
-	UpdateLayerValues(DeltaSeconds);
-	UpdateFootIK(DeltaSeconds);
+	if (bServerAnimationProfile)
+	{
+		// Only the aiming angle, turn and rotate in place depend on it.
+		UpdateAimingAngle();
+	}
+	else
+	{
+		UpdateAimingValues(DeltaSeconds);
+		UpdateLayerValues(DeltaSeconds);
+		UpdateFootIK(DeltaSeconds);
+	}
+	UpdateMotionMatching(DeltaSeconds);
+	FMotionMatchingPoseInputs& MotionMatchingInputs = Proxy->MotionMatching;
+	MotionMatchingInputs.bActive = bMotionMatching && MotionMatchingSequence != nullptr;
+	MotionMatchingInputs.bJumped = bMotionMatchingJumped;
+	MotionMatchingInputs.Sequence = MotionMatchingSequence;
+	MotionMatchingInputs.Time = MotionMatchingTime;
 
 	// Check Movement Mode
-	if (Proxy->MovementState == EMovementState::MS_Grounded)
+	if (Proxy->Locomotion.MovementState == EMovementState::MS_Grounded)
 	{
 		// Check If Moving Or Not
 		bShouldMove = ShouldMoveCheck();
-		static bool bChangedToTrueLogicGate = true;
-		static bool bChangedToFalseLogicGate = true;
 		if (bShouldMove)
 		{
 			// If ChangedToTrue logic-gate is open
@@ -139,7 +439,12 @@ void UBaseAnimInstance::NativeThreadSafeUpdateAnimation(float DeltaSeconds)
 			}
 			// Anyway, TODO WhileTrue logic
 			// Do While Moving
-			UpdateMovementValues(DeltaSeconds);
+			// The yaw offsets drive the YawOffset curve ULocomotionComponent rotates with, the movement values are cosmetic.
+			// The motion matching player plays the cycles at their authored speed instead, it needs none of them.
+			if (!bServerAnimationProfile && !bMotionMatching)
+			{
+				UpdateMovementValues(DeltaSeconds);
+			}
 			UpdateRotationValues();
 		}
 		else
@@ -174,29 +479,77 @@ void UBaseAnimInstance::NativeThreadSafeUpdateAnimation(float DeltaSeconds)
 				ElapsedDelayTime = 0.0f;
 			}
 
-			if (CanDynamicTransition())
+			if (!bServerAnimationProfile && CanDynamicTransition())
 			{
 				DynamicTransitionCheck();
 			}
 		}
 		
 	}
-	else if (Proxy->MovementState == EMovementState::MS_InAir)
+	else if (Proxy->Locomotion.MovementState == EMovementState::MS_InAir)
 	{
 		// Do While InAir
-		UpdateInAirValues();
+		UpdateInAirValues(DeltaSeconds);
 	}
 }
 
 void UBaseAnimInstance::UpdateCharacterInfo(float DeltaSeconds)
 {
-	Gait = Proxy->Gait;
-	Stance = Proxy->Stance;
-	MovementState = Proxy->MovementState;
-	Speed = Proxy->Speed;
-	bHasMovementInput = Proxy->bHasMovementInput;
+	const EGaitState PreviousGait = Gait;
+	const EMovementState PreviousMovementState = MovementState;
 
-	bIsMoving = Proxy->bIsMoving;
+	Gait = Proxy->Locomotion.Gait;
+	Stance = Proxy->Locomotion.Stance;
+	MovementState = Proxy->Locomotion.MovementState;
+	Speed = Proxy->Locomotion.Speed;
+	bHasMovementInput = Proxy->Locomotion.bHasMovementInput;
+
+	bIsMoving = Proxy->Locomotion.bIsMoving;
+
+	if (bHasCharacterInfo)
+	{
+		const FVector Location = Proxy->GetComponentTransform().GetLocation();
+		if (PreviousMovementState == EMovementState::MS_InAir && MovementState == EMovementState::MS_Grounded)
+		{
+			// FallSpeed still holds the last in air value.
+			PushAnimEvent(EAnimEventType::Landed, Location, FallSpeed);
+		}
+		if (Gait != PreviousGait)
+		{
+			PushAnimEvent(EAnimEventType::GaitChanged, Location, Speed, static_cast<uint8>(Gait));
+		}
+	}
+	bHasCharacterInfo = true;
+}
+
+void UBaseAnimInstance::PushAnimEvent(EAnimEventType Type, const FVector& Location, float Value, uint8 Param) const
+{
+	if (AnimEventSubsystem == nullptr || !UAnimEventSubsystem::IsEnabled()) return;
+
+	FAnimEvent Event;
+	Event.Actor = Proxy->Character;
+	Event.Location = FVector3f(Location);
+	Event.Value = Value;
+	Event.Type = Type;
+	Event.Param = Param;
+	AnimEventSubsystem->Push(Event);
+}
+
+void UBaseAnimInstance::UpdateAimingAngle()
+{
+	FRotator DeltaAimingRotation = UKismetMathLibrary::NormalizedDeltaRotator(Proxy->Locomotion.AimingRotation, Proxy->Locomotion.ActorRotation);
+	const FVector2d ScalarAimingAngle = UKismetMathLibrary::MakeVector2D(DeltaAimingRotation.Yaw, DeltaAimingRotation.Pitch);
+	if (bUseBatchedParameters)
+	{
+		AimingAngle = BatchedParameters.AimingAngle;
+		if (CVarAnimParameterBatchValidate.GetValueOnAnyThread() != 0)
+		{
+			ValidateBatchedParameter(TEXT("AimingAngle.X"), AimingAngle.X, ScalarAimingAngle.X);
+			ValidateBatchedParameter(TEXT("AimingAngle.Y"), AimingAngle.Y, ScalarAimingAngle.Y);
+		}
+		return;
+	}
+	AimingAngle = ScalarAimingAngle;
 }
 
 void UBaseAnimInstance::UpdateAimingValues(float DeltaSeconds)
@@ -204,17 +557,16 @@ void UBaseAnimInstance::UpdateAimingValues(float DeltaSeconds)
 	// Interp the Aiming Rotation value to achieve smooth aiming rotation changes.
 	// Interpolating the rotation before calculating the angle ensures the value is not affected by changes in actor rotation,
 	// allowing slow aiming rotation changes with fast actor rotation changes.
-	SmoothedAimingRotation = UKismetMathLibrary::RInterpTo(SmoothedAimingRotation, Proxy->AimingRotation, DeltaSeconds, SmoothedAimingRotationInterpSpeed);
+	SmoothedAimingRotation = UKismetMathLibrary::RInterpTo(SmoothedAimingRotation, Proxy->Locomotion.AimingRotation, DeltaSeconds, SmoothedAimingRotationInterpSpeed);
 
 	// Calculate the Aiming angle and Smoothed Aiming Angle by getting the delta between
 	// the aiming rotation and the actor rotation.
-	FRotator DeltaAimingRotation = UKismetMathLibrary::NormalizedDeltaRotator(Proxy->AimingRotation, Proxy->ActorRotation);
-	AimingAngle = UKismetMathLibrary::MakeVector2D(DeltaAimingRotation.Yaw, DeltaAimingRotation.Pitch);
-	FRotator DeltaSmoothedAimingRotation = UKismetMathLibrary::NormalizedDeltaRotator(SmoothedAimingRotation, Proxy->ActorRotation);
+	UpdateAimingAngle();
+	FRotator DeltaSmoothedAimingRotation = UKismetMathLibrary::NormalizedDeltaRotator(SmoothedAimingRotation, Proxy->Locomotion.ActorRotation);
 	SmoothedAimingAngle = UKismetMathLibrary::MakeVector2D(DeltaSmoothedAimingRotation.Yaw, DeltaSmoothedAimingRotation.Pitch);
 
 	// Clamp the Aiming Pitch Angle to a range of 1 to 0 for use in the vertical aim sweeps.
-	if (Proxy->RotationMode == ERotationMode::RM_Looking || Proxy->RotationMode == ERotationMode::RM_Aiming)
+	if (Proxy->Locomotion.RotationMode == ERotationMode::RM_Looking || Proxy->Locomotion.RotationMode == ERotationMode::RM_Aiming)
 	{
 		AimSweepTime = UKismetMathLibrary::MapRangeClamped(AimingAngle.Y, -90.0f, 90.0f, 1.0f, 0.0f);
 		// Use the Aiming Yaw Angle divided by the number of spine+pelvis bones to
@@ -238,30 +590,30 @@ void UBaseAnimInstance::UpdateAimingValues(float DeltaSeconds)
 void UBaseAnimInstance::UpdateLayerValues(float DeltaSeconds)
 {
 	// Get the Aim Offset weight by getting the opposite of the Aim Offset Mask.
-    EnableAimOffset = UKismetMathLibrary::Lerp(1.0f, 0.0f, GetAnimCurveCompact(FName("Mask_AimOffset")));
+    EnableAimOffset = UKismetMathLibrary::Lerp(1.0f, 0.0f, Curves[ELocomotionCurve::MaskAimOffset]);
 
 	// Set the Base Pose weights
-	BasePoseN = GetAnimCurveCompact(FName("BasePose_N"));
-	BasePoseCLF = GetAnimCurveCompact(FName("BasePose_CLF"));
+	BasePoseN = Curves[ELocomotionCurve::BasePoseN];
+	BasePoseCLF = Curves[ELocomotionCurve::BasePoseCLF];
 
 	// Set the Additive amount weights for each body part
-	SpineAdd = GetAnimCurveCompact(FName("Layering_Spine_Add"));
-	HeadAdd = GetAnimCurveCompact(FName("Layering_Head_Add"));
-	ArmLAdd = GetAnimCurveCompact(FName("Layering_Arm_L_Add"));
-	ArmRAdd = GetAnimCurveCompact(FName("Layering_Arm_R_Add"));
+	SpineAdd = Curves[ELocomotionCurve::LayeringSpineAdd];
+	HeadAdd = Curves[ELocomotionCurve::LayeringHeadAdd];
+	ArmLAdd = Curves[ELocomotionCurve::LayeringArmLAdd];
+	ArmRAdd = Curves[ELocomotionCurve::LayeringArmRAdd];
 
 	// Set the Hand Override weights
-	HandR = GetAnimCurveCompact(FName("Layering_Hand_R"));
-	HandL = GetAnimCurveCompact(FName("Layering_Hand_L"));
+	HandR = Curves[ELocomotionCurve::LayeringHandR];
+	HandL = Curves[ELocomotionCurve::LayeringHandL];
 
 	// Blend and set the Hand IK weights to ensure they only are weighted if allowed by the Arm layers.
-	EnableHandIKL = UKismetMathLibrary::Lerp(0.0f, GetAnimCurveCompact(FName("Enable_HandIK_L")), GetAnimCurveCompact(FName("Layering_Arm_L")));
-	EnableHandIKR = UKismetMathLibrary::Lerp(0.0f, GetAnimCurveCompact(FName("Enable_HandIK_R")), GetAnimCurveCompact(FName("Layering_Arm_R")));
+	EnableHandIKL = UKismetMathLibrary::Lerp(0.0f, Curves[ELocomotionCurve::EnableHandIKL], Curves[ELocomotionCurve::LayeringArmL]);
+	EnableHandIKR = UKismetMathLibrary::Lerp(0.0f, Curves[ELocomotionCurve::EnableHandIKR], Curves[ELocomotionCurve::LayeringArmR]);
 
 	// Set whether the arms should blend in mesh space or local space.
 	// The Mesh space weight will always be 1 unless the Local Space (LS) curve is fully weighted.
-	Arm_L_LS = GetAnimCurveCompact(FName("Layering_Arm_L_LS"));
-	Arm_R_LS = GetAnimCurveCompact(FName("Layering_Arm_R_LS"));
+	Arm_L_LS = Curves[ELocomotionCurve::LayeringArmLLS];
+	Arm_R_LS = Curves[ELocomotionCurve::LayeringArmRLS];
 	Arm_L_MS = (float)(1 - FMath::FloorToInt(Arm_L_LS));
 	Arm_R_MS = (float)(1 - FMath::FloorToInt(Arm_R_LS));
 }
@@ -269,45 +621,82 @@ void UBaseAnimInstance::UpdateLayerValues(float DeltaSeconds)
 void UBaseAnimInstance::UpdateFootIK(float DeltaSeconds)
 {
 	// Locking left foot
-	SetFootLocking("Enable_FootIK_L", "FootLock_L", "ik_foot_l", FootLockLAlpha, FootLockLLocation, FootLockLRotation, DeltaSeconds);
+	SetFootLocking(ELocomotionCurve::EnableFootIKL, ELocomotionCurve::FootLockL, Proxy->IKFootLTransform, FootLockLAlpha, FootLockLLocation, FootLockLRotation, DeltaSeconds);
 	// Locking right foot
-	SetFootLocking("Enable_FootIK_R", "FootLock_R", "ik_foot_r", FootLockRAlpha, FootLockRLocation, FootLockRRotation, DeltaSeconds);
+	SetFootLocking(ELocomotionCurve::EnableFootIKR, ELocomotionCurve::FootLockR, Proxy->IKFootRTransform, FootLockRAlpha, FootLockRLocation, FootLockRRotation, DeltaSeconds);
 	
 	FVector FootOffsetLTarget = FVector::ZeroVector;
 	FVector FootOffsetRTarget = FVector::ZeroVector;
-	if (Proxy->MovementState == EMovementState::MS_None || Proxy->MovementState == EMovementState::MS_Grounded)
+	if (Proxy->Locomotion.MovementState == EMovementState::MS_None || Proxy->Locomotion.MovementState == EMovementState::MS_Grounded)
 	{
 		// Calculate left foot offset
-		SetFootOffsets("Enable_FootIK_L", "ik_foot_l", "root", FootOffsetLTarget, FootOffsetLLocation, FootOffsetLRotation, DeltaSeconds);
+		SetFootOffsets(ELocomotionCurve::EnableFootIKL, Proxy->IKFootLTransform, Proxy->RootTransform, AnimTraces.Feet[FAnimTraceSet::Left], FootOffsetLTarget, FootOffsetLLocation, FootOffsetLRotation, DeltaSeconds);
 		// Calculate right foot offset
-		SetFootOffsets("Enable_FootIK_R", "ik_foot_r", "root", FootOffsetRTarget, FootOffsetRLocation, FootOffsetRRotation, DeltaSeconds);
+		SetFootOffsets(ELocomotionCurve::EnableFootIKR, Proxy->IKFootRTransform, Proxy->RootTransform, AnimTraces.Feet[FAnimTraceSet::Right], FootOffsetRTarget, FootOffsetRLocation, FootOffsetRRotation, DeltaSeconds);
 		// Calculate pelvis offset
 		SetPelvisIKOffset(FootOffsetLTarget, FootOffsetRTarget, DeltaSeconds);
 	}
+
+	FFootIKPoseInputs& FootIK = Proxy->FootIK;
+	FootIK.FootLockLAlpha = FootLockLAlpha;
+	FootIK.FootLockLLocation = FootLockLLocation;
+	FootIK.FootLockLRotation = FootLockLRotation;
+	FootIK.FootLockRAlpha = FootLockRAlpha;
+	FootIK.FootLockRLocation = FootLockRLocation;
+	FootIK.FootLockRRotation = FootLockRRotation;
+	FootIK.FootOffsetLLocation = FootOffsetLLocation;
+	FootIK.FootOffsetLRotation = FootOffsetLRotation;
+	FootIK.FootOffsetRLocation = FootOffsetRLocation;
+	FootIK.FootOffsetRRotation = FootOffsetRRotation;
+	FootIK.PelvisAlpha = PelvisAlpha;
+	FootIK.PelvisOffset = PelvisOffset;
 }
 
 bool UBaseAnimInstance::ShouldMoveCheck()
 {
 	// UE_LOG(LogTemp, Warning, TEXT("IsMoving: %s, HasMovementInput: %s, Speed: %f"), *UKismetStringLibrary::Conv_BoolToString(Proxy.bIsMoving), *UKismetStringLibrary::Conv_BoolToString(Proxy.bHasMovementInput), Proxy.Speed);
-	return ((Proxy->bIsMoving && Proxy->bHasMovementInput) || Proxy->Speed > 150.0f);
+	return ((Proxy->Locomotion.bIsMoving && Proxy->Locomotion.bHasMovementInput) || Proxy->Locomotion.Speed > 150.0f);
 }
 
 void UBaseAnimInstance::UpdateMovementValues(float DeltaSeconds)
 {
-	// Interp and set the Velocity Blend.
-	FVelocityBlend VelocityBlendTarget = CalculateVelocityBlend();
-	VelocityBlend = InterpVelocityBlend(VelocityBlend, VelocityBlendTarget, VelocityBlendInterpSpeed, DeltaSeconds);
+	if (bUseBatchedParameters && CVarAnimParameterBatchValidate.GetValueOnAnyThread() == 0)
+	{
+		// Computed in ULocomotionSubsystem::UpdateAnimParameters.
+		VelocityBlend = BatchedParameters.VelocityBlend;
+		RelativeAccelerationAmount = BatchedParameters.RelativeAccelerationAmount;
+		LeanAmount = BatchedParameters.LeanAmount;
+	}
+	else
+	{
+		// Interp and set the Velocity Blend.
+		FVelocityBlend VelocityBlendTarget = CalculateVelocityBlend();
+		VelocityBlend = InterpVelocityBlend(VelocityBlend, VelocityBlendTarget, VelocityBlendInterpSpeed, DeltaSeconds);
+
+		// Set the Relative Acceleration Amount and Interp the Lean Amount.
+		RelativeAccelerationAmount = CalculateRelativeAccelerationAmount();
+		FLeanAmount TargetLeanAmount;
+		TargetLeanAmount.LR = RelativeAccelerationAmount.Y;
+		TargetLeanAmount.FB = RelativeAccelerationAmount.X;
+		LeanAmount = InterpLeanAmount(LeanAmount, TargetLeanAmount, GroundedLeanInterpSpeed, DeltaSeconds);
+
+		if (bUseBatchedParameters)
+		{
+			ValidateBatchedParameter(TEXT("VelocityBlend.F"), BatchedParameters.VelocityBlend.F, VelocityBlend.F);
+			ValidateBatchedParameter(TEXT("VelocityBlend.B"), BatchedParameters.VelocityBlend.B, VelocityBlend.B);
+			ValidateBatchedParameter(TEXT("VelocityBlend.L"), BatchedParameters.VelocityBlend.L, VelocityBlend.L);
+			ValidateBatchedParameter(TEXT("VelocityBlend.R"), BatchedParameters.VelocityBlend.R, VelocityBlend.R);
+			ValidateBatchedParameter(TEXT("RelativeAccelerationAmount.X"), BatchedParameters.RelativeAccelerationAmount.X, RelativeAccelerationAmount.X);
+			ValidateBatchedParameter(TEXT("RelativeAccelerationAmount.Y"), BatchedParameters.RelativeAccelerationAmount.Y, RelativeAccelerationAmount.Y);
+			ValidateBatchedParameter(TEXT("RelativeAccelerationAmount.Z"), BatchedParameters.RelativeAccelerationAmount.Z, RelativeAccelerationAmount.Z);
+			ValidateBatchedParameter(TEXT("LeanAmount.LR"), BatchedParameters.LeanAmount.LR, LeanAmount.LR);
+			ValidateBatchedParameter(TEXT("LeanAmount.FB"), BatchedParameters.LeanAmount.FB, LeanAmount.FB);
+		}
+	}
 
 	// Set the Diagonal Scale Amount.
 	DiagonalScaleAmount = CalculateDiagonalScaleAmount();
 
-	// Set the Relative Acceleration Amount and Interp the Lean Amount.
-	RelativeAccelerationAmount = CalculateRelativeAccelerationAmount();
-	FLeanAmount TargetLeanAmount;
-	TargetLeanAmount.LR = RelativeAccelerationAmount.Y;
-	TargetLeanAmount.FB = RelativeAccelerationAmount.X;
-	LeanAmount = InterpLeanAmount(LeanAmount, TargetLeanAmount, GroundedLeanInterpSpeed, DeltaSeconds);
-
 	// Set the Walk Run Blend
 	WalkRunBlend = CalculateWalkRunBlend();
 	// Set the Stride Blend
@@ -317,22 +706,23 @@ void UBaseAnimInstance::UpdateMovementValues(float DeltaSeconds)
 	CrouchingPlayRate = CalculateCrouchingPlayRate();
 }
 
-FVelocityBlend UBaseAnimInstance::CalculateVelocityBlend() const
+void UBaseAnimInstance::ValidateBatchedParameter(const TCHAR* Name, double Batched, double Scalar) const
 {
-	// Normalize character velocity and rotate it back to world forward direction.
-	FVector NormalizedVelocity = Proxy->Velocity.GetSafeNormal(0.1f);
-	FVector LocRelativeVelocityDir = Proxy->ActorRotation.UnrotateVector(NormalizedVelocity);
+	if (!FMath::IsNearlyEqual(Batched, Scalar, static_cast<double>(LocomotionMath::AnimParameterBatchTolerance)))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s: batched %s %f differs from scalar %f"), *GetNameSafe(Proxy->Character), Name, Batched, Scalar);
+	}
+}
 
-	// Map diagonals vector from 1.0 to 0.5
-	float Sum = FMath::Abs(LocRelativeVelocityDir.X) + FMath::Abs(LocRelativeVelocityDir.Y) + FMath::Abs(LocRelativeVelocityDir.Z);
-	FVector RelativeDirection = LocRelativeVelocityDir / Sum;
+FVelocityBlend UBaseAnimInstance::CalculateVelocityBlend() const
+{
+	const FVector4f Blend = LocomotionMath::VelocityBlend(Proxy->Locomotion.Velocity, Proxy->Locomotion.ActorRotation);
 
-	// Map to VelocityBlend
 	FVelocityBlend LocVelocityBlend;
-	LocVelocityBlend.F = FMath::Clamp(RelativeDirection.X, 0.0f, 1.0f);
-	LocVelocityBlend.B = FMath::Abs(FMath::Clamp(RelativeDirection.X, -1.0f, 0.0f));
-	LocVelocityBlend.L = FMath::Abs(FMath::Clamp(RelativeDirection.Y, -1.0f, 0.0f));
-	LocVelocityBlend.R = FMath::Clamp(RelativeDirection.Y, 0.0f, 1.0f);
+	LocVelocityBlend.F = Blend.X;
+	LocVelocityBlend.B = Blend.Y;
+	LocVelocityBlend.L = Blend.Z;
+	LocVelocityBlend.R = Blend.W;
 
 	return LocVelocityBlend;
 }
@@ -353,24 +743,16 @@ FVelocityBlend UBaseAnimInstance::InterpVelocityBlend(FVelocityBlend Current,
 
 float UBaseAnimInstance::CalculateDiagonalScaleAmount() const
 {
-	check(DiagonalScaleAmountCurve);
+	check(BakedDiagonalScaleAmountCurve);
 	
 	float InTime = FMath::Abs(VelocityBlend.F + VelocityBlend.B);
-	return DiagonalScaleAmountCurve->GetFloatValue(InTime);
+	return BakedDiagonalScaleAmountCurve->Evaluate(InTime);
 }
 
 FVector UBaseAnimInstance::CalculateRelativeAccelerationAmount() const
 {
-	if (FVector::DotProduct(Proxy->PhysicalAcceleration, Proxy->Velocity) > 0.0f)
-	{
-		FVector ClampedAcceleration = Proxy->PhysicalAcceleration.GetClampedToMaxSize(Proxy->MaxMovementInput);
-		return Proxy->ActorRotation.UnrotateVector(ClampedAcceleration / Proxy->MaxMovementInput);
-	}
-	else
-	{
-		FVector ClampedDeceleration = Proxy->PhysicalAcceleration.GetClampedToMaxSize(Proxy->MaxBrakingDeceleration);
-		return Proxy->ActorRotation.UnrotateVector(ClampedDeceleration / Proxy->MaxBrakingDeceleration);
-	}
+	return LocomotionMath::RelativeAccelerationAmount(Proxy->Locomotion.PhysicalAcceleration, Proxy->Locomotion.Velocity, Proxy->Locomotion.ActorRotation,
+	                                                  Proxy->Locomotion.MaxAcceleration, Proxy->Locomotion.MaxBrakingDeceleration);
 }
 
 FLeanAmount UBaseAnimInstance::InterpLeanAmount(FLeanAmount Current,
@@ -385,7 +767,7 @@ FLeanAmount UBaseAnimInstance::InterpLeanAmount(FLeanAmount Current,
 
 float UBaseAnimInstance::CalculateWalkRunBlend() const
 {
-	if (Proxy->Gait == EGaitState::GS_Walking)
+	if (Proxy->Locomotion.Gait == EGaitState::GS_Walking)
 	{
 		return 0.0f;
 	}
@@ -395,22 +777,22 @@ float UBaseAnimInstance::CalculateWalkRunBlend() const
 
 float UBaseAnimInstance::CalculateStrideBlend() const
 {
-	check(StrideBlendNWalk && StrideBlendNRun && StrideBlendCWalk);
+	check(BakedStrideBlendNWalk && BakedStrideBlendNRun && BakedStrideBlendCWalk);
 
 	// Get walk/run stride in current speed
-	float StandingWalkStride = StrideBlendNWalk->GetFloatValue(Proxy->Speed);
-	float StandingRunStride = StrideBlendNRun->GetFloatValue(Proxy->Speed);
+	float StandingWalkStride = BakedStrideBlendNWalk->Evaluate(Proxy->Locomotion.Speed);
+	float StandingRunStride = BakedStrideBlendNRun->Evaluate(Proxy->Locomotion.Speed);
 	// Get crouch stride in current speed
-	float CrouchingStride = StrideBlendCWalk->GetFloatValue(Proxy->Speed);
+	float CrouchingStride = BakedStrideBlendCWalk->Evaluate(Proxy->Locomotion.Speed);
 
 	// Get walk/run's current weight
-	float WalkRunGaitWeight = GetAnimCurveClamped(FName("Weight_Gait"), -1.0f, 0.0f, 1.0f);
+	float WalkRunGaitWeight = GetAnimCurveClamped(ELocomotionCurve::WeightGait, -1.0f, 0.0f, 1.0f);
 	
 	// Blend walk/run stride based on gait weight
 	float WalkRunStrideBlend = UKismetMathLibrary::Lerp(StandingWalkStride, StandingRunStride, WalkRunGaitWeight);
 
 	// Get crouching weight
-	float CrouchingStanceWeight = GetCurveValue(FName("BasePose_CLF"));
+	float CrouchingStanceWeight = Curves[ELocomotionCurve::BasePoseCLF];
 
 	// Blend blended-walkrun stride with crouch stride
 	float FinalStrideBlend = UKismetMathLibrary::Lerp(WalkRunStrideBlend, CrouchingStride, CrouchingStanceWeight);
@@ -418,42 +800,21 @@ float UBaseAnimInstance::CalculateStrideBlend() const
 	return FinalStrideBlend;
 }
 
-float UBaseAnimInstance::GetAnimCurveClamped(FName Name, float Bias, float ClampMin, float ClampMax) const
+float UBaseAnimInstance::GetAnimCurveClamped(ELocomotionCurve Curve, float Bias, float ClampMin, float ClampMax) const
 {
-	return FMath::Clamp(GetCurveValue(Name) + Bias, ClampMin, ClampMax);
-}
-
-float UBaseAnimInstance::GetAnimCurveCompact(FName Name) const
-{
-	return GetCurveValue(Name);
+	return FMath::Clamp(Curves[Curve] + Bias, ClampMin, ClampMax);
 }
 
 float UBaseAnimInstance::CalculateStandingPlayRate() const
 {
-	// Calculate current speed in different gait's animation speed rate.
-	float WalkSpeedRate = Proxy->Speed / AnimatedWalkSpeed;
-	float RunSpeedRate = Proxy->Speed / AnimatedRunSpeed;
-	float SprintSpeedRate = Proxy->Speed / AnimatedSprintSpeed;
-
 	// Weight_Gait in Walk Anima == 1, Run Anim == 2, Sprint Anim == 3
-	float WalkRunGaitWeight = GetAnimCurveClamped(FName("Weight_Gait"), -1.0f, 0.0f, 1.0f);
-	float WalkRunSpeedRate = UKismetMathLibrary::Lerp(WalkSpeedRate, RunSpeedRate, WalkRunGaitWeight);
-	float RunSprintGaitWeight = GetAnimCurveClamped(FName("Weight_Gait"), -2.0f, 0.0f, 1.0f);
-	float RunSprintSpeedRate = UKismetMathLibrary::Lerp(WalkRunSpeedRate, SprintSpeedRate, RunSprintGaitWeight);
-
-	// Keep sync with stride blend rate
-	float FinalSpeedRate = RunSprintSpeedRate / StrideBlend;
-	// scale the value by world z scale
-	FinalSpeedRate /= GetOwningComponent()->GetComponentScale().Z;
-	FinalSpeedRate = FMath::Clamp<float>(FinalSpeedRate, 0.0f, 3.0f);
-
-	return FinalSpeedRate;
+	return LocomotionMath::StandingPlayRate(Proxy->Locomotion.Speed, AnimatedWalkSpeed, AnimatedRunSpeed, AnimatedSprintSpeed,
+	                                        Curves[ELocomotionCurve::WeightGait], StrideBlend, Proxy->GetComponentTransform().GetScale3D().Z);
 }
 
 float UBaseAnimInstance::CalculateCrouchingPlayRate() const
 {
-	float Result = FMath::Clamp(((Proxy->Speed / AnimatedCrouchSpeed) / StrideBlend) / GetOwningComponent()->GetComponentScale().Z, 0.0f, 2.0f);
-	return Result;
+	return LocomotionMath::CrouchingPlayRate(Proxy->Locomotion.Speed, AnimatedCrouchSpeed, StrideBlend, Proxy->GetComponentTransform().GetScale3D().Z);
 }
 
 void UBaseAnimInstance::UpdateRotationValues()
@@ -465,81 +826,41 @@ void UBaseAnimInstance::UpdateRotationValues()
 	// These values influence the "YawOffset" curve in the animgraph and are used to
 	// offset the characters rotation for more natural movement.
 	// The curves allow for fine control over how the offset behaves for each movement direction.
-	check(YawOffsetFB && YawOffsetLR);
-	float DeltaYaw = UKismetMathLibrary::NormalizedDeltaRotator(Proxy->Velocity.ToOrientationRotator(), Proxy->AimingRotation).Yaw;
-	FYaw = YawOffsetFB->GetVectorValue(DeltaYaw).X;
-	BYaw = YawOffsetFB->GetVectorValue(DeltaYaw).Y;
-	LYaw = YawOffsetLR->GetVectorValue(DeltaYaw).X;
-	RYaw = YawOffsetLR->GetVectorValue(DeltaYaw).Y;
+	check(BakedYawOffsetFB && BakedYawOffsetLR);
+	float DeltaYaw = UKismetMathLibrary::NormalizedDeltaRotator(Proxy->Locomotion.Velocity.ToOrientationRotator(), Proxy->Locomotion.AimingRotation).Yaw;
+	const FVector YawOffsetFBValue = BakedYawOffsetFB->Evaluate(DeltaYaw);
+	const FVector YawOffsetLRValue = BakedYawOffsetLR->Evaluate(DeltaYaw);
+	FYaw = YawOffsetFBValue.X;
+	BYaw = YawOffsetFBValue.Y;
+	LYaw = YawOffsetLRValue.X;
+	RYaw = YawOffsetLRValue.Y;
 }
 
 EMovementDirection UBaseAnimInstance::CalculateMovementDirection() const
 {
-	if (Proxy->Gait == EGaitState::GS_Sprinting)
+	if (Proxy->Locomotion.Gait == EGaitState::GS_Sprinting)
 	{
 		return EMovementDirection::MD_Forward;
 	}
 	// Gait == Walking or Running
 	// RotationMode == Looking or Aiming
-	float Angle = UKismetMathLibrary::NormalizedDeltaRotator(UKismetMathLibrary::MakeRotFromX(Proxy->Velocity), Proxy->AimingRotation).Yaw;
-	return CalculateQuadrant(MovementDirection, 70.0f, -70.0f, 110.0f, -110.0f, 5.0f, Angle);
-}
-
-EMovementDirection UBaseAnimInstance::CalculateQuadrant(EMovementDirection Current,
-	                                                    float FRThreshold, float FLThreshold,
-	                                                    float BRThreshold, float BLThreshold,
-	                                                    float Buffer, float Angle) const
-{
-	// Calculate forward direction
-	bool IncreaseBuffer = Current != EMovementDirection::MD_Forward || Current != EMovementDirection::MD_Backward;
-	if (AngleInRange(Angle, FLThreshold, FRThreshold, Buffer, IncreaseBuffer))
-	{
-		return EMovementDirection::MD_Forward;
-	}
-
-	// Calculate right direction
-	IncreaseBuffer = Current != EMovementDirection::MD_Right || Current != EMovementDirection::MD_Left;
-	if (AngleInRange(Angle, FRThreshold, BRThreshold, Buffer, IncreaseBuffer))
-	{
-		return EMovementDirection::MD_Right;
-	}
-
-	// Calculate left direction
-	if (AngleInRange(Angle, BLThreshold, FLThreshold, Buffer, IncreaseBuffer))
-	{
-		return EMovementDirection::MD_Left;
-	}
-	
-	return EMovementDirection::MD_Backward;
-}
-
-bool UBaseAnimInstance::AngleInRange(float Angle,
-								     float MinAngle, float MaxAngle,
-								     float Buffer, bool bIncreaseBuffer) const
-{
-	if (bIncreaseBuffer)
-	{
-		return UKismetMathLibrary::InRange_FloatFloat(Angle, MinAngle - Buffer, MaxAngle + Buffer, true, true);
-	}
-	else
-	{
-		return UKismetMathLibrary::InRange_FloatFloat(Angle, MinAngle + Buffer, MaxAngle - Buffer, true, true);
-	}
+	float Angle = UKismetMathLibrary::NormalizedDeltaRotator(UKismetMathLibrary::MakeRotFromX(Proxy->Locomotion.Velocity), Proxy->Locomotion.AimingRotation).Yaw;
+	return LocomotionMath::Quadrant(MovementDirection, 70.0f, -70.0f, 110.0f, -110.0f, 5.0f, Angle);
 }
 
 bool UBaseAnimInstance::CanRotateInPlace() const
 {
-	return Proxy->RotationMode == ERotationMode::RM_Aiming;
+	return Proxy->Locomotion.RotationMode == ERotationMode::RM_Aiming;
 }
 
 bool UBaseAnimInstance::CanTurnInPlace() const
 {
-	return Proxy->RotationMode == ERotationMode::RM_Looking && GetCurveValue(FName("Enable_Transition")) > 0.99f;
+	return Proxy->Locomotion.RotationMode == ERotationMode::RM_Looking && Curves[ELocomotionCurve::EnableTransition] > 0.99f;
 }
 
 bool UBaseAnimInstance::CanDynamicTransition() const
 {
-	return GetCurveValue(FName("Enable_Transition")) == 1.0f;
+	return Curves[ELocomotionCurve::EnableTransition] == 1.0f;
 }
 
 void UBaseAnimInstance::RotateInPlaceCheck()
@@ -553,7 +874,7 @@ void UBaseAnimInstance::RotateInPlaceCheck()
 	// This makes the character rotate faster when moving the camera faster.
 	if (bRotateL || bRotateR)
 	{
-		RotateRate = UKismetMathLibrary::MapRangeClamped(Proxy->AimYawRate,
+		RotateRate = UKismetMathLibrary::MapRangeClamped(Proxy->Locomotion.AimYawRate,
 		                                              AimYawRateMinRange, AimYawRateMaxRange,
 		                                              MinPlayRate, MaxPlayRate);
 	}
@@ -565,7 +886,7 @@ void UBaseAnimInstance::TurnInPlaceCheck(float DeltaTime)
 	// and if the Aim Yaw Rate is below the Aim Yaw Rate Limit.
 	// If so, begin counting the Elapsed Delay Time. If not, reset the Elapsed Delay Time.
 	// This ensures the conditions remain true for a sustained peroid of time before turning in place.
-	if (FMath::Abs(AimingAngle.X) > TurnCheckMinAngle && Proxy->AimYawRate < AimYawRateLimit)
+	if (FMath::Abs(AimingAngle.X) > TurnCheckMinAngle && Proxy->Locomotion.AimYawRate < AimYawRateLimit)
 	{
 		ElapsedDelayTime += DeltaTime;
 		// Step 2: Check if the Elapsed Delay time exceeds the set delay (mapped to the turn angle range).
@@ -573,7 +894,9 @@ void UBaseAnimInstance::TurnInPlaceCheck(float DeltaTime)
 		float MappedAimingAngleX = UKismetMathLibrary::MapRangeClamped(FMath::Abs(AimingAngle.X), TurnCheckMinAngle, 180.0f, MinAngleDelay, MaxAngleDelay);
 		if (ElapsedDelayTime > MappedAimingAngleX)
 		{
-			FRotator TargetRotation(0.0f, Proxy->AimingRotation.Yaw, 0.0f);
+			// Count the delay again from here, so the turn is triggered once, not on every update until its montage plays.
+			ElapsedDelayTime = 0.0f;
+			FRotator TargetRotation(0.0f, Proxy->Locomotion.AimingRotation.Yaw, 0.0f);
 			TurnInPlace(TargetRotation, 1.0f, 0.0f, false);
 		}
 	}
@@ -587,43 +910,61 @@ void UBaseAnimInstance::DynamicTransitionCheck()
 {
 }
 
-// TODO: 0 Finish Turn In Place
 void UBaseAnimInstance::TurnInPlace(FRotator TargetRotation, float PlayRateScale, float StartTime, bool bOverrideCurrent)
 {
 	// Step 1: Set Turn Angle
-	float TurnAngle = UKismetMathLibrary::NormalizedDeltaRotator(TargetRotation, Proxy->ActorRotation).Yaw;
+	float TurnAngle = UKismetMathLibrary::NormalizedDeltaRotator(TargetRotation, Proxy->Locomotion.ActorRotation).Yaw;
+
+	// Step 2: Choose Turn Asset based on the Turn Angle and Stance, resolved in TurnInPlaceTable.
+	// Null while the animations are still loading: the turn is skipped instead of loading them here.
+	const FTurnInPlaceTableEntry* TargetTurnAsset = TurnInPlaceTable.Find(Stance, TurnAngle);
+	if (TargetTurnAsset == nullptr) return;
+
+	// Step 3 and 4 start a montage, which is game thread only, see PlayPendingTurnInPlace.
+	PendingTurnInPlace = TargetTurnAsset;
+	PendingTurnInPlaceAngle = TurnAngle;
+	PendingTurnInPlacePlayRateScale = PlayRateScale;
+	PendingTurnInPlaceStartTime = StartTime;
+	bPendingTurnInPlaceOverride = bOverrideCurrent;
+}
 
-	// Step 2: Choose Turn Asset based on the Turn Angle and Stance
-	FTurnInPlaceAsset TargetTurnAsset;
-	if (FMath::Abs(TurnAngle) < Turn180Threshold)
-	{
-		if (TurnAngle < 0.0f)
-		{
+void UBaseAnimInstance::NativeUpdateAnimation(float DeltaSeconds)
+{
+	Super::NativeUpdateAnimation(DeltaSeconds);
 
-		}
-		else
+	// Game thread, before this frame's worker thread update: start the turn the last update picked.
+	PlayPendingTurnInPlace();
+}
+
+void UBaseAnimInstance::PlayPendingTurnInPlace()
+{
+	if (PendingTurnInPlace == nullptr) return;
+	const FTurnInPlaceTableEntry& TargetTurnAsset = *PendingTurnInPlace;
+	PendingTurnInPlace = nullptr;
+
+	// Step 3: If the Target Turn Animation is not playing or set to be overridden, play the turn animation as a dynamic montage.
+	if (bPendingTurnInPlaceOverride || !IsPlayingSlotAnimation(TargetTurnAsset.Animation, TargetTurnAsset.SlotName))
+	{
+		const float PlayRate = TargetTurnAsset.PlayRate * PendingTurnInPlacePlayRateScale;
+		if (PlaySlotAnimationAsDynamicMontage(TargetTurnAsset.Animation, TargetTurnAsset.SlotName, 0.2f, 0.2f, PlayRate, 1, 0.0f, PendingTurnInPlaceStartTime))
 		{
-			
+			PushAnimEvent(EAnimEventType::TurnInPlace, GetSkelMeshComponent()->GetComponentLocation(), PendingTurnInPlaceAngle, static_cast<uint8>(Stance));
 		}
+
+		// Step 4: Scale the rotation amount (gets scaled in AnimGraph) to compensate for turn angle (If Allowed) and play rate.
+		RotationScale = TargetTurnAsset.GetRotationScale(PendingTurnInPlaceAngle) * PendingTurnInPlacePlayRateScale;
 	}
-	else
-	{
-		
-	}
-	
 }
 
-void UBaseAnimInstance::SetFootLocking(FName EnableFootIKCurve, FName FootLockCurve, FName IKFootBone,
+void UBaseAnimInstance::SetFootLocking(ELocomotionCurve EnableFootIKCurve, ELocomotionCurve FootLockCurve, const FTransform& IKFootTransform,
 	float& CurrentFootLockAlpha, FVector& CurrentFootLockLocation, FRotator& CurrentFootLockRotation, float DeltaSeconds)
 {
 	// Only update values if FootIK curve has a weight.
-	if (GetCurveValue(EnableFootIKCurve) <= 0.0f) return;
+	if (Curves[EnableFootIKCurve] <= 0.0f) return;
 
 	// Step 1: Set Local FootLock Curve value
-	float FootLockCurveValue = GetCurveValue(FootLockCurve);
-
-	//UE_LOG(LogTemp, Warning, TEXT("%s FootLockCurveValue: %f"), *FootLockCurve.ToString(), FootLockCurveValue);
-	//UE_LOG(LogTemp, Warning, TEXT("%s CurrentFootLockAlpha: %f"), *FootLockCurve.ToString(), CurrentFootLockAlpha);
+	float FootLockCurveValue = Curves[FootLockCurve];
+	const bool bWasLocked = CurrentFootLockAlpha >= 0.99f;
 
 	// Step 2: Only update the FootLock Alpha if the new value is less than the current,
 	// or it equals 1. This makes it so that the foot can only blend out of the locked position
@@ -631,16 +972,23 @@ void UBaseAnimInstance::SetFootLocking(FName EnableFootIKCurve, FName FootLockCu
 	if (FootLockCurveValue >= 0.99f || FootLockCurveValue < CurrentFootLockAlpha)
 	{
 		CurrentFootLockAlpha = FootLockCurveValue;
-		//UE_LOG(LogTemp, Warning, TEXT("%s New CurrentFootLockAlpha: %f"), *FootLockCurve.ToString(), CurrentFootLockAlpha);
 	}
 
 	// Step 3: If the Foot Lock curve equals 1,
 	// save the new lock location and rotation in component space.
 	if (CurrentFootLockAlpha >= 0.99f)
 	{
-		FTransform FootBoneTransform = GetOwningComponent()->GetSocketTransform(IKFootBone, RTS_Component);
-		CurrentFootLockLocation = FootBoneTransform.GetLocation();
-		CurrentFootLockRotation = FootBoneTransform.Rotator();
+		CurrentFootLockLocation = IKFootTransform.GetLocation();
+		CurrentFootLockRotation = IKFootTransform.Rotator();
+	}
+
+	// A foot locking is a footstep.
+	const bool bLocked = CurrentFootLockAlpha >= 0.99f;
+	if (bLocked != bWasLocked)
+	{
+		PushAnimEvent(bLocked ? EAnimEventType::FootLocked : EAnimEventType::FootUnlocked,
+		              Proxy->GetComponentTransform().TransformPosition(IKFootTransform.GetLocation()),
+		              CurrentFootLockAlpha, EnableFootIKCurve == ELocomotionCurve::EnableFootIKL ? 0 : 1);
 	}
 
 	// Step 4: If the Foot Lock Alpha has a weight,
@@ -656,15 +1004,15 @@ void UBaseAnimInstance::SetFootLockOffsets(FVector& LocalLocation, FRotator& Loc
 	// Use the delta between the current and last updated rotation
 	// to find how much the foot should be rotated to remain planted on the ground.
 	FRotator RotationDifference;
-	if (Proxy->bIsMovingOnGround)
+	if (Proxy->Locomotion.bIsMovingOnGround)
 	{
-		RotationDifference = UKismetMathLibrary::NormalizedDeltaRotator(Proxy->ActorRotation, Proxy->LastUpdateRotation);
+		RotationDifference = UKismetMathLibrary::NormalizedDeltaRotator(Proxy->Locomotion.ActorRotation, Proxy->Locomotion.LastUpdateRotation);
 	}
 
 	// Get the distance traveled between frames relative to the mesh rotation
 	// to find how much the foot should be offset to remain planted on the ground.
 	// Get component's world rotation
-	FVector LocationDifference = GetOwningComponent()->GetComponentRotation().UnrotateVector(Proxy->Velocity * DeltaSeconds);
+	FVector LocationDifference = Proxy->GetComponentTransform().GetRotation().UnrotateVector(Proxy->Locomotion.Velocity * DeltaSeconds);
 	
 	// Subtract the location difference from the current local location and rotate it
 	// by the rotation difference to keep the foot planted in component space.
@@ -674,17 +1022,17 @@ void UBaseAnimInstance::SetFootLockOffsets(FVector& LocalLocation, FRotator& Loc
 	LocalRotation = UKismetMathLibrary::NormalizedDeltaRotator(LocalRotation, RotationDifference);
 }
 
-void UBaseAnimInstance::SetFootOffsets(FName EnableFootIKCurve, FName IKFootBone, FName RootBone,
+void UBaseAnimInstance::SetFootOffsets(ELocomotionCurve EnableFootIKCurve, const FTransform& IKFootTransform, const FTransform& RootTransform, FFootTrace& FootTrace,
 	FVector& CurrentLocationTarget, FVector& CurrentLocationOffset, FRotator& CurrentRotationOffset, float DeltaSeconds)
 {
 	// Only update Foot IK offset values if the Foot IK curve has a weight.
 	// If it equals 0, clear the offset values.
-	if (GetCurveValue(EnableFootIKCurve) > 0.0f)
+	if (Curves[EnableFootIKCurve] > 0.0f)
 	{
 		// Step 1: Trace downward from the foot location to find the geometry.
 		// If the surface is walkable, save the Impact Location and Normal.
-		FVector FootBoneLocation = GetOwningComponent()->GetSocketLocation(IKFootBone);
-		FVector RootBoneLocation = GetOwningComponent()->GetSocketLocation(RootBone);
+		FVector FootBoneLocation = Proxy->GetComponentTransform().TransformPosition(IKFootTransform.GetLocation());
+		FVector RootBoneLocation = Proxy->GetComponentTransform().TransformPosition(RootTransform.GetLocation());
 		FVector IKFootFloorLocation(FootBoneLocation.X, FootBoneLocation.Y, RootBoneLocation.Z);
 
 		FVector LineTraceStartLocation = IKFootFloorLocation + FVector(0.0f, 0.0f, IKTraceDistanceAboveFoot);
@@ -692,19 +1040,28 @@ void UBaseAnimInstance::SetFootOffsets(FName EnableFootIKCurve, FName IKFootBone
 
 		FRotator TargetRotationOffset;
 		
-		FHitResult HitResult;
-		TArray<AActor*> ActorsToIgnore;
 		FVector ImpactPoint;
 		FVector ImpactNormal;
 		// UKismetSystemLibrary::LineTraceSingle(Proxy.Character, LineTraceStartLocation, LineTraceEndLocation, UEngineTypes::ConvertToTraceType(ECC_Visibility), false, ActorsToIgnore, EDrawDebugTrace::ForOneFrame, HitResult, true);
-		FCollisionQueryParams QueryParams;
-		QueryParams.bTraceComplex = false;
-		QueryParams.AddIgnoredActor(Proxy->Character);
-		GetWorld()->LineTraceSingleByChannel(HitResult, LineTraceStartLocation, LineTraceEndLocation, ECC_Visibility, QueryParams);
-		if (Proxy->MovementComponent->IsWalkable(HitResult))
+		FHitResult SyncHitResult;
+		const FHitResult* HitResult = nullptr;
+		if (AnimTraceSubsystem && UAnimTraceSubsystem::IsAsyncFootTraceEnabled())
+		{
+			// Traced after this update, use the hit of the last frame's request.
+			FootTrace.Start = LineTraceStartLocation;
+			FootTrace.End = LineTraceEndLocation;
+			FootTrace.bRequested = true;
+			HitResult = FootTrace.bHasResult ? &FootTrace.HitResult : nullptr;
+		}
+		else
 		{
-			ImpactPoint = HitResult.ImpactPoint;
-			ImpactNormal = HitResult.ImpactNormal;
+			GetWorld()->LineTraceSingleByChannel(SyncHitResult, LineTraceStartLocation, LineTraceEndLocation, ECC_Visibility, AnimTraces.QueryParams);
+			HitResult = &SyncHitResult;
+		}
+		if (HitResult && Proxy->IsWalkable(*HitResult))
+		{
+			ImpactPoint = HitResult->ImpactPoint;
+			ImpactNormal = HitResult->ImpactNormal;
 
 			// Step 1.1: Find the difference in location from the Impact point and
 			// the expected (flat) floor location. These values are offset by the nomrmal multiplied by
@@ -741,7 +1098,7 @@ void UBaseAnimInstance::SetPelvisIKOffset(FVector FootOffsetLTarget, FVector Foo
 {
 	// Calculate the Pelvis Alpha by finding the average Foot IK weight.
 	// If the alpha is 0, clear the offset.
-	PelvisAlpha = (GetCurveValue("Enable_FootIK_L") + GetCurveValue("Enable_FootIK_R")) / 2.0f;
+	PelvisAlpha = (Curves[ELocomotionCurve::EnableFootIKL] + Curves[ELocomotionCurve::EnableFootIKR]) / 2.0f;
 	if (PelvisAlpha <= 0.0f)
 	{
 		PelvisOffset = FVector::Zero();
@@ -760,35 +1117,74 @@ void UBaseAnimInstance::SetPelvisIKOffset(FVector FootOffsetLTarget, FVector Foo
 	PelvisOffset = UKismetMathLibrary::VInterpTo(PelvisOffset, PelvisTarget, DeltaSeconds, InterpSpeed);
 }
 
-void UBaseAnimInstance::UpdateInAirValues()
+void UBaseAnimInstance::UpdateInAirValues(float DeltaSeconds)
 {
 	// Update the fall speed. Setting this value only while in the air allows you to use it within the AnimGraph for the landing strength.
 	// If not, the Z velocity would return to 0 on landing. 
-	FallSpeed = Proxy->Velocity.Z;
+	FallSpeed = Proxy->Locomotion.Velocity.Z;
 
-	// Set the Land Prediction weight.
-	LandPrediction = CalculateLandPrediction();
+	// Set the Land Prediction weight, the landing blend is cosmetic.
+	if (!bServerAnimationProfile)
+	{
+		LandPrediction = CalculateLandPrediction(DeltaSeconds);
+	}
 }
 
-float UBaseAnimInstance::CalculateLandPrediction()
+float UBaseAnimInstance::CalculateLandPrediction(float DeltaSeconds)
 {
-	if (FallSpeed >= -200.0f) return 0.0f;
+	FLandPredictionSweep& Sweep = AnimTraces.LandPrediction;
+	if (FallSpeed >= -200.0f)
+	{
+		// Start the next fall at this character's phase, without the ground of this one.
+		LandPredictionSweepAge = LandPredictionSweepPhase * UAnimTraceSubsystem::GetLandPredictionSweepInterval();
+		Sweep.bHasResult = false;
+		return 0.0f;
+	}
 
-	FHitResult HitResult;
-	FVector Start = Proxy->CapsuleLocation;
-	FVector ClampedVelocity = FVector(Proxy->Velocity.X, Proxy->Velocity.Y, FMath::Clamp(Proxy->Velocity.Z, -4000.0f, -200.0f));
+	FVector Start = Proxy->Locomotion.CapsuleLocation;
+	FVector ClampedVelocity = FVector(Proxy->Locomotion.Velocity.X, Proxy->Locomotion.Velocity.Y, FMath::Clamp(Proxy->Locomotion.Velocity.Z, -4000.0f, -200.0f));
 	FVector NormalizedVelocity = ClampedVelocity.GetUnsafeNormal();
-	float MappedFallSpeed = UKismetMathLibrary::MapRangeClamped(Proxy->Velocity.Z, 0.0f, -4000.0f, 50.0f, 2000.0f);
+	float MappedFallSpeed = UKismetMathLibrary::MapRangeClamped(Proxy->Locomotion.Velocity.Z, 0.0f, -4000.0f, 50.0f, 2000.0f);
 	FVector End = Start + NormalizedVelocity * MappedFallSpeed;
-	FName ProfileName = "ALS_Character";
-	FCollisionQueryParams QueryParams;
-	QueryParams.bTraceComplex = false;
-	QueryParams.AddIgnoredActor(Proxy->Character);
+	FCollisionShape Shape = FCollisionShape::MakeCapsule(Proxy->Locomotion.CapsuleRadius, Proxy->Locomotion.CapsuleHalfHeight);
+
+	if (AnimTraceSubsystem && UAnimTraceSubsystem::IsAsyncLandPredictionEnabled())
+	{
+		// Shares the locomotion LOD distance, nobody is close enough to see the landing.
+		if (Proxy->Locomotion.bBeyondLODDistance)
+		{
+			LandPredictionSweepAge = LandPredictionSweepPhase * UAnimTraceSubsystem::GetLandPredictionSweepInterval();
+			Sweep.bHasResult = false;
+			return 0.0f;
+		}
+
+		LandPredictionSweepAge += DeltaSeconds;
+		if (LandPredictionSweepAge >= UAnimTraceSubsystem::GetLandPredictionSweepInterval())
+		{
+			LandPredictionSweepAge = 0.0f;
+			Sweep.Start = Start;
+			Sweep.End = End;
+			Sweep.Shape = Shape;
+			Sweep.bRequested = true;
+		}
+
+		if (!Sweep.bHasResult || !Sweep.HitResult.bBlockingHit || !Proxy->IsWalkable(Sweep.HitResult)) return 0.0f;
+
+		// Extrapolate the last hit: the distance left to it along this frame's fall direction,
+		// over this frame's sweep length, is the Time this frame's sweep would have hit at.
+		float RemainingDistance = FVector::DotProduct(Sweep.HitResult.Location - Start, NormalizedVelocity);
+		float Time = FMath::Max(RemainingDistance, 0.0f) / MappedFallSpeed;
+		if (Time > 1.0f) return 0.0f;
+
+		return UKismetMathLibrary::Lerp(BakedLandPredictionCurve->Evaluate(Time), 0.0f, Curves[ELocomotionCurve::MaskLandPrediction]);
+	}
+
+	FHitResult HitResult;
 	// UKismetSystemLibrary::CapsuleTraceSingleByProfile()
-	GetWorld()->SweepSingleByProfile(HitResult, Start, End, FQuat::Identity, ProfileName, FCollisionShape::MakeCapsule(Proxy->CapsuleRadius, Proxy->CapsuleHalfHeight), QueryParams);
-	if (Proxy->MovementComponent->IsWalkable(HitResult) && HitResult.bBlockingHit)
+	GetWorld()->SweepSingleByProfile(HitResult, Start, End, FQuat::Identity, FLandPredictionSweep::ProfileName, Shape, AnimTraces.QueryParams);
+	if (Proxy->IsWalkable(HitResult) && HitResult.bBlockingHit)
 	{
-		return UKismetMathLibrary::Lerp(LandPredictionCurve->GetFloatValue(HitResult.Time), 0.0f, GetCurveValue("Mask_LandPrediction"));
+		return UKismetMathLibrary::Lerp(BakedLandPredictionCurve->Evaluate(HitResult.Time), 0.0f, Curves[ELocomotionCurve::MaskLandPrediction]);
 	}
 	
 	return 0.0f;
@@ -4,10 +4,44 @@
 
 #include "CoreMinimal.h"
 #include "BaseCharacter.h"
+#include "DayOne/Data/BakedCurve.h"
+#include "DayOne/Data/LocomotionCurves.h"
+#include "DayOne/Data/MotionMatchingDatabase.h"
+#include "DayOne/Data/TurnInPlaceTable.h"
+#include "DayOne/Subsystem/AnimEventSubsystem.h"
+#include "DayOne/Subsystem/AnimTraceSubsystem.h"
 #include "Animation/AnimInstance.h"
 #include "Animation/AnimInstanceProxy.h"
 #include "BaseAnimInstance.generated.h"
 
+// The foot IK results of the update, read by the native foot lock, foot offset and pelvis nodes (see AnimNode_LocomotionIK.h).
+// Foot lock is in component space, the offsets in world space.
+struct FFootIKPoseInputs
+{
+	float FootLockLAlpha = 0.0f;
+	FVector FootLockLLocation = FVector::ZeroVector;
+	FRotator FootLockLRotation = FRotator::ZeroRotator;
+	float FootLockRAlpha = 0.0f;
+	FVector FootLockRLocation = FVector::ZeroVector;
+	FRotator FootLockRRotation = FRotator::ZeroRotator;
+	FVector FootOffsetLLocation = FVector::ZeroVector;
+	FRotator FootOffsetLRotation = FRotator::ZeroRotator;
+	FVector FootOffsetRLocation = FVector::ZeroVector;
+	FRotator FootOffsetRRotation = FRotator::ZeroRotator;
+	float PelvisAlpha = 0.0f;
+	FVector PelvisOffset = FVector::ZeroVector;
+};
+
+// The pose motion matching picked this update, read by the native motion matching player node (see AnimNode_MotionMatchingPlayer.h).
+struct FMotionMatchingPoseInputs
+{
+	const UAnimSequence* Sequence = nullptr;
+	float Time = 0.0f;
+	bool bActive = false;
+	// Jumped to another pose this update.
+	bool bJumped = false;
+};
+
 /**
  * 
  */
@@ -25,44 +59,35 @@ struct FBaseAnimInstanceProxy : public FAnimInstanceProxy
 	// virtual void PostUpdate(UAnimInstance* InAnimInstance) const override;
 
 	// Update functions
-	// Get Information from the Character via the Character Interface to use throughout the AnimBP and AnimGraph.
+	// Get Information from the Character's locomotion snapshot to use throughout the AnimBP and AnimGraph.
 	void UpdateCharacterInfo();
+	// Capture the bones the foot IK reads from the last evaluated pose.
+	void UpdateBoneInfo(const USkeletalMeshComponent* Mesh);
+
+	// UCharacterMovementComponent::IsWalkable against the captured WalkableFloorZ, safe on the worker thread.
+	// Per-component walkable slope overrides are not applied, reading them would touch the hit component.
+	FORCEINLINE bool IsWalkable(const FHitResult& Hit) const
+	{
+		return Hit.IsValidBlockingHit() && Hit.ImpactNormal.Z >= KINDA_SMALL_NUMBER && Hit.ImpactNormal.Z >= WalkableFloorZ;
+	}
 	
 	UPROPERTY(Transient)
 	class ABaseCharacter* Character;
 	UPROPERTY(Transient)
 	class ULocomotionComponent* MovementComponent;
 	
-	// Essentials variables
-	FVector Velocity;
-	FVector PhysicalAcceleration;
-	FVector MovementInput;
-	bool bIsMoving;
-	bool bIsMovingOnGround;
-	bool bHasMovementInput;
-	float Speed;
-	float MovementInputAmount;
-	FRotator AimingRotation;
-	float AimYawRate;
-	FRotator ActorRotation;
-	FRotator LastUpdateRotation;
-	float MaxMovementInput;
-	float MaxBrakingDeceleration;
-	bool bIsWalkable;
-
-	// Character capsule info.
-	// Capsule's world location;
-	FVector CapsuleLocation;
-	float CapsuleRadius;
-	float CapsuleHalfHeight;
-
-	// Current State variables
-	EMovementState MovementState;
-	EMovementState PrevMovementState;
-	EMovementAction MovementAction;
-	ERotationMode RotationMode;
-	EGaitState Gait;
-	EStanceState Stance;
+	// Locomotion state of this frame, copied from ULocomotionComponent::GetSnapshot().
+	FLocomotionSnapshot Locomotion;
+	// UCharacterMovementComponent::GetWalkableFloorZ() of this frame, see IsWalkable.
+	float WalkableFloorZ = 0.71f;
+	// Component space, see UpdateBoneInfo. The component transform is FAnimInstanceProxy::GetComponentTransform().
+	FTransform IKFootLTransform;
+	FTransform IKFootRTransform;
+	FTransform RootTransform;
+	// Written at the end of UBaseAnimInstance::UpdateFootIK, on the update thread, before the graph updates.
+	FFootIKPoseInputs FootIK;
+	// Written after UBaseAnimInstance::UpdateMotionMatching, on the update thread, before the graph updates.
+	FMotionMatchingPoseInputs MotionMatching;
 };
 
 USTRUCT(BlueprintType, meta=(ScriptName="VelocityBlend"))
@@ -89,35 +114,17 @@ struct FLeanAmount
 	float FB;
 };
 
-UENUM(BlueprintType, meta=(ScriptName="MovementDirection"))
-enum class EMovementDirection : uint8
+// Anim parameters computed for this frame by ULocomotionSubsystem::UpdateAnimParameters.
+struct FBatchedAnimParameters
 {
-	MD_Forward = 0 UMETA(DisplayName = "Forward"),
-	MD_Right UMETA(DisplayName = "Right"),
-	MD_Left UMETA(DisplayName = "Left"),
-	MD_Backward UMETA(DisplayName = "Backward"),
-	MD_MAX
-};
-
-USTRUCT(BlueprintType)
-struct FTurnInPlaceAsset : public FTableRowBase
-{
-	GENERATED_BODY()
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	class UAnimSequence* Animation;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	float AnimatedAngle;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	FName SlotName;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	float PlayRate;
-	
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	bool bScaleTurnAngle;
+	FVelocityBlend VelocityBlend;
+	FVector RelativeAccelerationAmount;
+	FLeanAmount LeanAmount;
+	FVector2d AimingAngle;
+	// Delta time the values were interpolated with, they are used only if the anim update has the same.
+	float DeltaSeconds = 0.0f;
+	// Set by the subsystem, cleared by the anim update that consumes them.
+	bool bValid = false;
 };
 
 UCLASS()
@@ -126,10 +133,13 @@ class DAYONE_API UBaseAnimInstance : public UAnimInstance
 	GENERATED_BODY()
 
 	virtual void NativeInitializeAnimation() override;
+	virtual void NativeUninitializeAnimation() override;
+	virtual void NativeUpdateAnimation(float DeltaSeconds) override;
 	virtual void NativeThreadSafeUpdateAnimation(float DeltaSeconds) override;
 	
 public:
 	friend struct FBaseAnimInstanceProxy;
+	friend class ULocomotionSubsystem;
 
 protected:
 	FBaseAnimInstanceProxy* Proxy;
@@ -147,6 +157,7 @@ protected:
 
 	// Update functions
 	void UpdateCharacterInfo(float DeltaSeconds);
+	void UpdateAimingAngle();
 	void UpdateAimingValues(float DeltaSeconds);
 	void UpdateLayerValues(float DeltaSeconds);
 	void UpdateFootIK(float DeltaSeconds);
@@ -228,6 +239,9 @@ protected:
 	bool bIsMoving;
 	bool bRotateL;
 	bool bRotateR;
+	// Edge detection of bShouldMove, per instance.
+	bool bChangedToTrueLogicGate;
+	bool bChangedToFalseLogicGate;
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
 	FVelocityBlend VelocityBlend;
 	float DiagonalScaleAmount;
@@ -256,8 +270,31 @@ protected:
 	float AimYawRateLimit;
 	float MinAngleDelay;
 	float MaxAngleDelay;
-	//UPROPERTY(EditDefaultsOnly, BlueprintReadOnly)
-	//FTurnInPlaceAsset* N_TurnIP_L90;
+	UPROPERTY(EditDefaultsOnly, Category="TurnInPlace")
+	FTurnInPlaceAsset N_TurnIP_L90;
+	UPROPERTY(EditDefaultsOnly, Category="TurnInPlace")
+	FTurnInPlaceAsset N_TurnIP_R90;
+	UPROPERTY(EditDefaultsOnly, Category="TurnInPlace")
+	FTurnInPlaceAsset N_TurnIP_L180;
+	UPROPERTY(EditDefaultsOnly, Category="TurnInPlace")
+	FTurnInPlaceAsset N_TurnIP_R180;
+	UPROPERTY(EditDefaultsOnly, Category="TurnInPlace")
+	FTurnInPlaceAsset CLF_TurnIP_L90;
+	UPROPERTY(EditDefaultsOnly, Category="TurnInPlace")
+	FTurnInPlaceAsset CLF_TurnIP_R90;
+	UPROPERTY(EditDefaultsOnly, Category="TurnInPlace")
+	FTurnInPlaceAsset CLF_TurnIP_L180;
+	UPROPERTY(EditDefaultsOnly, Category="TurnInPlace")
+	FTurnInPlaceAsset CLF_TurnIP_R180;
+	// The assets above by stance and turn, built on initialize. Their animations load at spawn.
+	FTurnInPlaceTable TurnInPlaceTable;
+	TSharedPtr<struct FStreamableHandle> TurnInPlaceLoadHandle;
+	// Picked by the worker thread update, played on the game thread by the next NativeUpdateAnimation.
+	const FTurnInPlaceTableEntry* PendingTurnInPlace = nullptr;
+	float PendingTurnInPlaceAngle;
+	float PendingTurnInPlacePlayRateScale;
+	float PendingTurnInPlaceStartTime;
+	bool bPendingTurnInPlaceOverride;
 	// RotateInPlace values
 	float RotateMinThreshold;
 	float RotateMaxThreshold;
@@ -294,6 +331,55 @@ protected:
 	class UCurveVector* YawOffsetLR;
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly)
 	class UCurveFloat* LandPredictionCurve;
+	// The blend curves baked by UCurveBakeSubsystem, read on the worker thread instead of the authoring curves.
+	TSharedPtr<const FBakedCurveFloat> BakedDiagonalScaleAmountCurve;
+	TSharedPtr<const FBakedCurveFloat> BakedStrideBlendNWalk;
+	TSharedPtr<const FBakedCurveFloat> BakedStrideBlendNRun;
+	TSharedPtr<const FBakedCurveFloat> BakedStrideBlendCWalk;
+	TSharedPtr<const FBakedCurveVector> BakedYawOffsetFB;
+	TSharedPtr<const FBakedCurveVector> BakedYawOffsetLR;
+	TSharedPtr<const FBakedCurveFloat> BakedLandPredictionCurve;
+	// Anim curves of the last evaluated pose, read once at the start of the update.
+	FLocomotionCurveBundle Curves;
+	// Foot IK ground traces and land prediction sweep, run by UAnimTraceSubsystem when it is registered there.
+	FAnimTraceSet AnimTraces;
+	// Time since the last land prediction sweep request.
+	float LandPredictionSweepAge;
+	// Random fraction of the sweep interval a fall starts at, so characters falling together sweep on different frames.
+	float LandPredictionSweepPhase;
+	// On a dedicated server with DayOne.Anim.ServerProfile, only the values gameplay depends on are updated.
+	bool bDedicatedServer;
+	bool bServerAnimationProfile;
+	UPROPERTY(Transient)
+	UAnimTraceSubsystem* AnimTraceSubsystem = nullptr;
+	// Receives the footstep, landing, turn in place and gait change events of the update.
+	UPROPERTY(Transient)
+	UAnimEventSubsystem* AnimEventSubsystem = nullptr;
+	// False until the first update, so the first gait and movement state are not reported as changes.
+	bool bHasCharacterInfo;
+	// Written by ULocomotionSubsystem before the mesh ticks, see DayOne.Anim.ParameterBatch.
+	FBatchedAnimParameters BatchedParameters;
+	// Does this update use BatchedParameters instead of computing the values itself?
+	bool bUseBatchedParameters = false;
+	// Motion matching locomotion mode, see DayOne.Anim.MotionMatching.
+	// While bMotionMatching is set, the Motion Matching Player node plays MotionMatchingSequence at MotionMatchingTime
+	// instead of its source pose (the blended cycles), and requests an inertial blend on every jump.
+	UPROPERTY(EditDefaultsOnly, Category="MotionMatching")
+	UMotionMatchingDatabase* MotionMatchingDatabase;
+	UPROPERTY(BlueprintReadOnly, Category="MotionMatching")
+	bool bMotionMatching;
+	UPROPERTY(BlueprintReadOnly, Category="MotionMatching")
+	UAnimSequence* MotionMatchingSequence;
+	UPROPERTY(BlueprintReadOnly, Category="MotionMatching")
+	float MotionMatchingTime;
+	// Set for the update that jumped to another pose.
+	UPROPERTY(BlueprintReadOnly, Category="MotionMatching")
+	bool bMotionMatchingJumped;
+	// Database sequence playing, INDEX_NONE before the first update in the mode.
+	int32 MotionMatchingSequenceIndex;
+	// Time since the last search ended.
+	float MotionMatchingSearchAge;
+	FMotionMatchingSearchState MotionMatchingSearch;
 	
 private:
 	// Enable Movement Animations if IsMoving and HasMovementInput,
@@ -319,6 +405,8 @@ private:
 	// and 1 equals the Max Acceleration of the Character Movement Component.
 	FVector CalculateRelativeAccelerationAmount() const;
 	FLeanAmount InterpLeanAmount(FLeanAmount Current, FLeanAmount Target, float InterpSpeed, float DeltaTime) const;
+	// DayOne.Anim.ParameterBatch.Validate: log when a batched value is off the scalar one by more than the batch tolerance.
+	void ValidateBatchedParameter(const TCHAR* Name, double Batched, double Scalar) const;
 	// Calculate the Walk Run Blend.
 	// This value is used within the Blendspaces to blend between walking and running.
 	float CalculateWalkRunBlend() const;
@@ -330,8 +418,7 @@ private:
 	// preventing the character from needing to play a half walk+half run blend.
 	// The curves are used to map the stride amount to the speed for maximum control.
 	float CalculateStrideBlend() const;
-	float GetAnimCurveClamped(FName Name, float Bias, float ClampMin, float ClampMax) const;
-	float GetAnimCurveCompact(FName Name) const;
+	float GetAnimCurveClamped(ELocomotionCurve Curve, float Bias, float ClampMin, float ClampMax) const;
 	// Calculate the Play Rate by dividing the Character's speed by the Animated Speed for each gait.
 	// The lerps are determined by the "Weight_Gait" anim curve that exists on every locomotion cycle
 	// so that the play rate is always in sync with the currently blended animation.
@@ -349,14 +436,6 @@ private:
 	// the Looking Cirection / Aiming rotation modes,
 	// and is used in the Cycle Blending Anim Layers to blend to the appropriate directional states.
 	EMovementDirection CalculateMovementDirection() const;
-	// Take the input angle and determine its quadrant (direction).
-	// Use the current Movement Direction to increase or decrease the buffers on the angle ranges
-	// for each quadrant.
-	EMovementDirection CalculateQuadrant(EMovementDirection Current,
-		                                 float FRThreshold, float FLThreshold,
-		                                 float BRThreshold, float BLThreshold,
-		                                 float Buffer, float Angle) const;
-	bool AngleInRange(float Angle, float MinAngle, float MaxAngle, float Buffer, bool bIncreaseBuffer) const;
 
 	// Only perform a Rotate In Place Check if the character is Aiming or in First Person.
 	bool CanRotateInPlace() const;
@@ -381,21 +460,31 @@ private:
 	void DynamicTransitionCheck();
 
 	void TurnInPlace(FRotator TargetRotation, float PlayRateScale, float StartTime, bool bOverrideCurrent);
+	void PlayPendingTurnInPlace();
+	// Any thread. Location is in world space.
+	void PushAnimEvent(EAnimEventType Type, const FVector& Location, float Value, uint8 Param = 0) const;
+	void OnTurnInPlaceAnimationsLoaded();
+
+	// Advance the playing pose, and search the database for a better one within the budget.
+	void UpdateMotionMatching(float DeltaSeconds);
+	// The predicted trajectory of the character with the pose features of CurrentPose.
+	void BuildMotionMatchingQuery(int32 CurrentPose, FMotionMatchingQuery& OutQuery) const;
 
 	// Update IK helper functions
 	// Foot Lock
-	void SetFootLocking(FName EnableFootIKCurve, FName FootLockCurve, FName IKFootBone,
+	void SetFootLocking(ELocomotionCurve EnableFootIKCurve, ELocomotionCurve FootLockCurve, const FTransform& IKFootTransform,
 		                float& CurrentFootLockAlpha, FVector& CurrentFootLockLocation, FRotator& CurrentFootLockRotation, float DeltaSeconds);
 	void SetFootLockOffsets(FVector& LocalLocation, FRotator& LocalRotation, float DeltaSeconds);
 	// Offsets
-	void SetFootOffsets(FName EnableFootIKCurve, FName IKFootBone, FName RootBone,
+	void SetFootOffsets(ELocomotionCurve EnableFootIKCurve, const FTransform& IKFootTransform, const FTransform& RootTransform, FFootTrace& FootTrace,
 					FVector& CurrentLocationTarget, FVector& CurrentLocationOffset, FRotator& CurrentRotationOffset, float DeltaSeconds);
 	void SetPelvisIKOffset(FVector FootOffsetLTarget, FVector FootOffsetRTarget, float DeltaSeconds);
 
 	// In Air
-	void UpdateInAirValues();
+	void UpdateInAirValues(float DeltaSeconds);
 	// Calculate the land prediction weight by tracing in the velocity direction to find a walkable surface the character is falling toward,
 	// and getting the 'Time' (range of 0-1, 1 being maximum, 0 being about to land) till impact.
 	// The Land Prediction Curve is used to control how the time affects the final weight for a smooth blend.
-	float CalculateLandPrediction();
+	// While async, the sweep runs at DayOne.LandPrediction.SweepRate and its hit is extrapolated in between.
+	float CalculateLandPrediction(float DeltaSeconds);
 };
@@ -4,7 +4,9 @@
 #include "BaseCharacter.h"
 
 
+#include "DayOne/Component/HitboxPoseComponent.h"
 #include "DayOne/Component/LocomotionComponent.h"
+#include "DayOne/Component/OverlayLayerComponent.h"
 #include "DayOne/Component/ThirdPersonCameraComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Kismet/GameplayStatics.h"
@@ -15,6 +17,7 @@ FName ABaseCharacter::MoveRightInputName(TEXT("MoveRight"));
 FName ABaseCharacter::LookupInputName(TEXT("LookUp"));
 FName ABaseCharacter::TurnInputName(TEXT("Turn"));
 FName ABaseCharacter::StanceInputName(TEXT("Stance"));
+FName ABaseCharacter::AimInputName(TEXT("Aim"));
 
 ABaseCharacter::ABaseCharacter(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer.SetDefaultSubobjectClass<ULocomotionComponent>(CharacterMovementComponentName))
@@ -25,6 +28,8 @@ ABaseCharacter::ABaseCharacter(const FObjectInitializer& ObjectInitializer)
 	TurnRate = 1.25f;
 	
 	ThirdPersonCamera = CreateDefaultSubobject<UThirdPersonCameraComponent>(TEXT("ThirdPersonCamera"));
+	HitboxPose = CreateDefaultSubobject<UHitboxPoseComponent>(TEXT("HitboxPose"));
+	OverlayLayer = CreateDefaultSubobject<UOverlayLayerComponent>(TEXT("OverlayLayer"));
 }
 
 void ABaseCharacter::BeginPlay()
@@ -47,6 +52,8 @@ void ABaseCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputCompo
 	PlayerInputComponent->BindAxis(TurnInputName, this, &ThisClass::OnTurn);
 
 	PlayerInputComponent->BindAction(StanceInputName, EInputEvent::IE_Pressed, this, &ThisClass::OnStance);
+	PlayerInputComponent->BindAction(AimInputName, EInputEvent::IE_Pressed, this, &ThisClass::OnAimPressed);
+	PlayerInputComponent->BindAction(AimInputName, EInputEvent::IE_Released, this, &ThisClass::OnAimReleased);
 }
 
 void ABaseCharacter::PostInitializeComponents()
@@ -123,6 +130,17 @@ void ABaseCharacter::OnStance()
 	}
 }
 
+// Aiming is locomotion input, it reaches the server with the saved moves.
+void ABaseCharacter::OnAimPressed()
+{
+	Locomotion->SetWantsToAim(true);
+}
+
+void ABaseCharacter::OnAimReleased()
+{
+	Locomotion->SetWantsToAim(false);
+}
+
 /*
 void ABaseCharacter::OnStance()
 {
@@ -185,49 +203,3 @@ void ABaseCharacter::FixDiagonalGamepadValues(float InY, float InX, float& OutY,
 	OutY = UKismetMathLibrary::Clamp(InY * UKismetMathLibrary::MapRangeClamped(UKismetMathLibrary::Abs(InX), 0.0f, 0.6f, 1.0f, 1.2f), -1.0f, 1.0f);
 	OutX = UKismetMathLibrary::Clamp(InX * UKismetMathLibrary::MapRangeClamped(UKismetMathLibrary::Abs(InY), 0.0f, 0.6f, 1.0f, 1.2f), -1.0f, 1.0f);
 }
-
-EGaitState ABaseCharacter::GetGait() const
-{
-	return Locomotion->Gait;
-}
-
-EStanceState ABaseCharacter::GetStance() const
-{
-	return Locomotion->Stance;
-}
-
-void ABaseCharacter::GetEssentialValues(FVector& Velocity,
-	                                    FVector& PhysicalAcceleration,
-	                                    FVector& MovementInput,
-	                                    bool& IsMoving,
-	                                    bool& HasMovementInput,
-	                                    float& Speed,
-	                                    float& MovementInputAmount,
-	                                    FRotator& AimingRotation,
-	                                    float& AimYawRate) const
-{
-	Velocity = GetVelocity();
-	PhysicalAcceleration = Locomotion->PhysicalAcceleration;
-	MovementInput = Locomotion->GetCurrentAcceleration();
-	IsMoving = Locomotion->bIsMoving;
-	HasMovementInput = Locomotion->bHasMovementInput;
-	Speed = Locomotion->Speed;
-	MovementInputAmount = Locomotion->MovementInputAmount;
-	AimingRotation = GetControlRotation();
-	AimYawRate = Locomotion->AimYawRate;
-}
-
-void ABaseCharacter::GetCurrentStates(EMovementState& MovementState,
-	                                  EMovementState& PrevMovementState,
-	                                  EMovementAction& MovementAction,
-	                                  ERotationMode& RotationMode,
-	                                  EGaitState& ActualGait,
-	                                  EStanceState& ActualStance) const
-{
-	MovementState = Locomotion->MovementState;
-	PrevMovementState = Locomotion->PrevMovementState;
-	MovementAction = Locomotion->MovementAction;
-	RotationMode = Locomotion->RotationMode;
-	ActualGait = Locomotion->Gait;
-	ActualStance = Locomotion->Stance;
-}
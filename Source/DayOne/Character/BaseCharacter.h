@@ -3,7 +3,9 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "DayOne/Component/HitboxPoseComponent.h"
 #include "DayOne/Component/LocomotionComponent.h"
+#include "DayOne/Component/OverlayLayerComponent.h"
 #include "DayOne/Component/ThirdPersonCameraComponent.h"
 #include "DayOne/Data/CharacterState.h"
 #include "GameFramework/Character.h"
@@ -19,6 +21,7 @@ public:
 	static FName LookupInputName;
 	static FName TurnInputName;
 	static FName StanceInputName;
+	static FName AimInputName;
 
 public:
 	ABaseCharacter(const FObjectInitializer& ObjectInitializer);
@@ -31,26 +34,14 @@ public:
 	{
 		return ThirdPersonCamera;
 	}
-
-	EGaitState GetGait() const;
-	EStanceState GetStance() const;
-
-	void GetEssentialValues(FVector& Velocity,
-		                    FVector& PhysicalAcceleration,
-		                    FVector& MovementInput,
-		                    bool& IsMoving,
-		                    bool& HasMovementInput,
-		                    float& Speed,
-		                    float& MovementInputAmount,
-		                    FRotator& AimingRotation,
-		                    float& AimYawRate) const;
-
-	void GetCurrentStates(EMovementState& MovementState,
-		                  EMovementState& PrevMovementState,
-		                  EMovementAction& MovementAction,
-		                  ERotationMode& RotationMode,
-		                  EGaitState& ActualGait,
-		                  EStanceState& ActualStance) const;
+	FORCEINLINE UHitboxPoseComponent* GetHitboxPoseComponent() const
+	{
+		return HitboxPose;
+	}
+	FORCEINLINE UOverlayLayerComponent* GetOverlayLayerComponent() const
+	{
+		return OverlayLayer;
+	}
 
 protected:
 	//
@@ -71,6 +62,8 @@ protected:
 	void OnLookUp(float Value);
 	void OnTurn(float Value);
 	void OnStance();
+	void OnAimPressed();
+	void OnAimReleased();
 	
 	//
 	// Utility functions.
@@ -89,6 +82,10 @@ private:
 	// Components
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
 	class UThirdPersonCameraComponent* ThirdPersonCamera;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
+	class UHitboxPoseComponent* HitboxPose;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
+	class UOverlayLayerComponent* OverlayLayer;
 
 	// Properties
 	UPROPERTY(EditAnywhere, Category="InputProperty", meta=(AllowPrivateAccess="true"))
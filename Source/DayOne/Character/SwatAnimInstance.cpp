@@ -8,54 +8,111 @@
 #include "Kismet/KismetMathLibrary.h"
 #include "Navigation/PathFollowingComponent.h"
 
-void USwatAnimInstance::NativeInitializeAnimation()
+static const FName NAME_RightHand(TEXT("RightHand"));
+
+FSwatAnimInstanceProxy::FSwatAnimInstanceProxy()
+	: Super()
 {
-	Super::NativeInitializeAnimation();
+}
 
-	Character = Cast<ASwatCharacter>(TryGetPawnOwner());
+FSwatAnimInstanceProxy::FSwatAnimInstanceProxy(UAnimInstance* Instance)
+	: Super(Instance)
+{
 }
 
-void USwatAnimInstance::NativeUpdateAnimation(float DeltaSeconds)
+void FSwatAnimInstanceProxy::InitializeObjects(UAnimInstance* InAnimInstance)
 {
-	Super::NativeUpdateAnimation(DeltaSeconds);
+	FAnimInstanceProxy::InitializeObjects(InAnimInstance);
+
+	Character = Cast<ASwatCharacter>(InAnimInstance->TryGetPawnOwner());
+}
+
+void FSwatAnimInstanceProxy::PreUpdate(UAnimInstance* InAnimInstance, float DeltaSeconds)
+{
+	FAnimInstanceProxy::PreUpdate(InAnimInstance, DeltaSeconds);
 
 	// Get character anyway.
 	if (Character == nullptr)
 	{
-		Character = Cast<ASwatCharacter>(TryGetPawnOwner());
+		Character = Cast<ASwatCharacter>(InAnimInstance->TryGetPawnOwner());
 		if (Character == nullptr) return;
 	}
 
-	Weapon = Character->GetWeapon();
+	Velocity = Character->GetVelocity();
+	CurrentAcceleration = Character->GetCharacterMovement()->GetCurrentAcceleration();
+	bIsFalling = Character->GetCharacterMovement()->IsFalling();
+	bIsWeaponEquipped = Character->IsWeaponEquipped();
+	bIsCrouched = Character->IsCrouching();
+	bIsAiming = Character->IsAiming();
+	BaseAimRotation = Character->GetBaseAimRotation();
+	ActorRotation = Character->GetActorRotation();
+	AOYaw = Character->GetAOYaw();
+	AOPitch = Character->GetAOPitch();
+	TurnInPlace = Character->GetTurnInPlace();
+
+	// Computed once when the weapon is attached.
+	const FTransform* Offset = Character->GetLeftHandOffset();
+	bHasLeftHandOffset = Offset != nullptr;
+	if (bHasLeftHandOffset)
+	{
+		LeftHandOffset = *Offset;
+	}
+
+	// Otherwise the update only does the bone space math, the sockets are read here.
+	AWeapon* Weapon = Character->GetWeapon();
+	bHasWeapon = !bHasLeftHandOffset && Weapon && Weapon->GetMesh() && Character->GetMesh();
+	if (bHasWeapon)
+	{
+		LeftHandSocketTransform = Weapon->GetMesh()->GetSocketTransform(AWeapon::LeftHandSocketName, RTS_World);
+		RightHandTransform = Character->GetMesh()->GetSocketTransform(NAME_RightHand, RTS_World);
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+void USwatAnimInstance::NativeInitializeAnimation()
+{
+	Super::NativeInitializeAnimation();
+
+	Character = Cast<ASwatCharacter>(TryGetPawnOwner());
+}
+
+void USwatAnimInstance::NativeThreadSafeUpdateAnimation(float DeltaSeconds)
+{
+	Super::NativeThreadSafeUpdateAnimation(DeltaSeconds);
+
+	if (DeltaSeconds == 0.0f) return;
+	if (Proxy->Character == nullptr) return;
+	Character = Proxy->Character;
 
 	// Compute character speed on XY plane
-	FVector Velocity = Character->GetVelocity();
+	FVector Velocity = Proxy->Velocity;
 	Velocity.Z = 0.f;
 	Speed = Velocity.Size();
 
 	// Get character jumping status
-	bIsInAir = Character->GetCharacterMovement()->IsFalling();
+	bIsInAir = Proxy->bIsFalling;
 	// Accelerating indicates whether the player is still input 
-	bIsAccelerating = Character->GetCharacterMovement()->GetCurrentAcceleration().Size() > 0.f ? true : false;
+	bIsAccelerating = Proxy->CurrentAcceleration.Size() > 0.f ? true : false;
 	// Get character weapon state
-	bIsWeaponEquipped = Character->IsWeaponEquipped();
+	bIsWeaponEquipped = Proxy->bIsWeaponEquipped;
 
 	// Get character crouch state
-	bIsCrouched = Character->IsCrouching();
+	bIsCrouched = Proxy->bIsCrouched;
 
 	// Get character aiming state
-	bIsAiming = Character->IsAiming();
+	bIsAiming = Proxy->bIsAiming;
 
 	// Get jog and lean info
-	FRotator AimingDirRotation = Character->GetBaseAimRotation();
-	FRotator MovingDirRotation = UKismetMathLibrary::MakeRotFromX(Character->GetVelocity());
+	FRotator AimingDirRotation = Proxy->BaseAimRotation;
+	FRotator MovingDirRotation = UKismetMathLibrary::MakeRotFromX(Proxy->Velocity);
 	FRotator DeltaMovingRotation = UKismetMathLibrary::NormalizedDeltaRotator(MovingDirRotation, AimingDirRotation);
 	CurrentDeltaMovingRotation = UKismetMathLibrary::RInterpTo(CurrentDeltaMovingRotation, DeltaMovingRotation, DeltaSeconds, 5);
 	YawOffset = CurrentDeltaMovingRotation.Yaw;
 	//UE_LOG(LogTemp, Warning, TEXT("Facing Rot: %f, Moving Rot: %f, Delta Rot: %f, YawOffset: %f"), AimingDirRotation.Yaw, MovingDirRotation.Yaw, DeltaMovingRotation.Yaw, YawOffset);
 	
 	LastFrameCharacterRotation = CurrFrameCharacterRotation;
-	CurrFrameCharacterRotation = Character->GetActorRotation();
+	CurrFrameCharacterRotation = Proxy->ActorRotation;
 	//UE_LOG(LogTemp, Warning, TEXT("LastFrameCharacterRotation yaw: %f, CurrFrameCharacterRotation yaw: %f"), LastFrameCharacterRotation.Yaw, CurrFrameCharacterRotation.Yaw);
 	FRotator DeltaActorRotation = UKismetMathLibrary::NormalizedDeltaRotator(CurrFrameCharacterRotation, LastFrameCharacterRotation);
 	//UE_LOG(LogTemp, Warning, TEXT("LastFrameCharacterRotation yaw: %f, CurrentDeltaMovingRotation yaw: %f, DeltaActorRotation yaw: %f"), LastFrameCharacterRotation.Yaw, CurrentDeltaMovingRotation.Yaw, DeltaActorRotation.Yaw);
@@ -66,24 +123,28 @@ void USwatAnimInstance::NativeUpdateAnimation(float DeltaSeconds)
 	//UE_LOG(LogTemp, Warning, TEXT("Lean: %f"), Lean);
 
 	// Aim Offsets
-	AOYaw = Character->GetAOYaw();
-	AOPitch = Character->GetAOPitch();
+	AOYaw = Proxy->AOYaw;
+	AOPitch = Proxy->AOPitch;
 
 	//UE_LOG(LogTemp, Warning, TEXT("AO Yaw: %f"), AOYaw);
 
 	// FABRIK
-	if (Character && Character->GetMesh() && Weapon)
+	if (Proxy->bHasLeftHandOffset)
 	{
-		FTransform WeaponWorldTransform = Weapon->GetMesh()->GetSocketTransform(FName("LeftHandSocket"), ERelativeTransformSpace::RTS_World);
-
-		FVector BonePosition;
-		FRotator BoneRotation;
-		Character->GetMesh()->TransformToBoneSpace(FName("RightHand"), WeaponWorldTransform.GetLocation(), FRotator::ZeroRotator, BonePosition, BoneRotation);
+		LeftHandTrans.SetLocation(Proxy->LeftHandOffset.GetLocation());
+		LeftHandTrans.SetRotation(Proxy->LeftHandOffset.GetRotation());
+	}
+	else if (Proxy->bHasWeapon)
+	{
+		// Same as USkinnedMeshComponent::TransformToBoneSpace, on the right hand transform captured by the proxy.
+		const FTransform WorldToBone = Proxy->RightHandTransform.Inverse();
+		const FVector BonePosition = WorldToBone.TransformPosition(Proxy->LeftHandSocketTransform.GetLocation());
+		const FQuat BoneRotation = WorldToBone.GetRotation();
 
 		LeftHandTrans.SetLocation(BonePosition);
-		LeftHandTrans.SetRotation(FQuat(BoneRotation));
+		LeftHandTrans.SetRotation(BoneRotation);
 	}
 
 	// Update turn in place state
-	TurnInPlace = Character->GetTurnInPlace();
+	TurnInPlace = Proxy->TurnInPlace;
 }
@@ -4,9 +4,47 @@
 
 #include "CoreMinimal.h"
 #include "Animation/AnimInstance.h"
+#include "Animation/AnimInstanceProxy.h"
 #include "DayOne/Types/TurnInPlaceState.h"
 #include "SwatAnimInstance.generated.h"
 
+// Everything USwatAnimInstance reads from the character, copied on the game thread,
+// so the update itself runs on a worker thread.
+USTRUCT()
+struct FSwatAnimInstanceProxy : public FAnimInstanceProxy
+{
+	GENERATED_BODY()
+
+	FSwatAnimInstanceProxy();
+	FSwatAnimInstanceProxy(UAnimInstance* Instance);
+
+	virtual void InitializeObjects(UAnimInstance* InAnimInstance) override;
+	virtual void PreUpdate(UAnimInstance* InAnimInstance, float DeltaSeconds) override;
+
+	UPROPERTY(Transient)
+	class ASwatCharacter* Character;
+
+	FVector Velocity;
+	FVector CurrentAcceleration;
+	FRotator BaseAimRotation;
+	FRotator ActorRotation;
+	float AOYaw;
+	float AOPitch;
+	bool bIsFalling;
+	bool bIsWeaponEquipped;
+	bool bIsCrouched;
+	bool bIsAiming;
+	ETurnInPlaceState TurnInPlace;
+
+	// FABRIK. The left hand offset of the weapon, in RightHand bone space, see UCombatComponent::GetLeftHandOffset.
+	bool bHasLeftHandOffset;
+	FTransform LeftHandOffset;
+	// Weapons that animate their left hand socket: world space, read every frame. Only valid with bHasWeapon.
+	bool bHasWeapon;
+	FTransform LeftHandSocketTransform;
+	FTransform RightHandTransform;
+};
+
 /**
  * 
  */
@@ -16,7 +54,21 @@ class DAYONE_API USwatAnimInstance : public UAnimInstance
 	GENERATED_BODY()
 public:
 	virtual void NativeInitializeAnimation() override;
-	virtual void NativeUpdateAnimation(float DeltaSeconds) override;
+	virtual void NativeThreadSafeUpdateAnimation(float DeltaSeconds) override;
+
+protected:
+	FSwatAnimInstanceProxy* Proxy;
+
+	virtual FAnimInstanceProxy* CreateAnimInstanceProxy() override
+	{
+		Proxy = new FSwatAnimInstanceProxy(this);
+		return Proxy;
+	}
+	virtual void DestroyAnimInstanceProxy(FAnimInstanceProxy* InProxy) override
+	{
+		check(InProxy == Proxy);
+		delete InProxy;
+	}
 
 private:
 	UPROPERTY(BlueprintReadOnly, Category = "Character", meta = (AllowPrivateAccess = "true"))
@@ -50,7 +102,6 @@ private:
 	// FABRIK Transform
 	UPROPERTY(BlueprintReadOnly, Category = "Character", meta = (AllowPrivateAccess = "true"))
 	FTransform LeftHandTrans;
-	class AWeapon* Weapon;
 
 	// Turn In Place
 	UPROPERTY(BlueprintReadOnly, Category = "Character", meta = (AllowPrivateAccess = "true"))
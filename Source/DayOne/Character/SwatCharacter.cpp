@@ -7,13 +7,17 @@
 #include "Components/CapsuleComponent.h"
 #include "Components/WidgetComponent.h"
 #include "DayOne/Component/CombatComponent.h"
+#include "DayOne/Component/HitboxPoseComponent.h"
+#include "DayOne/Component/OverlayLayerComponent.h"
+#include "DayOne/Component/SwatMovementComponent.h"
 #include "DayOne/Weapon/Weapon.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/SpringArmComponent.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "Net/UnrealNetwork.h"
 
-ASwatCharacter::ASwatCharacter()
+ASwatCharacter::ASwatCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<USwatMovementComponent>(CharacterMovementComponentName))
 {
 	PrimaryActorTick.bCanEverTick = true;
 	// Enable replication
@@ -43,6 +47,12 @@ ASwatCharacter::ASwatCharacter()
 	Combat = CreateDefaultSubobject<UCombatComponent>(TEXT("Combat"));
 	Combat->SetIsReplicated(true);
 
+	// Create hitbox pose component for server-side hit validation
+	HitboxPose = CreateDefaultSubobject<UHitboxPoseComponent>(TEXT("HitboxPose"));
+
+	// Create overlay layer component, streams in the anim layer of the equipped weapon
+	OverlayLayer = CreateDefaultSubobject<UOverlayLayerComponent>(TEXT("OverlayLayer"));
+
 	// Set capsule and mesh ignore collider with camera
 	GetCapsuleComponent()->SetCollisionResponseToChannel(ECollisionChannel::ECC_Camera, ECollisionResponse::ECR_Ignore);
 	GetMesh()->SetCollisionResponseToChannel(ECollisionChannel::ECC_Camera, ECollisionResponse::ECR_Ignore);
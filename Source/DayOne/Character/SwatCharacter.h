@@ -16,7 +16,7 @@ class DAYONE_API ASwatCharacter : public ACharacter
 	friend class AWeapon;
 
 public:
-	ASwatCharacter();
+	ASwatCharacter(const FObjectInitializer& ObjectInitializer);
 
 	virtual void PostInitializeComponents() override;
 	virtual void BeginPlay() override;
@@ -43,6 +43,11 @@ public:
 
 	FORCEINLINE ETurnInPlaceState GetTurnInPlace() const { return TurnInPlace; }
 
+	FORCEINLINE const FTransform* GetLeftHandOffset() const { return Combat ? Combat->GetLeftHandOffset() : nullptr; }
+
+	FORCEINLINE class UHitboxPoseComponent* GetHitboxPoseComponent() const { return HitboxPose; }
+	FORCEINLINE class UOverlayLayerComponent* GetOverlayLayerComponent() const { return OverlayLayer; }
+
 	void PlayFireMontage(bool bAiming);
 
 protected:
@@ -55,6 +60,12 @@ protected:
 	class UWidgetComponent* Hud;
 	UPROPERTY(VisibleAnywhere, Category = "Combat")
 	class UCombatComponent* Combat;
+	// Hitbox bones the server validates the hits on this character against.
+	UPROPERTY(VisibleAnywhere, Category = "Combat")
+	class UHitboxPoseComponent* HitboxPose;
+	// Links the overlay anim layer of the equipped weapon, set by the combat component on every equip.
+	UPROPERTY(VisibleAnywhere, Category = "Combat")
+	class UOverlayLayerComponent* OverlayLayer;
 	UPROPERTY(EditAnywhere, Category = "Combat")
 	class UAnimMontage* WeaponFireMontage;
 
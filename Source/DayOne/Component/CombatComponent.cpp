@@ -4,12 +4,17 @@
 #include "CombatComponent.h"
 
 #include "DayOne/Character/SwatCharacter.h"
+#include "DayOne/Component/OverlayLayerComponent.h"
+#include "DayOne/Component/SwatMovementComponent.h"
 #include "DayOne/Weapon/Weapon.h"
 #include "Engine/SkeletalMeshSocket.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Kismet/GameplayStatics.h"
 #include "Net/UnrealNetwork.h"
 
+static const FName NAME_WeaponSocket(TEXT("WeaponSocket"));
+static const FName NAME_RightHand(TEXT("RightHand"));
+
 UCombatComponent::UCombatComponent()
 {
 	PrimaryComponentTick.bCanEverTick = true;
@@ -22,13 +27,15 @@ void UCombatComponent::EquipWeapon(ASwatCharacter* Character, AWeapon* Weapon)
 	ASwatCharacter* OwnerCharacter = Cast<ASwatCharacter>(GetOwner());
 	if (OwnerCharacter)
 	{
-		const USkeletalMeshSocket* WeaponSocket = OwnerCharacter->GetMesh()->GetSocketByName(FName(TEXT("WeaponSocket")));
+		const USkeletalMeshSocket* WeaponSocket = OwnerCharacter->GetMesh()->GetSocketByName(NAME_WeaponSocket);
 		WeaponSocket->AttachActor(Weapon, OwnerCharacter->GetMesh());
 		Weapon->SetOwner(OwnerCharacter);
 
 		UE_LOG(LogTemp, Warning, TEXT("set weapon state"));
 		CurrentWeapon = Weapon;
 		CurrentWeapon->SetState(EWeaponState::EWS_Equipped);
+		UpdateLeftHandOffset();
+		UpdateOverlayState();
 
 		UE_LOG(LogTemp, Warning, TEXT("AttachedCharacter"));
 		OwnerCharacter->GetCharacterMovement()->bOrientRotationToMovement = false;
@@ -39,22 +46,20 @@ void UCombatComponent::EquipWeapon(ASwatCharacter* Character, AWeapon* Weapon)
 void UCombatComponent::AimTarget(bool bAim)
 {
 	bIsAiming = bAim;
+	// The aiming walk speed is predicted: the movement component carries the aim input in its moves.
 	ASwatCharacter* OwnerCharacter = Cast<ASwatCharacter>(GetOwner());
-	if (OwnerCharacter)
+	USwatMovementComponent* Movement = OwnerCharacter ? Cast<USwatMovementComponent>(OwnerCharacter->GetCharacterMovement()) : nullptr;
+	if (Movement)
 	{
-		OwnerCharacter->GetCharacterMovement()->MaxWalkSpeed = bIsAiming ? AimWalkSpeed : BaseWalkSpeed;
+		Movement->SetWantsToAim(bAim);
 	}
 	ServerAimTarget(bAim);
 }
 
 void UCombatComponent::ServerAimTarget_Implementation(bool bAim)
 {
+	// Only the replicated aim state, the server takes the aim input over from the moves.
 	bIsAiming = bAim;
-	ASwatCharacter* OwnerCharacter = Cast<ASwatCharacter>(GetOwner());
-	if (OwnerCharacter)
-	{
-		OwnerCharacter->GetCharacterMovement()->MaxWalkSpeed = bIsAiming ? AimWalkSpeed : BaseWalkSpeed;
-	}
 }
 
 void UCombatComponent::Fire(bool bPressed)
@@ -130,12 +135,41 @@ void UCombatComponent::OnRep_CurrentWeapon()
 	if (Character)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("OnRep_CurrentWeapon"));
+		UpdateLeftHandOffset();
+		UpdateOverlayState();
 		// Change character moving state.
 		//Character->GetCharacterMovement()->bOrientRotationToMovement = false;
 		//Character->bUseControllerRotationYaw = true;
 	}
 }
 
+void UCombatComponent::UpdateOverlayState()
+{
+	ASwatCharacter* OwnerCharacter = Cast<ASwatCharacter>(GetOwner());
+	UOverlayLayerComponent* OverlayLayer = OwnerCharacter ? OwnerCharacter->GetOverlayLayerComponent() : nullptr;
+	if (OverlayLayer)
+	{
+		OverlayLayer->SetOverlayState(CurrentWeapon ? CurrentWeapon->GetOverlayState() : EOverlayState::OS_Default);
+	}
+}
+
+void UCombatComponent::UpdateLeftHandOffset()
+{
+	bHasLeftHandOffset = false;
+
+	ASwatCharacter* OwnerCharacter = Cast<ASwatCharacter>(GetOwner());
+	if (!OwnerCharacter || !CurrentWeapon || CurrentWeapon->HasAnimatedLeftHandSocket()) return;
+
+	// The weapon is snapped to WeaponSocket, which moves rigidly with the RightHand bone, so the left hand socket
+	// never moves relative to that bone. Composed from the character's sockets and the weapon mesh's own socket,
+	// not from the weapon's world transform: on clients, the weapon attachment may replicate after CurrentWeapon.
+	const USkeletalMeshComponent* CharacterMesh = OwnerCharacter->GetMesh();
+	const FTransform WeaponSocketToRightHand = CharacterMesh->GetSocketTransform(NAME_WeaponSocket, RTS_Component)
+		.GetRelativeTransform(CharacterMesh->GetSocketTransform(NAME_RightHand, RTS_Component));
+	LeftHandOffset = CurrentWeapon->GetMesh()->GetSocketTransform(AWeapon::LeftHandSocketName, RTS_Component) * WeaponSocketToRightHand;
+	bHasLeftHandOffset = true;
+}
+
 void UCombatComponent::BeginPlay()
 {
 	Super::BeginPlay();
@@ -35,6 +35,10 @@ public:
 	UFUNCTION(BlueprintCallable)
 	FORCEINLINE bool IsAiming() const { return bIsAiming; }
 
+	// Left hand IK target in the space of the character's RightHand bone, constant while the weapon is attached.
+	// Null without a weapon, or when the weapon animates its left hand socket.
+	FORCEINLINE const FTransform* GetLeftHandOffset() const { return bHasLeftHandOffset ? &LeftHandOffset : nullptr; }
+
 	void Fire(bool bPressed);
 	UFUNCTION(Server, Reliable)
 	void ServerFire(const FVector_NetQuantize& HitTarget);
@@ -48,16 +52,19 @@ private:
 	AWeapon* CurrentWeapon = nullptr;
 	UFUNCTION()
 	void OnRep_CurrentWeapon();
+
+	// Compute LeftHandOffset for the current weapon, on every attach.
+	void UpdateLeftHandOffset();
+	FTransform LeftHandOffset;
+	bool bHasLeftHandOffset = false;
+
+	// Link the overlay layer of the current weapon through the owner's UOverlayLayerComponent.
+	void UpdateOverlayState();
 	
 	ASwatCharacter* AttachedCharacter = nullptr;
 
 	UPROPERTY(Replicated, Transient)
 	bool bIsAiming;
 
-	UPROPERTY(EditDefaultsOnly, meta=(AllowPrivateAccess="true"))
-	float BaseWalkSpeed = 600;
-	UPROPERTY(EditDefaultsOnly, meta=(AllowPrivateAccess="true"))
-	float AimWalkSpeed = 300;
-
 	bool bFiring;
 };
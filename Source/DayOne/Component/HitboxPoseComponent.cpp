@@ -0,0 +1,188 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HitboxPoseComponent.h"
+
+#include "Components/SkeletalMeshComponent.h"
+#include "DayOne/DayOne.h"
+#include "GameFramework/Character.h"
+#include "Rendering/SkeletalMeshRenderData.h"
+
+static TAutoConsoleVariable<int32> CVarHitboxServerPose(
+	TEXT("DayOne.Hitbox.ServerPose"),
+	1,
+	TEXT("On a dedicated server, evaluate character meshes for their hitbox bones only, at the mesh tick rate of\n")
+	TEXT("DayOne.Anim.ServerTickRate, and interpolate the hitbox transforms in between. Read at BeginPlay."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarHitboxServerLOD(
+	TEXT("DayOne.Hitbox.ServerLOD"),
+	-1,
+	TEXT("Mesh LOD evaluated for the server hitbox pose, set up to keep only the hitbox bones and their parents.\n")
+	TEXT("Ignored with a warning if the LOD removes a hitbox bone. -1 keeps the mesh LOD. Read at BeginPlay."),
+	ECVF_Default);
+
+DECLARE_CYCLE_STAT(TEXT("Hitbox Pose Copy"), STAT_HitboxPoseCopy, STATGROUP_DayOne);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Hitbox Pose Evaluations"), STAT_HitboxPoseEvaluations, STATGROUP_DayOne);
+
+UHitboxPoseComponent::UHitboxPoseComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+
+	HitboxBones = {
+		TEXT("head"),
+		TEXT("neck_01"),
+		TEXT("spine_03"),
+		TEXT("spine_02"),
+		TEXT("pelvis"),
+		TEXT("upperarm_l"),
+		TEXT("lowerarm_l"),
+		TEXT("hand_l"),
+		TEXT("upperarm_r"),
+		TEXT("lowerarm_r"),
+		TEXT("hand_r"),
+		TEXT("thigh_l"),
+		TEXT("calf_l"),
+		TEXT("thigh_r"),
+		TEXT("calf_r"),
+	};
+	Mesh = nullptr;
+	bServerHitboxPose = false;
+}
+
+void UHitboxPoseComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	const ACharacter* Character = Cast<ACharacter>(GetOwner());
+	Mesh = Character ? Character->GetMesh() : nullptr;
+	if (!Mesh)
+	{
+		return;
+	}
+
+	BoneIndices.Reset(HitboxBones.Num());
+	for (const FName& BoneName : HitboxBones)
+	{
+		const int32 BoneIndex = Mesh->GetBoneIndex(BoneName);
+		if (BoneIndex == INDEX_NONE)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("UHitboxPoseComponent: %s has no hitbox bone %s"), *GetNameSafe(GetOwner()), *BoneName.ToString());
+		}
+		BoneIndices.Add(BoneIndex);
+	}
+
+	bServerHitboxPose = GetNetMode() == NM_DedicatedServer && CVarHitboxServerPose.GetValueOnGameThread() != 0;
+	if (!bServerHitboxPose)
+	{
+		return;
+	}
+
+	// The mesh tick rate and tick option belong to the server anim profile, the samples follow them.
+	if (Mesh->VisibilityBasedAnimTickOption != EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UHitboxPoseComponent: the mesh of %s does not refresh its bones, the hitbox pose holds its last evaluation"),
+			*GetNameSafe(GetOwner()));
+	}
+	UE_LOG(LogTemp, Verbose, TEXT("UHitboxPoseComponent: %s samples its hitbox pose every %.3f s"), *GetNameSafe(GetOwner()), Mesh->GetComponentTickInterval());
+	ApplyServerLOD();
+
+	PreviousSample = FHitboxPoseSample();
+	CurrentSample = FHitboxPoseSample();
+	Mesh->OnBoneTransformsFinalized.AddDynamic(this, &ThisClass::OnBoneTransformsFinalized);
+}
+
+void UHitboxPoseComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (bServerHitboxPose && Mesh)
+	{
+		Mesh->OnBoneTransformsFinalized.RemoveDynamic(this, &ThisClass::OnBoneTransformsFinalized);
+	}
+	bServerHitboxPose = false;
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UHitboxPoseComponent::ApplyServerLOD()
+{
+	const int32 LODIndex = CVarHitboxServerLOD.GetValueOnGameThread();
+	const FSkeletalMeshRenderData* RenderData = Mesh->GetSkeletalMeshRenderData();
+	if (LODIndex < 0 || !RenderData)
+	{
+		return;
+	}
+	if (!RenderData->LODRenderData.IsValidIndex(LODIndex))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UHitboxPoseComponent: %s has no LOD %d, keeping the mesh LOD"), *GetNameSafe(GetOwner()), LODIndex);
+		return;
+	}
+
+	const TArray<FBoneIndexType>& RequiredBones = RenderData->LODRenderData[LODIndex].RequiredBones;
+	for (int32 HitboxIndex = 0; HitboxIndex < BoneIndices.Num(); ++HitboxIndex)
+	{
+		if (BoneIndices[HitboxIndex] != INDEX_NONE && !RequiredBones.Contains(static_cast<FBoneIndexType>(BoneIndices[HitboxIndex])))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("UHitboxPoseComponent: LOD %d of %s removes hitbox bone %s, keeping the mesh LOD"),
+				LODIndex, *GetNameSafe(GetOwner()), *HitboxBones[HitboxIndex].ToString());
+			return;
+		}
+	}
+
+	// Forced LOD is one based, 0 means not forced.
+	Mesh->SetForcedLOD(LODIndex + 1);
+}
+
+void UHitboxPoseComponent::OnBoneTransformsFinalized()
+{
+	SCOPE_CYCLE_COUNTER(STAT_HitboxPoseCopy);
+	INC_DWORD_STAT(STAT_HitboxPoseEvaluations);
+
+	// The previous evaluation becomes the start of the interpolation, reuse its arrays for the new one.
+	Swap(PreviousSample, CurrentSample);
+
+	const TArray<FTransform>& ComponentSpaceTransforms = Mesh->GetComponentSpaceTransforms();
+	const FTransform& ComponentTransform = Mesh->GetComponentTransform();
+	CurrentSample.Time = GetWorld()->GetTimeSeconds();
+	CurrentSample.Locations.SetNumUninitialized(BoneIndices.Num());
+	CurrentSample.Rotations.SetNumUninitialized(BoneIndices.Num());
+	for (int32 HitboxIndex = 0; HitboxIndex < BoneIndices.Num(); ++HitboxIndex)
+	{
+		const int32 BoneIndex = BoneIndices[HitboxIndex];
+		const FTransform BoneTransform = ComponentSpaceTransforms.IsValidIndex(BoneIndex)
+			? ComponentSpaceTransforms[BoneIndex] * ComponentTransform
+			: ComponentTransform;
+		CurrentSample.Locations[HitboxIndex] = BoneTransform.GetLocation();
+		CurrentSample.Rotations[HitboxIndex] = FQuat4f(BoneTransform.GetRotation());
+	}
+
+	// Nothing to interpolate from yet.
+	if (PreviousSample.Time < 0.0)
+	{
+		PreviousSample = CurrentSample;
+	}
+}
+
+FTransform UHitboxPoseComponent::GetHitboxTransform(int32 HitboxIndex, double Time) const
+{
+	check(BoneIndices.IsValidIndex(HitboxIndex));
+
+	if (!bServerHitboxPose || CurrentSample.Time < 0.0)
+	{
+		return Mesh ? Mesh->GetBoneTransform(FMath::Max(BoneIndices[HitboxIndex], 0)) : FTransform::Identity;
+	}
+
+	const double Interval = CurrentSample.Time - PreviousSample.Time;
+	const float Alpha = Interval > 0.0 ? static_cast<float>(FMath::Clamp((Time - PreviousSample.Time) / Interval, 0.0, 1.0)) : 1.0f;
+	const FVector Location = FMath::Lerp(PreviousSample.Locations[HitboxIndex], CurrentSample.Locations[HitboxIndex], Alpha);
+	const FQuat4f Rotation = FQuat4f::Slerp(PreviousSample.Rotations[HitboxIndex], CurrentSample.Rotations[HitboxIndex], Alpha);
+	return FTransform(FQuat(Rotation), Location);
+}
+
+void UHitboxPoseComponent::GetHitboxPose(double Time, TArray<FTransform>& OutTransforms) const
+{
+	OutTransforms.SetNumUninitialized(BoneIndices.Num());
+	for (int32 HitboxIndex = 0; HitboxIndex < BoneIndices.Num(); ++HitboxIndex)
+	{
+		OutTransforms[HitboxIndex] = GetHitboxTransform(HitboxIndex, Time);
+	}
+}
@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "HitboxPoseComponent.generated.h"
+
+class USkeletalMeshComponent;
+
+// Hitbox bone transforms of one evaluated pose, in world space, in UHitboxPoseComponent::HitboxBones order.
+struct FHitboxPoseSample
+{
+	// World time of the evaluation.
+	double Time = -1.0;
+	TArray<FVector> Locations;
+	TArray<FQuat4f> Rotations;
+};
+
+/**
+ * Compact per-character hitbox pose for server-side hit validation.
+ * On a dedicated server the mesh only has to produce the hitbox bones (head, pelvis, spine, limbs):
+ * it evaluates at the mesh tick rate of the server anim profile (DayOne.Anim.ServerProfile, DayOne.Anim.ServerTickRate),
+ * which skips foot IK and layering, and with DayOne.Hitbox.ServerLOD at a LOD that keeps only those bones.
+ * Every evaluation is copied here, and hit tests read the bones at any time in between, interpolated.
+ * Elsewhere the bones are read from the mesh as is.
+ */
+UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
+class DAYONE_API UHitboxPoseComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UHitboxPoseComponent();
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	FORCEINLINE const TArray<FName>& GetHitboxBones() const
+	{
+		return HitboxBones;
+	}
+	// Index of the hitbox of this bone, INDEX_NONE if it is not a hitbox bone.
+	FORCEINLINE int32 GetHitboxIndex(FName BoneName) const
+	{
+		return HitboxBones.IndexOfByKey(BoneName);
+	}
+	// Is the mesh evaluating the reduced hitbox pose?
+	FORCEINLINE bool IsServerHitboxPose() const
+	{
+		return bServerHitboxPose;
+	}
+
+	// World transform of the hitbox at HitboxIndex at world time Time,
+	// interpolated between the two evaluations around it, clamped to the last two.
+	FTransform GetHitboxTransform(int32 HitboxIndex, double Time) const;
+	// World transforms of all hitboxes at world time Time, in GetHitboxBones() order.
+	void GetHitboxPose(double Time, TArray<FTransform>& OutTransforms) const;
+
+private:
+	// Copy the hitbox bones of the pose the mesh has just evaluated.
+	UFUNCTION()
+	void OnBoneTransformsFinalized();
+
+	// Select the mesh LOD of DayOne.Hitbox.ServerLOD, if it keeps every hitbox bone.
+	void ApplyServerLOD();
+
+	// Bones hit tests run against, of the Mannequin and AnimMan skeletons.
+	UPROPERTY(EditAnywhere, Category="Hitbox", meta=(AllowPrivateAccess="true"))
+	TArray<FName> HitboxBones;
+
+	UPROPERTY()
+	USkeletalMeshComponent* Mesh;
+
+	// Mesh bone index of every hitbox.
+	TArray<int32> BoneIndices;
+
+	FHitboxPoseSample PreviousSample;
+	FHitboxPoseSample CurrentSample;
+
+	bool bServerHitboxPose;
+};
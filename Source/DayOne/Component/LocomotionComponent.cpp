@@ -3,10 +3,96 @@
 
 #include "LocomotionComponent.h"
 
-#include "Curves/CurveVector.h"
+#include "Components/CapsuleComponent.h"
+#include "DayOne/DayOne.h"
 #include "DayOne/Character/BaseCharacter.h"
+#include "DayOne/Data/LocomotionStateWord.h"
+#include "DayOne/Math/LocomotionMath.h"
+#include "DayOne/Subsystem/LocomotionSubsystem.h"
+#include "DayOne/Subsystem/ModelTableSubsystem.h"
 #include "Kismet/GameplayStatics.h"
 #include "Kismet/KismetMathLibrary.h"
+#include "Net/UnrealNetwork.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Locomotion Server Moves Checked"), STAT_LocomotionServerMovesChecked, STATGROUP_DayOne);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Locomotion Server Corrections"), STAT_LocomotionServerCorrections, STATGROUP_DayOne);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Locomotion Rotation Writes Avoided"), STAT_LocomotionRotationWritesAvoided, STATGROUP_DayOne);
+
+static TAutoConsoleVariable<int32> CVarLocomotionFlightRecorder(
+	TEXT("DayOne.Locomotion.FlightRecorder"),
+	1,
+	TEXT("Record the last ticks of locomotion of every character, see DayOne.Locomotion.FlightRecorder.Dump. Read when a character begins play."),
+	ECVF_Default);
+
+// Rotations closer than this (in degrees per axis) to the current one are not written.
+static constexpr float RotationWriteTolerance = 1.e-3f;
+
+void FSavedMove_DayOne::Clear()
+{
+	Super::Clear();
+
+	LocomotionInput = 0;
+}
+
+void FSavedMove_DayOne::SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData)
+{
+	Super::SetMoveFor(C, InDeltaTime, NewAccel, ClientData);
+
+	const ULocomotionComponent* Locomotion = CastChecked<ULocomotionComponent>(C->GetCharacterMovement());
+	LocomotionInput = Locomotion->PackLocomotionInput();
+}
+
+bool FSavedMove_DayOne::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const
+{
+	if (LocomotionInput != static_cast<const FSavedMove_DayOne*>(NewMove.Get())->LocomotionInput)
+	{
+		return false;
+	}
+
+	return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+}
+
+void FSavedMove_DayOne::PrepMoveFor(ACharacter* C)
+{
+	Super::PrepMoveFor(C);
+
+	// Restore the input this move was made with before it gets replayed.
+	ULocomotionComponent* Locomotion = CastChecked<ULocomotionComponent>(C->GetCharacterMovement());
+	Locomotion->ApplyLocomotionInput(LocomotionInput);
+}
+
+FNetworkPredictionData_Client_DayOne::FNetworkPredictionData_Client_DayOne(const UCharacterMovementComponent& ClientMovement)
+	: Super(ClientMovement)
+{
+}
+
+FSavedMovePtr FNetworkPredictionData_Client_DayOne::AllocateNewMove()
+{
+	return FSavedMovePtr(new FSavedMove_DayOne());
+}
+
+void FCharacterNetworkMoveData_DayOne::ClientFillNetworkMoveData(const FSavedMove_Character& ClientMove, ENetworkMoveType MoveType)
+{
+	Super::ClientFillNetworkMoveData(ClientMove, MoveType);
+
+	LocomotionInput = static_cast<const FSavedMove_DayOne&>(ClientMove).LocomotionInput;
+}
+
+bool FCharacterNetworkMoveData_DayOne::Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType)
+{
+	Super::Serialize(CharacterMovement, Ar, PackageMap, MoveType);
+
+	Ar << LocomotionInput;
+
+	return !Ar.IsError();
+}
+
+FCharacterNetworkMoveDataContainer_DayOne::FCharacterNetworkMoveDataContainer_DayOne()
+{
+	NewMoveData = &MoveData[0];
+	PendingMoveData = &MoveData[1];
+	OldMoveData = &MoveData[2];
+}
 
 ULocomotionComponent::ULocomotionComponent(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
@@ -14,13 +100,34 @@ ULocomotionComponent::ULocomotionComponent(const FObjectInitializer& ObjectIniti
 	PrimaryComponentTick.bCanEverTick = true;
 	
 	DesiredGait = EGaitState::GS_Running;
+	DesiredRotationMode = ERotationMode::RM_Looking;
+	bWantsToAim = false;
+	bFullMovementInput = false;
+	MovementModelType = EMovementModel::MM_Normal;
+	CurrentMovementSettings = nullptr;
 
 	MovementAction = EMovementAction::MA_None;
 	MovementState = EMovementState::MS_Grounded;
 	Stance = EStanceState::SS_Standing;
+	PrevStance = EStanceState::SS_Standing;
 	DesiredStance = EStanceState::SS_Standing;
 	RotationMode = ERotationMode::RM_Looking;
 	Gait = EGaitState::GS_Walking;
+	PrevGait = EGaitState::GS_Walking;
+
+	LocomotionState = 0;
+	PublishedSnapshotIndex = 0;
+	bHasPendingRotation = false;
+	QueuedRotationWrites = 0;
+	bReducedLocomotionRate = false;
+	bBeyondLODDistance = false;
+	bLocomotionUpdateDue = true;
+	LocomotionLODTime = 0.0f;
+	LocomotionDeltaTime = 0.0f;
+	LastActorInterpSpeed = 0.0f;
+	PendingFlightFlags = ELocomotionFlightFlags::None;
+
+	SetNetworkMoveDataContainer(NetworkMoveDataContainer);
 }
 
 void ULocomotionComponent::BeginPlay()
@@ -38,27 +145,80 @@ void ULocomotionComponent::BeginPlay()
 
 	// Set the Movement Model
 	SetMovementModel();
+	CurrentMovementSettings = &GetTargetMovementSettings();
 
 	// Update states to use the initial desired values.
 	SetGait(DesiredGait);
 
 	// Set default rotation values.
 	TargetRotation = LastVelocityRotation = LastMovementInputRotation = Character->GetActorRotation();
+
+	if (CVarLocomotionFlightRecorder.GetValueOnGameThread() != 0)
+	{
+		FlightRecorder.Initialize();
+	}
+
+	// Give the readers valid values before the first tick.
+	PublishSnapshot();
+
+	// Hand the locomotion update over to the world's batched update.
+	LocomotionSubsystem = GetWorld()->GetSubsystem<ULocomotionSubsystem>();
+	if (LocomotionSubsystem)
+	{
+		LocomotionSubsystem->RegisterComponent(this);
+	}
+}
+
+void ULocomotionComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (LocomotionSubsystem)
+	{
+		LocomotionSubsystem->UnregisterComponent(this);
+		LocomotionSubsystem = nullptr;
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
 void ULocomotionComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
+	// Decide before moving, the movement settings follow the same rate.
+	UpdateLocomotionLOD(DeltaTime);
+
+	// A correction received from the server is applied by the movement tick.
+	if (ClientPredictionData && ClientPredictionData->bUpdatePosition)
+	{
+		PendingFlightFlags |= ELocomotionFlightFlags::ClientCorrection;
+	}
+
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
+	// The subsystem runs the locomotion logic for all characters at once after every component has moved.
+	if (LocomotionSubsystem && ULocomotionSubsystem::IsBatchedUpdateEnabled())
+	{
+		return;
+	}
+
+	if (!bLocomotionUpdateDue)
+	{
+		InterpolateSkippedRotation(DeltaTime);
+		PublishSnapshot();
+		return;
+	}
+
 	{
+		LastActorInterpSpeed = 0.0f;
 		SetEssentialValues();
 		// Check Movement Mode
 		switch (MovementState)
 		{
 		case EMovementState::MS_Grounded:
 			// Do While On Ground
-			UpdateCharacterMovement();
+			if (!IsSimulatedProxy())
+			{
+				UpdateCharacterMovement();
+			}
 			UpdateGroudedRotation();
 			break;
 		case EMovementState::MS_InAir:
@@ -68,9 +228,13 @@ void ULocomotionComponent::TickComponent(float DeltaTime, ELevelTick TickType, F
 		default:
 			checkNoEntry();
 		}
+
+		ApplyPendingRotation();
 	}
 
 	CacheValues();
+	UpdateReplicatedState();
+	PublishSnapshot();
 }
 
 void ULocomotionComponent::OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode)
@@ -90,7 +254,112 @@ void ULocomotionComponent::OnMovementModeChanged(EMovementMode PreviousMovementM
 		checkNoEntry();
 	}
 
-	UE_LOG(LogTemp, Warning, TEXT("OnMovementModeChanged: %d"), static_cast<int32>(MovementState));
+	UE_LOG(LogTemp, Verbose, TEXT("OnMovementModeChanged: %d"), static_cast<int32>(MovementState));
+}
+
+void ULocomotionComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME_CONDITION(ThisClass, LocomotionState, COND_SimulatedOnly);
+}
+
+FNetworkPredictionData_Client* ULocomotionComponent::GetPredictionData_Client() const
+{
+	if (ClientPredictionData == nullptr)
+	{
+		ULocomotionComponent* MutableThis = const_cast<ULocomotionComponent*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_DayOne(*this);
+	}
+
+	return ClientPredictionData;
+}
+
+void ULocomotionComponent::SetDesiredGait(EGaitState NewDesiredGait)
+{
+	DesiredGait = NewDesiredGait;
+}
+
+void ULocomotionComponent::SetDesiredRotationMode(ERotationMode NewDesiredRotationMode)
+{
+	check(NewDesiredRotationMode != ERotationMode::RM_Aiming);
+
+	DesiredRotationMode = NewDesiredRotationMode;
+	RotationMode = bWantsToAim ? ERotationMode::RM_Aiming : DesiredRotationMode;
+}
+
+void ULocomotionComponent::SetWantsToAim(bool bNewWantsToAim)
+{
+	bWantsToAim = bNewWantsToAim;
+	RotationMode = bWantsToAim ? ERotationMode::RM_Aiming : DesiredRotationMode;
+}
+
+uint8 ULocomotionComponent::PackLocomotionInput() const
+{
+	FLocomotionInputWord Input;
+	Input.DesiredGait = DesiredGait;
+	Input.DesiredStance = DesiredStance;
+	Input.DesiredRotationMode = DesiredRotationMode;
+	Input.bWantsToAim = bWantsToAim;
+	Input.bFullMovementInput = bFullMovementInput;
+	return Input.Pack();
+}
+
+void ULocomotionComponent::ApplyLocomotionInput(uint8 PackedInput)
+{
+	const FLocomotionInputWord Input = FLocomotionInputWord::Unpack(PackedInput);
+	DesiredGait = Input.DesiredGait;
+	DesiredStance = Input.DesiredStance;
+	DesiredRotationMode = Input.DesiredRotationMode;
+	bWantsToAim = Input.bWantsToAim;
+	bFullMovementInput = Input.bFullMovementInput;
+	RotationMode = bWantsToAim ? ERotationMode::RM_Aiming : DesiredRotationMode;
+}
+
+void ULocomotionComponent::UpdateCharacterStateBeforeMovement(float DeltaSeconds)
+{
+	if (bLocomotionUpdateDue)
+	{
+		UpdateMovementSettings();
+	}
+
+	Super::UpdateCharacterStateBeforeMovement(DeltaSeconds);
+}
+
+void ULocomotionComponent::ControlledCharacterMove(const FVector& InputVector, float DeltaSeconds)
+{
+	// Before the move is saved and performed, both read it.
+	bFullMovementInput = ConstrainInputAcceleration(InputVector).SizeSquared() > FMath::Square(0.9f);
+
+	Super::ControlledCharacterMove(InputVector, DeltaSeconds);
+}
+
+void ULocomotionComponent::MoveAutonomous(float ClientTimeStamp, float DeltaTime, uint8 CompressedFlags, const FVector& NewAccel)
+{
+	// Take over the locomotion input the client made this move with.
+	if (const FCharacterNetworkMoveData_DayOne* MoveData = static_cast<const FCharacterNetworkMoveData_DayOne*>(GetCurrentNetworkMoveData()))
+	{
+		ApplyLocomotionInput(MoveData->LocomotionInput);
+	}
+
+	Super::MoveAutonomous(ClientTimeStamp, DeltaTime, CompressedFlags, NewAccel);
+}
+
+bool ULocomotionComponent::ServerCheckClientError(float ClientTimeStamp, float DeltaTime, const FVector& Accel, const FVector& ClientLoc,
+                                                  const FVector& RelativeClientLocation, UPrimitiveComponent* ClientMovementBase,
+                                                  FName ClientBaseBoneName, uint8 ClientMovementMode)
+{
+	const bool bClientError = Super::ServerCheckClientError(ClientTimeStamp, DeltaTime, Accel, ClientLoc, RelativeClientLocation,
+	                                                        ClientMovementBase, ClientBaseBoneName, ClientMovementMode);
+
+	INC_DWORD_STAT(STAT_LocomotionServerMovesChecked);
+	if (bClientError)
+	{
+		INC_DWORD_STAT(STAT_LocomotionServerCorrections);
+		PendingFlightFlags |= ELocomotionFlightFlags::ServerCorrection;
+	}
+
+	return bClientError;
 }
 
 void ULocomotionComponent::Crouch(bool bClientSimulation)
@@ -109,18 +378,16 @@ void ULocomotionComponent::SetMovementModel()
 {
 	check(MovementModel);
 
-	// Get Normal Movement Model
-	const FText ResourceString = StaticEnum<EMovementModel>()->GetDisplayNameTextByIndex(static_cast<int32>(EMovementModel::MM_Normal));
-	MovementData.Normal = MovementModel->FindRow<FMovementSettingsState>(*ResourceString.ToString(), "MovementModel.Normal");
-
-	check(MovementData.Normal);
+	// Get the shared, flattened Movement Model, the rows are only resolved by the first character using it.
+	MovementTable = GEngine->GetEngineSubsystem<UModelTableSubsystem>()->GetMovementModelTable(MovementModel);
+	MovementModelType = EMovementModel::MM_Normal;
 }
 
 void ULocomotionComponent::SetGait(EGaitState NewActualGait)
 {
 	if (NewActualGait == Gait) return;
 
-	static EGaitState PreviousActualGait = Gait;
+	PrevGait = Gait;
 	Gait = NewActualGait;
 }
 
@@ -153,7 +420,7 @@ void ULocomotionComponent::SetStance(EStanceState NewStance)
 {
 	if (NewStance == Stance) return;
 
-	static EStanceState PreviousStance = Stance;
+	PrevStance = Stance;
 	Stance = NewStance;
 }
 
@@ -190,7 +457,7 @@ void ULocomotionComponent::SetEssentialValues()
 
 	// Set the Aim Yaw rate by comparing the current and previous Aim Yaw value, divided by Delta Seconds.
 	// This represents the speed the camera is rotating left to right. 
-	AimYawRate = UKismetMathLibrary::Abs((Character->GetControlRotation().Yaw - PreviousAimYaw) / UGameplayStatics::GetWorldDeltaSeconds(this));
+	AimYawRate = UKismetMathLibrary::Abs((Character->GetControlRotation().Yaw - PreviousAimYaw) / LocomotionDeltaTime);
 }
 
 FVector ULocomotionComponent::CalculatePhysicalAcceleration() const
@@ -199,7 +466,7 @@ FVector ULocomotionComponent::CalculatePhysicalAcceleration() const
 	// Calculate the Acceleration by comparing the current and previous velocity.
 	// The Current Acceleration returned by the movement component equals the input acceleration,
 	// and does not represent the actual physical acceleration of the character.
-	return (Character->GetVelocity() - PreviousVelocity) / UGameplayStatics::GetWorldDeltaSeconds(Character);
+	return (Character->GetVelocity() - PreviousVelocity) / LocomotionDeltaTime;
 }
 
 void ULocomotionComponent::UpdateCharacterMovement()
@@ -215,183 +482,86 @@ void ULocomotionComponent::UpdateCharacterMovement()
 		SetGait(ActualGait);
 	}
 
-	// Use the allowed gait to update the movement settings.
-	UpdateDynamicMovementSettings(AllowedGait);
+	// The movement settings are updated inside the move, see UpdateMovementSettings.
 }
 
 EGaitState ULocomotionComponent::GetAllowedGait() const
 {
-	EGaitState AllowedGait = EGaitState::GS_MAX;
-	
-	if (Stance == EStanceState::SS_Standing)
-	{
-		if (RotationMode == ERotationMode::RM_Looking || RotationMode == ERotationMode::RM_Velocity)
-		{
-			AllowedGait = DesiredGait;
-			if (DesiredGait == EGaitState::GS_Sprinting)
-			{
-				AllowedGait = CanSprint() ? EGaitState::GS_Sprinting : EGaitState::GS_Running;
-			}
-		}
-		else if (RotationMode == ERotationMode::RM_Aiming)
-		{
-			AllowedGait = EGaitState::GS_Running;
-			if (DesiredGait == EGaitState::GS_Walking)
-			{
-				AllowedGait = EGaitState::GS_Walking;
-			}
-		}
-	}
-	else if (Stance == EStanceState::SS_Crouching)
-	{
-		AllowedGait = EGaitState::GS_Running;
-		if (DesiredGait == EGaitState::GS_Walking)
-		{
-			AllowedGait = EGaitState::GS_Walking;
-		}
-	}
-
-	return AllowedGait;
+	// Only ask for sprinting when the stance and rotation mode allow it at all.
+	const bool bWantsToSprint = DesiredGait == EGaitState::GS_Sprinting && Stance == EStanceState::SS_Standing && RotationMode != ERotationMode::RM_Aiming;
+	return LocomotionMath::AllowedGait(Stance, RotationMode, DesiredGait, bWantsToSprint && CanSprint());
 }
 
 bool ULocomotionComponent::CanSprint() const
 {
 	check(Character);
 	
-	if (!bHasMovementInput) return false;
-
-	if (RotationMode == ERotationMode::RM_Aiming) return false;
-
-	if (RotationMode == ERotationMode::RM_Looking)
-	{
-		// Try to find the angle of  player input direct and current player controller direct
-		// If player has heavy input and input direction between with controller direction almost the same, sprint.
-		FRotator MovementInputRotation = GetCurrentAcceleration().ToOrientationRotator();
-		FRotator DeltaRotation = UKismetMathLibrary::NormalizedDeltaRotator(MovementInputRotation, Character->GetControlRotation());
-		float DeltaYaw = UKismetMathLibrary::Abs(DeltaRotation.Yaw);
-		return (MovementInputAmount > 0.9f && DeltaYaw < 50.0f);
-	}
-	// TODO
-	// if (RotationMode == ERotationMode::RM_Velocity)
-
-	checkNoEntry();
-	return false;
+	return LocomotionMath::CanSprint(RotationMode, bHasMovementInput, MovementInputAmount, GetCurrentAcceleration(), Character->GetControlRotation());
 }
 
 EGaitState ULocomotionComponent::GetActualGait(EGaitState AllowedGait) const
 {
-	float LocalWalkSpeed = CurrentMovementSettings.WalkSpeed;
-	float LocalRunSpeed = CurrentMovementSettings.RunSpeed;
-	float LocalSprintSpeed = CurrentMovementSettings.SprintSpeed;
+	return LocomotionMath::ActualGait(AllowedGait, Speed, CurrentMovementSettings->WalkSpeed, CurrentMovementSettings->RunSpeed);
+}
 
-	EGaitState ActualGait = EGaitState::GS_MAX;
+void ULocomotionComponent::UpdateMovementSettings()
+{
+	if (!MovementTable || !CharacterOwner || !IsMovingOnGround()) return;
 
-	if (Speed >= (LocalRunSpeed + 10.0f))
-	{
-		ActualGait = EGaitState::GS_Running;
-		if (AllowedGait == EGaitState::GS_Sprinting)
-		{
-			ActualGait = EGaitState::GS_Sprinting;
-		}
-	}
-	else
-	{
-		if (Speed >= (LocalWalkSpeed + 10.0f))
-		{
-			ActualGait = EGaitState::GS_Running;
-		}
-		else
-		{
-			ActualGait = EGaitState::GS_Walking;
-		}
-	}
+	// Velocity, Acceleration, the control rotation and the locomotion input are the ones of the move being performed.
+	const float MoveSpeed = FVector(Velocity.X, Velocity.Y, 0.0f).Length();
+	const float MoveInputAmount = bFullMovementInput ? 1.0f : 0.0f;
+
+	const bool bWantsToSprint = DesiredGait == EGaitState::GS_Sprinting && Stance == EStanceState::SS_Standing && RotationMode != ERotationMode::RM_Aiming;
+	const bool bMoveCanSprint = bWantsToSprint && LocomotionMath::CanSprint(RotationMode, !Acceleration.IsNearlyZero(), MoveInputAmount,
+	                                                                        Acceleration, CharacterOwner->GetControlRotation());
+	const EGaitState AllowedGait = LocomotionMath::AllowedGait(Stance, RotationMode, DesiredGait, bMoveCanSprint);
 
-	return ActualGait;
+	UpdateDynamicMovementSettings(AllowedGait, MoveSpeed);
 }
 
-void ULocomotionComponent::UpdateDynamicMovementSettings(EGaitState AllowedGait)
+void ULocomotionComponent::UpdateDynamicMovementSettings(EGaitState AllowedGait, float MoveSpeed)
 {
 	// Get the Current Movement Settings.
-	CurrentMovementSettings = GetTargetMovementSettings();
+	CurrentMovementSettings = &GetTargetMovementSettings();
 
 	// Update the Character Max Walk Speed to the configured speeds based on the currently Allowed Gait.
 	switch (AllowedGait)
 	{
 	case EGaitState::GS_Walking:
-		MaxWalkSpeed = CurrentMovementSettings.WalkSpeed;
+		MaxWalkSpeed = CurrentMovementSettings->WalkSpeed;
 		MaxWalkSpeedCrouched = MaxWalkSpeed;
 		break;
 	case EGaitState::GS_Running:
-		MaxWalkSpeed = CurrentMovementSettings.RunSpeed;
+		MaxWalkSpeed = CurrentMovementSettings->RunSpeed;
 		MaxWalkSpeedCrouched = MaxWalkSpeed;
 		break;
 	case EGaitState::GS_Sprinting:
-		MaxWalkSpeed = CurrentMovementSettings.SprintSpeed;
+		MaxWalkSpeed = CurrentMovementSettings->SprintSpeed;
 		MaxWalkSpeedCrouched = MaxWalkSpeed;
 		break;
 	}
 
 	// Update the Acceleration, Deceleration, and Ground Friction using the Movement Curve.
-	// This allows for fine control over movement behavior at each speed (May not be suitable for replication).
-	FVector MovementCurveValue = CurrentMovementSettings.MovementCurve->GetVectorValue(GetMappedSpeed());
+	// This allows for fine control over movement behavior at each speed.
+	// It runs inside the move on both the client and the server, so the results match and need no correction.
+	const float MappedSpeed = LocomotionMath::MappedSpeed(MoveSpeed, CurrentMovementSettings->WalkSpeed, CurrentMovementSettings->RunSpeed, CurrentMovementSettings->SprintSpeed);
+	FVector MovementCurveValue = CurrentMovementSettings->BakedMovementCurve->Evaluate(MappedSpeed);
 	MaxAcceleration = MovementCurveValue.X;
 	BrakingDecelerationWalking = MovementCurveValue.Y;
 	GroundFriction = MovementCurveValue.Z;
 }
 
-FMovementSettings ULocomotionComponent::GetTargetMovementSettings() const
+const FMovementModelEntry& ULocomotionComponent::GetTargetMovementSettings() const
 {
-	check(MovementData.Normal)
-	
-	if (RotationMode == ERotationMode::RM_Looking)
-	{
-		if (Stance == EStanceState::SS_Standing)
-		{
-			return MovementData.Normal->Looking.Standing;
-		}
-		else if (Stance == EStanceState::SS_Crouching)
-		{
-			return MovementData.Normal->Looking.Crouching;
-		}
-	}
-	else if (RotationMode == ERotationMode::RM_Aiming)
-	{
-		if (Stance == EStanceState::SS_Standing)
-		{
-			return MovementData.Normal->Aiming.Standing;
-		}
-		else if (Stance == EStanceState::SS_Crouching)
-		{
-			return MovementData.Normal->Aiming.Crouching;
-		}
-	}
+	check(MovementTable);
 
-	checkNoEntry();
-	return MovementData.Normal->Looking.Standing;
+	return MovementTable->Get(MovementModelType, RotationMode, Stance);
 }
 
 float ULocomotionComponent::GetMappedSpeed() const
 {
-	float LocWalkSpeed = CurrentMovementSettings.WalkSpeed;
-	float LocRunSpeed = CurrentMovementSettings.RunSpeed;
-	float LocSprintSpeed = CurrentMovementSettings.SprintSpeed;
-
-	float MappedWalkSpeed = UKismetMathLibrary::MapRangeClamped(Speed, 0.0f, LocWalkSpeed, 0.0f, 1.0f);
-	float MappedRunSpeed = UKismetMathLibrary::MapRangeClamped(Speed, LocWalkSpeed, LocRunSpeed, 1.0f, 2.0f);
-	float MappedSprintSpeed = UKismetMathLibrary::MapRangeClamped(Speed, LocRunSpeed, LocSprintSpeed, 2.0f, 3.0f);
-
-	if (Speed > LocRunSpeed)
-	{
-		return MappedSprintSpeed;
-	}
-	else if (Speed > LocWalkSpeed)
-	{
-		return MappedRunSpeed;
-	}
-	else
-	{
-		return MappedWalkSpeed;
-	}
+	return LocomotionMath::MappedSpeed(Speed, CurrentMovementSettings->WalkSpeed, CurrentMovementSettings->RunSpeed, CurrentMovementSettings->SprintSpeed);
 }
 
 void ULocomotionComponent::UpdateInAirRotation()
@@ -407,7 +577,7 @@ void ULocomotionComponent::UpdateInAirRotation()
 		// Aiming Rotation
 		FRotator TargetAirRotation(0.0f, Character->GetControlRotation().Yaw, 0.0f);
 		SmoothCharacterRotation(TargetAirRotation, 0.0f, 15.0f);
-		InAirRotation = Character->GetActorRotation();
+		InAirRotation = GetPendingActorRotation();
 	}
 }
 
@@ -424,7 +594,7 @@ void ULocomotionComponent::UpdateGroudedRotation()
 			{
 				if (Gait == EGaitState::GS_Walking || Gait == EGaitState::GS_Running)
 				{
-					float TargetYaw = Character->GetControlRotation().Yaw + GetAnimCurveValue("YawOffset");
+					float TargetYaw = Character->GetControlRotation().Yaw + GetAnimCurveValue(ELocomotionCurve::YawOffset);
 					float GroundedRotationRate = CalculateGroundedRotationRate();
 					SmoothCharacterRotation(FRotator(0.0f, TargetYaw, 0.0f), 500.0f, GroundedRotationRate);
 				}
@@ -453,12 +623,13 @@ void ULocomotionComponent::UpdateGroudedRotation()
 			// Apply the RotationAmount curve from Turn In Place Animations.
 			// The Rotation Amount curve defines how much rotation should be applied each frame,
 			// and is calculated for animations that are animated at 30fps.
-			float RotationAmount = GetAnimCurveValue("RotationAmount");
+			float RotationAmount = GetAnimCurveValue(ELocomotionCurve::RotationAmount);
 			if (FMath::Abs(RotationAmount) > 0.001f)
 			{
-				float DeltaYaw = RotationAmount * (UGameplayStatics::GetWorldDeltaSeconds(this) / (1.0f / 30.0f));
-				Character->AddActorWorldRotation(FRotator(0.0f, DeltaYaw, 0.0f));
-				TargetRotation = Character->GetActorRotation();
+				float DeltaYaw = RotationAmount * (LocomotionDeltaTime / (1.0f / 30.0f));
+				const FRotator NewRotation = (FRotator(0.0f, DeltaYaw, 0.0f).Quaternion() * GetPendingActorRotation().Quaternion()).Rotator();
+				QueueActorRotation(NewRotation);
+				TargetRotation = NewRotation;
 			}
 		}
 	}
@@ -478,35 +649,32 @@ bool ULocomotionComponent::CanUpdateMovementRotation() const
 void ULocomotionComponent::SmoothCharacterRotation(FRotator Target, float TargetInterpSpeed, float ActorInterpSpeed)
 {
 	check(Character);
-	
-	TargetRotation = UKismetMathLibrary::RInterpTo_Constant(TargetRotation, Target, UGameplayStatics::GetWorldDeltaSeconds(this), TargetInterpSpeed);
 
-	FRotator NewRotation = UKismetMathLibrary::RInterpTo(Character->GetActorRotation(), TargetRotation, UGameplayStatics::GetWorldDeltaSeconds(this), ActorInterpSpeed);
-	Character->SetActorRotation(NewRotation);
+	FRotator NewRotation = LocomotionMath::SmoothedRotation(TargetRotation, Target, GetPendingActorRotation(),
+	                                                        LocomotionDeltaTime, TargetInterpSpeed, ActorInterpSpeed);
+	QueueActorRotation(NewRotation);
+	LastActorInterpSpeed = ActorInterpSpeed;
 }
 
-float ULocomotionComponent::GetAnimCurveValue(FName CurveName) const
+float ULocomotionComponent::GetAnimCurveValue(ELocomotionCurve Curve) const
 {
 	if (!MainAnimInstance) return 0.0f;
 
-	return MainAnimInstance->GetCurveValue(CurveName);
+	return MainAnimInstance->GetCurveValue(FLocomotionCurveBundle::GetName(Curve));
 }
 
 float ULocomotionComponent::CalculateGroundedRotationRate() const
 {
-	check(CurrentMovementSettings.RotationRateCurve);
+	check(CurrentMovementSettings && CurrentMovementSettings->BakedRotationRateCurve);
 
-	float RotationRateValue = CurrentMovementSettings.RotationRateCurve->GetFloatValue(GetMappedSpeed());
-	float MappedAimYawRate = UKismetMathLibrary::MapRangeClamped(AimYawRate, 0.0f, 300.0f, 1.0f, 3.0f);
-
-	return RotationRateValue * MappedAimYawRate;
+	return LocomotionMath::GroundedRotationRate(CurrentMovementSettings->BakedRotationRateCurve->Evaluate(GetMappedSpeed()), AimYawRate);
 }
 
 void ULocomotionComponent::LimitRotation(float AimYawMin, float AimYawMax, float InterpSpeed)
 {
 	check(Character);
 	
-	float DeltaYaw = UKismetMathLibrary::NormalizedDeltaRotator(Character->GetControlRotation(), Character->GetActorRotation()).Yaw;
+	float DeltaYaw = UKismetMathLibrary::NormalizedDeltaRotator(Character->GetControlRotation(), GetPendingActorRotation()).Yaw;
 	if (!UKismetMathLibrary::InRange_FloatFloat(DeltaYaw, AimYawMin, AimYawMax, true, true))
 	{
 		float TargetYaw = 0.0f;
@@ -529,3 +697,233 @@ void ULocomotionComponent::CacheValues()
 	PreviousVelocity = Character->GetVelocity();
 	PreviousAimYaw = Character->GetControlRotation().Yaw;
 }
+
+void ULocomotionComponent::UpdateLocomotionLOD(float DeltaTime)
+{
+	if (!bReducedLocomotionRate)
+	{
+		LocomotionLODTime = 0.0f;
+		LocomotionDeltaTime = DeltaTime;
+		bLocomotionUpdateDue = true;
+		return;
+	}
+
+	// Run the locomotion logic once the reduced rate's interval has passed, over all the time accumulated since the last run.
+	LocomotionLODTime += DeltaTime;
+	bLocomotionUpdateDue = LocomotionLODTime >= ULocomotionSubsystem::GetReducedUpdateInterval();
+	if (bLocomotionUpdateDue)
+	{
+		LocomotionDeltaTime = LocomotionLODTime;
+		LocomotionLODTime = 0.0f;
+	}
+}
+
+void ULocomotionComponent::InterpolateSkippedRotation(float DeltaTime)
+{
+	// Keep turning toward the last target rotation at the last speed, no curves or anim values involved.
+	if (LastActorInterpSpeed > 0.0f)
+	{
+		QueueActorRotation(UKismetMathLibrary::RInterpTo(GetPendingActorRotation(), TargetRotation, DeltaTime, LastActorInterpSpeed));
+		ApplyPendingRotation();
+	}
+}
+
+FRotator ULocomotionComponent::GetPendingActorRotation() const
+{
+	check(Character);
+
+	return bHasPendingRotation ? PendingActorRotation : Character->GetActorRotation();
+}
+
+void ULocomotionComponent::QueueActorRotation(const FRotator& NewRotation)
+{
+	PendingActorRotation = NewRotation;
+	bHasPendingRotation = true;
+	++QueuedRotationWrites;
+}
+
+void ULocomotionComponent::ApplyPendingRotation()
+{
+	if (!bHasPendingRotation) return;
+
+	// Every queued rotation but the last one has been coalesced.
+	int32 AvoidedWrites = QueuedRotationWrites - 1;
+	if (PendingActorRotation.Equals(UpdatedComponent->GetComponentRotation(), RotationWriteTolerance))
+	{
+		++AvoidedWrites;
+	}
+	else
+	{
+		MoveUpdatedComponent(FVector::ZeroVector, PendingActorRotation, false);
+	}
+	INC_DWORD_STAT_BY(STAT_LocomotionRotationWritesAvoided, AvoidedWrites);
+
+	bHasPendingRotation = false;
+	QueuedRotationWrites = 0;
+}
+
+void ULocomotionComponent::PredictTrajectory(const FLocomotionSnapshot& Snapshot, TArrayView<const float> Times,
+                                             TArrayView<FVector> OutLocations, TArrayView<FVector> OutFacings)
+{
+	check(OutLocations.Num() == Times.Num() && OutFacings.Num() == Times.Num());
+
+	const float StepTime = 1.0f / 30.0f;
+	const FVector Input(Snapshot.MovementInput.X, Snapshot.MovementInput.Y, 0.0f);
+	const bool bHasInput = !Input.IsNearlyZero();
+	// Analog input lowers the target speed, as the current acceleration is the input scaled by the max acceleration.
+	const FVector TargetVelocity = Snapshot.MaxAcceleration > 0.0f ? Input / Snapshot.MaxAcceleration * Snapshot.MaxSpeed : FVector::ZeroVector;
+	const FVector AimFacing = FRotator(0.0f, Snapshot.AimingRotation.Yaw, 0.0f).Vector();
+
+	FVector Velocity(Snapshot.Velocity.X, Snapshot.Velocity.Y, 0.0f);
+	FVector Location = FVector::ZeroVector;
+	FVector Facing = FRotator(0.0f, Snapshot.ActorRotation.Yaw, 0.0f).Vector();
+	float Time = 0.0f;
+	for (int32 Point = 0; Point < Times.Num(); ++Point)
+	{
+		while (Time < Times[Point])
+		{
+			const float Step = FMath::Min(StepTime, Times[Point] - Time);
+			if (bHasInput)
+			{
+				Velocity += (TargetVelocity - Velocity).GetClampedToMaxSize(Snapshot.MaxAcceleration * Step);
+			}
+			else
+			{
+				Velocity = Velocity.GetClampedToMaxSize(FMath::Max(Velocity.Size() - Snapshot.MaxBrakingDeceleration * Step, 0.0f));
+			}
+			Location += Velocity * Step;
+			Time += Step;
+		}
+
+		if (Snapshot.RotationMode != ERotationMode::RM_Velocity)
+		{
+			Facing = AimFacing;
+		}
+		else if (Velocity.SizeSquared() > 1.0f)
+		{
+			Facing = Velocity.GetSafeNormal();
+		}
+		OutLocations[Point] = Location;
+		OutFacings[Point] = Facing;
+	}
+}
+
+void ULocomotionComponent::PublishSnapshot()
+{
+	check(Character);
+
+	const uint32 BackIndex = 1 - PublishedSnapshotIndex.load(std::memory_order_relaxed);
+	FLocomotionSnapshot& Snapshot = Snapshots[BackIndex];
+
+	Snapshot.Velocity = Character->GetVelocity();
+	Snapshot.PhysicalAcceleration = PhysicalAcceleration;
+	Snapshot.MovementInput = GetCurrentAcceleration();
+	Snapshot.AimingRotation = Character->GetControlRotation();
+	Snapshot.ActorRotation = Character->GetActorRotation();
+	Snapshot.LastUpdateRotation = GetLastUpdateRotation();
+	Snapshot.Speed = Speed;
+	Snapshot.MovementInputAmount = MovementInputAmount;
+	Snapshot.AimYawRate = AimYawRate;
+	Snapshot.MaxAcceleration = GetMaxAcceleration();
+	Snapshot.MaxBrakingDeceleration = GetMaxBrakingDeceleration();
+	Snapshot.MaxSpeed = GetMaxSpeed();
+	Snapshot.bIsMoving = bIsMoving;
+	Snapshot.bHasMovementInput = bHasMovementInput;
+	Snapshot.bIsMovingOnGround = IsMovingOnGround();
+	Snapshot.bBeyondLODDistance = bBeyondLODDistance;
+
+	const UCapsuleComponent* Capsule = Character->GetCapsuleComponent();
+	Snapshot.CapsuleLocation = Capsule->GetComponentLocation();
+	Capsule->GetScaledCapsuleSize(Snapshot.CapsuleRadius, Snapshot.CapsuleHalfHeight);
+
+	Snapshot.MovementState = MovementState;
+	Snapshot.PrevMovementState = PrevMovementState;
+	Snapshot.MovementAction = MovementAction;
+	Snapshot.RotationMode = RotationMode;
+	Snapshot.Gait = Gait;
+	Snapshot.Stance = Stance;
+
+	Snapshot.FrameNumber = GFrameCounter;
+
+	PublishedSnapshotIndex.store(BackIndex, std::memory_order_release);
+
+	RecordFlightData();
+}
+
+void ULocomotionComponent::RecordFlightData()
+{
+	ELocomotionFlightFlags Flags = PendingFlightFlags;
+	PendingFlightFlags = ELocomotionFlightFlags::None;
+	if (!FlightRecorder.IsRecording()) return;
+
+	if (bReducedLocomotionRate)
+	{
+		Flags |= ELocomotionFlightFlags::ReducedRate;
+	}
+	if (!bLocomotionUpdateDue)
+	{
+		Flags |= ELocomotionFlightFlags::Interpolated;
+	}
+
+	FLocomotionFlightRecord Record;
+	Record.FrameNumber = static_cast<uint32>(GFrameCounter);
+	Record.Time = GetWorld()->GetTimeSeconds();
+	Record.Speed = static_cast<uint16>(FMath::Clamp(FMath::RoundToInt32(Speed), 0, MAX_uint16));
+	Record.MaxWalkSpeed = static_cast<uint16>(FMath::Clamp(FMath::RoundToInt32(MaxWalkSpeed), 0, MAX_uint16));
+	Record.AimYawRate = static_cast<int16>(FMath::Clamp(FMath::RoundToInt32(AimYawRate), MIN_int16, MAX_int16));
+	Record.State = PackLocomotionState();
+	Record.Flags = static_cast<uint8>(Flags);
+	FlightRecorder.Record(Record);
+}
+
+bool ULocomotionComponent::IsSimulatedProxy() const
+{
+	return CharacterOwner && CharacterOwner->GetLocalRole() == ROLE_SimulatedProxy;
+}
+
+uint8 ULocomotionComponent::PackLocomotionState() const
+{
+	FLocomotionStateWord State;
+	State.Gait = Gait;
+	State.Stance = Stance;
+	State.RotationMode = RotationMode;
+	State.MovementAction = MovementAction;
+	State.MovementState = MovementState;
+	return State.Pack();
+}
+
+void ULocomotionComponent::UpdateReplicatedState()
+{
+	if (!CharacterOwner || !CharacterOwner->HasAuthority()) return;
+
+	LocomotionState = PackLocomotionState();
+}
+
+void ULocomotionComponent::OnRep_LocomotionState()
+{
+	const FLocomotionStateWord State = FLocomotionStateWord::Unpack(LocomotionState);
+
+	const bool bSettingsChanged = State.Stance != Stance || State.RotationMode != RotationMode;
+	SetGait(State.Gait);
+	SetStance(State.Stance);
+	RotationMode = State.RotationMode;
+	MovementAction = State.MovementAction;
+
+	// Don't go through SetMovementState, the crouch state of a simulated proxy is replicated by the character.
+	if (State.MovementState != MovementState)
+	{
+		PrevMovementState = MovementState;
+		MovementState = State.MovementState;
+		if (MovementState == EMovementState::MS_InAir)
+		{
+			InAirRotation = CharacterOwner->GetActorRotation();
+		}
+	}
+
+	// Simulated proxies never evaluate the dynamic movement settings,
+	// they only need the rotation rate curve and speeds of the current stance and rotation mode.
+	if (bSettingsChanged && MovementTable)
+	{
+		CurrentMovementSettings = &GetTargetMovementSettings();
+	}
+}
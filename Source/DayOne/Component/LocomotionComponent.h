@@ -4,10 +4,56 @@
 
 #include "CoreMinimal.h"
 #include "DayOne/Data/CharacterState.h"
+#include "DayOne/Data/LocomotionCurves.h"
+#include "DayOne/Data/LocomotionFlightRecorder.h"
+#include "DayOne/Data/LocomotionSnapshot.h"
+#include "DayOne/Data/ModelTable.h"
 #include "DayOne/Data/MovementModel.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "LocomotionComponent.generated.h"
 
+// Saved move carrying the compressed locomotion input (FLocomotionInputWord),
+// so gait, stance, rotation mode and aim are replayed and sent to the server with the move they belong to.
+class FSavedMove_DayOne : public FSavedMove_Character
+{
+public:
+	typedef FSavedMove_Character Super;
+
+	uint8 LocomotionInput = 0;
+
+	virtual void Clear() override;
+	virtual void SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData) override;
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override;
+	virtual void PrepMoveFor(ACharacter* C) override;
+};
+
+class FNetworkPredictionData_Client_DayOne : public FNetworkPredictionData_Client_Character
+{
+public:
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	FNetworkPredictionData_Client_DayOne(const UCharacterMovementComponent& ClientMovement);
+
+	virtual FSavedMovePtr AllocateNewMove() override;
+};
+
+struct FCharacterNetworkMoveData_DayOne : public FCharacterNetworkMoveData
+{
+	typedef FCharacterNetworkMoveData Super;
+
+	uint8 LocomotionInput = 0;
+
+	virtual void ClientFillNetworkMoveData(const FSavedMove_Character& ClientMove, ENetworkMoveType MoveType) override;
+	virtual bool Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType) override;
+};
+
+struct FCharacterNetworkMoveDataContainer_DayOne : public FCharacterNetworkMoveDataContainer
+{
+	FCharacterNetworkMoveDataContainer_DayOne();
+
+	FCharacterNetworkMoveData_DayOne MoveData[3];
+};
+
 
 // UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 UCLASS()
@@ -17,16 +63,56 @@ class DAYONE_API ULocomotionComponent : public UCharacterMovementComponent
 
 public:	
 	friend class ABaseCharacter;
+	friend class ULocomotionSubsystem;
 	ULocomotionComponent(const FObjectInitializer& ObjectInitializer);
 	
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 	virtual void OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
 
 	virtual void Crouch(bool bClientSimulation = false) override;
 	virtual void UnCrouch(bool bClientSimulation = false) override;
+
+	// Locomotion input, predicted on the owning client and sent to the server with every move.
+	// Call on the owning client, the server takes it over with the next move.
+	UFUNCTION(BlueprintCallable, Category="Locomotion")
+	void SetDesiredGait(EGaitState NewDesiredGait);
+	UFUNCTION(BlueprintCallable, Category="Locomotion")
+	void SetDesiredRotationMode(ERotationMode NewDesiredRotationMode);
+	UFUNCTION(BlueprintCallable, Category="Locomotion")
+	void SetWantsToAim(bool bNewWantsToAim);
+	uint8 PackLocomotionInput() const;
+	void ApplyLocomotionInput(uint8 PackedInput);
+
+	// The locomotion state published by the last tick, safe to read from the anim worker threads.
+	// Only the game thread publishes, once per tick, into the buffer readers are not looking at.
+	FORCEINLINE const FLocomotionSnapshot& GetSnapshot() const
+	{
+		return Snapshots[PublishedSnapshotIndex.load(std::memory_order_acquire)];
+	}
+
+	const FLocomotionFlightRecorder& GetFlightRecorder() const { return FlightRecorder; }
+
+	// Where the character of Snapshot will be at every one of Times (seconds, ascending) if the current input is held,
+	// relative to its location now, in world axes, with its facing direction then.
+	// Integrates the acceleration toward the input at max speed, or the braking without input;
+	// the facing follows the velocity in the velocity rotation mode, the aim otherwise. Safe on any thread.
+	static void PredictTrajectory(const FLocomotionSnapshot& Snapshot, TArrayView<const float> Times,
+	                              TArrayView<FVector> OutLocations, TArrayView<FVector> OutFacings);
+
 	
 protected:
+	// Evaluate the movement settings inside the move, on the client and again on the server.
+	virtual void UpdateCharacterStateBeforeMovement(float DeltaSeconds) override;
+	virtual void ControlledCharacterMove(const FVector& InputVector, float DeltaSeconds) override;
+	virtual void MoveAutonomous(float ClientTimeStamp, float DeltaTime, uint8 CompressedFlags, const FVector& NewAccel) override;
+	virtual bool ServerCheckClientError(float ClientTimeStamp, float DeltaTime, const FVector& Accel, const FVector& ClientLoc,
+	                                    const FVector& RelativeClientLocation, UPrimitiveComponent* ClientMovementBase,
+	                                    FName ClientBaseBoneName, uint8 ClientMovementMode) override;
+
 	// Reference variables.
 	UPROPERTY()
 	class ABaseCharacter* Character;
@@ -63,10 +149,13 @@ protected:
 	// and so it can be different from the desired gait or allowed gait.
 	// For instance, if the Allowed Gait becomes walking, the Actual gait will still be running untill the character decelerates to the walking speed.
 	EGaitState GetActualGait(EGaitState AllowedGait) const;
+	// Derive the allowed gait from the move being performed and update the movement settings with it.
+	// Only reads state that is part of the move, so the server reproduces the client's result.
+	void UpdateMovementSettings();
 	// Use the allowed gait to update the movement settings.
-	void UpdateDynamicMovementSettings(EGaitState AllowedGait);
+	void UpdateDynamicMovementSettings(EGaitState AllowedGait, float MoveSpeed);
 	// Get the Current Movement Settings.
-	FMovementSettings GetTargetMovementSettings() const;
+	const FMovementModelEntry& GetTargetMovementSettings() const;
 	// Map the character's current speed to the configured movement speeds with a range of 0-3,
 	// with 0 = stopped, 1 = the Walk Speed, 2 = the Run Speed, and 3 = the Sprint Speed.
 	// This allows you to vary the movement speeds but still use the mapped range in calculations for consistent results.
@@ -82,7 +171,7 @@ protected:
 	// Interpolate the Target Rotation for extra smooth rotation behavior
 	void SmoothCharacterRotation(FRotator Target, float TargetInterpSpeed, float ActorInterpSpeed);
 	// get curve value from anim instance
-	float GetAnimCurveValue(FName CurveName) const;
+	float GetAnimCurveValue(ELocomotionCurve Curve) const;
 	// Calculate the rotation rate by using the current Rotation Rate Curve in the Movement Settings.
 	// Using the curve in conjunction with the mapped speed gives you a high level of control over the rotation rates for each speed.
 	// Increase the speed if the camera is rotating quickly for more responsive rotation.
@@ -92,14 +181,42 @@ protected:
 	
 	// Cache certain values to be used in calculations on the next frame
 	void CacheValues();
+	// Decide if the locomotion logic runs this tick, see bReducedLocomotionRate.
+	void UpdateLocomotionLOD(float DeltaTime);
+	// Cheap rotation update for the ticks skipped by the reduced rate.
+	void InterpolateSkippedRotation(float DeltaTime);
+
+	// Rotation writes of one tick are queued and applied at most once, see ApplyPendingRotation().
+	// The actor rotation including the queued writes of this tick.
+	FRotator GetPendingActorRotation() const;
+	void QueueActorRotation(const FRotator& NewRotation);
+	// Write the queued rotation, skipped if it is within tolerance of the current one.
+	void ApplyPendingRotation();
+
+	// Fill the back snapshot buffer with this frame's values and make it the published one.
+	void PublishSnapshot();
+	// Append this tick to the flight recorder.
+	void RecordFlightData();
+
+	// Simulated proxies take their states from the server instead of deriving them.
+	bool IsSimulatedProxy() const;
+	// Gait, Stance, RotationMode, MovementAction and MovementState packed by FLocomotionStateWord.
+	uint8 PackLocomotionState() const;
+	// Pack the derived states into the replicated state word, server only.
+	void UpdateReplicatedState();
+	UFUNCTION()
+	void OnRep_LocomotionState();
 	
 	// MovementSettings read from foreign table.
 	// Currently we only support Normal movement state.
 	// Possible future movement state including DE-BUFF/BUFF
 	UPROPERTY(EditDefaultsOnly, Category="DataTable")
 	UDataTable* MovementModel;
-	FMovementData MovementData;
-	FMovementSettings CurrentMovementSettings;
+	// MovementModel flattened and shared by every character using it.
+	TSharedPtr<const FMovementModelTable> MovementTable;
+	EMovementModel MovementModelType;
+	// Points into MovementTable.
+	const FMovementModelEntry* CurrentMovementSettings;
 	
 private:
 	// Cached variables
@@ -128,6 +245,11 @@ private:
 
 	// Player input state variables
 	EGaitState DesiredGait;
+	ERotationMode DesiredRotationMode;
+	bool bWantsToAim;
+	// Movement input near its full amount, taken from the raw input of the move rather than from the acceleration,
+	// which is scaled by a MaxAcceleration the move does not carry.
+	bool bFullMovementInput;
 
 	// Actual state variables
 	// Grounded or InAir(Falling)
@@ -135,15 +257,53 @@ private:
 	EMovementState PrevMovementState;
 	// Standing or Crouching
 	EStanceState Stance;
+	EStanceState PrevStance;
 	EStanceState DesiredStance;
 	// Looking or Aiming
 	ERotationMode RotationMode;
 	// Walking, Running or Sprinting
 	EGaitState Gait;
+	EGaitState PrevGait;
 	// None, Rolling or GettingUp
 	EMovementAction MovementAction;
 
 	// Rotation system
 	FRotator TargetRotation;
 	FRotator InAirRotation;
+	FRotator PendingActorRotation;
+	bool bHasPendingRotation;
+	int32 QueuedRotationWrites;
+
+	// Server locomotion LOD, set by ULocomotionSubsystem.
+	// Characters far from every player run the locomotion logic at a reduced rate,
+	// and only interpolate their rotation on the ticks in between.
+	bool bReducedLocomotionRate;
+	// Beyond DayOne.Locomotion.LOD.Distance of every player view point, on every net mode.
+	bool bBeyondLODDistance;
+	bool bLocomotionUpdateDue;
+	// Time accumulated since the last locomotion update at reduced rate.
+	float LocomotionLODTime;
+	// Delta time of the current locomotion update.
+	float LocomotionDeltaTime;
+	// Actor interp speed of the last rotation smoothing, continued on skipped ticks.
+	float LastActorInterpSpeed;
+
+	// Gait, Stance, RotationMode, MovementAction and InAir packed by FLocomotionStateWord.
+	UPROPERTY(ReplicatedUsing=OnRep_LocomotionState)
+	uint8 LocomotionState;
+
+	FCharacterNetworkMoveDataContainer_DayOne NetworkMoveDataContainer;
+
+	// Double buffered snapshot, see GetSnapshot().
+	FLocomotionSnapshot Snapshots[2];
+	std::atomic<uint32> PublishedSnapshotIndex;
+
+	// Last ticks of locomotion, dumped by ULocomotionSubsystem on demand or on hitch.
+	FLocomotionFlightRecorder FlightRecorder;
+	// Network events since the last record.
+	ELocomotionFlightFlags PendingFlightFlags;
+
+	// Batched update owner, null if this component ticks its locomotion by itself.
+	UPROPERTY(Transient)
+	class ULocomotionSubsystem* LocomotionSubsystem;
 };
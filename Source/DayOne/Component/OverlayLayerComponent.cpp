@@ -0,0 +1,140 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "OverlayLayerComponent.h"
+
+#include "Animation/AnimInstance.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "DayOne/DayOne.h"
+#include "Engine/AssetManager.h"
+#include "GameFramework/Character.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Overlay Layers Linked"), STAT_OverlayLayersLinked, STATGROUP_DayOne);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Overlay Layer Loads"), STAT_OverlayLayerLoads, STATGROUP_DayOne);
+
+UOverlayLayerComponent::UOverlayLayerComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+
+	OverlayState = EOverlayState::OS_Default;
+	LinkedOverlayState = EOverlayState::OS_Default;
+	LinkedLayerClass = nullptr;
+}
+
+void UOverlayLayerComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Anything linked before BeginPlay went to an anim instance that may have been reinitialized since.
+	const EOverlayState InitialOverlayState = OverlayState;
+	LinkOverlayLayer(EOverlayState::OS_Default, nullptr, nullptr);
+	OverlayState = EOverlayState::OS_Default;
+	SetOverlayState(InitialOverlayState);
+}
+
+void UOverlayLayerComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	CancelPendingLoad();
+	LinkOverlayLayer(EOverlayState::OS_Default, nullptr, nullptr);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UOverlayLayerComponent::SetOverlayState(EOverlayState NewOverlayState)
+{
+	if (NewOverlayState == OverlayState && (LinkedOverlayState == OverlayState || PendingLayerHandle.IsValid()))
+	{
+		return;
+	}
+	OverlayState = NewOverlayState;
+	CancelPendingLoad();
+
+	const TSoftClassPtr<UAnimInstance>* LayerClass = OverlayLayers.Find(NewOverlayState);
+	if (!LayerClass || LayerClass->IsNull())
+	{
+		LinkOverlayLayer(NewOverlayState, nullptr, nullptr);
+		return;
+	}
+
+	// Also when the class is already loaded by another character, the handle is what keeps it loaded for this one.
+	INC_DWORD_STAT(STAT_OverlayLayerLoads);
+	PendingLayerHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+		LayerClass->ToSoftObjectPath(), FStreamableDelegate::CreateUObject(this, &ThisClass::OnOverlayLayerLoaded, NewOverlayState));
+	if (!PendingLayerHandle.IsValid())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UOverlayLayerComponent: cannot load %s"), *LayerClass->ToString());
+		LinkOverlayLayer(NewOverlayState, nullptr, nullptr);
+	}
+	// Already in memory, the delegate may have run before the handle was stored.
+	else if (PendingLayerHandle->HasLoadCompleted())
+	{
+		OnOverlayLayerLoaded(NewOverlayState);
+	}
+}
+
+void UOverlayLayerComponent::OnOverlayLayerLoaded(EOverlayState LoadedOverlayState)
+{
+	// Superseded by a newer overlay state (its handle is cancelled), or already linked.
+	if (LoadedOverlayState != OverlayState || !PendingLayerHandle.IsValid())
+	{
+		return;
+	}
+
+	TSharedPtr<FStreamableHandle> LayerHandle = MoveTemp(PendingLayerHandle);
+	UClass* LayerClass = Cast<UClass>(LayerHandle->GetLoadedAsset());
+	if (!LayerClass)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UOverlayLayerComponent: overlay layer of state %d failed to load"), static_cast<int32>(LoadedOverlayState));
+		LayerHandle.Reset();
+	}
+	LinkOverlayLayer(LoadedOverlayState, LayerClass, MoveTemp(LayerHandle));
+}
+
+void UOverlayLayerComponent::LinkOverlayLayer(EOverlayState NewOverlayState, UClass* LayerClass, TSharedPtr<FStreamableHandle> LayerHandle)
+{
+	UAnimInstance* AnimInstance = GetAnimInstance();
+	if (LinkedLayerClass != LayerClass)
+	{
+		if (AnimInstance && LinkedLayerClass)
+		{
+			AnimInstance->UnlinkAnimClassLayers(LinkedLayerClass);
+		}
+		if (AnimInstance && LayerClass)
+		{
+			AnimInstance->LinkAnimClassLayers(LayerClass);
+		}
+	}
+
+	if (LinkedLayerClass)
+	{
+		DEC_DWORD_STAT(STAT_OverlayLayersLinked);
+	}
+	if (LayerClass)
+	{
+		INC_DWORD_STAT(STAT_OverlayLayersLinked);
+	}
+
+	// Once no character holds it, the previous layer and its sequences can be garbage collected.
+	if (LinkedLayerHandle.IsValid())
+	{
+		LinkedLayerHandle->ReleaseHandle();
+	}
+	LinkedLayerHandle = MoveTemp(LayerHandle);
+	LinkedLayerClass = LayerClass;
+	LinkedOverlayState = NewOverlayState;
+}
+
+void UOverlayLayerComponent::CancelPendingLoad()
+{
+	if (PendingLayerHandle.IsValid())
+	{
+		PendingLayerHandle->CancelHandle();
+		PendingLayerHandle.Reset();
+	}
+}
+
+UAnimInstance* UOverlayLayerComponent::GetAnimInstance() const
+{
+	const ACharacter* Character = Cast<ACharacter>(GetOwner());
+	return Character && Character->GetMesh() ? Character->GetMesh()->GetAnimInstance() : nullptr;
+}
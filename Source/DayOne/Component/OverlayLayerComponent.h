@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "DayOne/Data/CharacterState.h"
+#include "OverlayLayerComponent.generated.h"
+
+class UAnimInstance;
+struct FStreamableHandle;
+
+/**
+ * Links the overlay anim layer of the held weapon or prop into the character's anim instance.
+ * Every overlay state is an anim class implementing the overlay layer interface, only soft referenced here,
+ * so its sequences are streamed in when a character first needs that overlay and released once none does.
+ * The anim memory of a client then follows the overlays in use instead of the whole catalog.
+ * While a layer streams in, the previous one stays linked. States without a layer use the main anim graph's default.
+ * Call SetOverlayState on every machine, e.g. from the replicated equip.
+ */
+UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
+class DAYONE_API UOverlayLayerComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UOverlayLayerComponent();
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	UFUNCTION(BlueprintCallable, Category="Overlay")
+	void SetOverlayState(EOverlayState NewOverlayState);
+
+	UFUNCTION(BlueprintPure, Category="Overlay")
+	FORCEINLINE EOverlayState GetOverlayState() const
+	{
+		return OverlayState;
+	}
+	// Overlay state whose layer is linked now, lags behind GetOverlayState() while the layer streams in.
+	UFUNCTION(BlueprintPure, Category="Overlay")
+	FORCEINLINE EOverlayState GetLinkedOverlayState() const
+	{
+		return LinkedOverlayState;
+	}
+
+private:
+	void OnOverlayLayerLoaded(EOverlayState LoadedOverlayState);
+	// Swap the linked layer for LayerClass (none if null), LayerHandle keeps it loaded while linked.
+	void LinkOverlayLayer(EOverlayState NewOverlayState, UClass* LayerClass, TSharedPtr<FStreamableHandle> LayerHandle);
+	void CancelPendingLoad();
+	UAnimInstance* GetAnimInstance() const;
+
+	// Overlay layer anim class of every overlay state.
+	UPROPERTY(EditDefaultsOnly, Category="Overlay", meta=(AllowPrivateAccess="true"))
+	TMap<EOverlayState, TSoftClassPtr<UAnimInstance>> OverlayLayers;
+
+	// Desired overlay state.
+	UPROPERTY(EditAnywhere, Category="Overlay", meta=(AllowPrivateAccess="true"))
+	EOverlayState OverlayState;
+
+	EOverlayState LinkedOverlayState;
+	UPROPERTY(Transient)
+	UClass* LinkedLayerClass;
+	TSharedPtr<FStreamableHandle> LinkedLayerHandle;
+	// Load of the OverlayState layer in flight.
+	TSharedPtr<FStreamableHandle> PendingLayerHandle;
+};
@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SwatMovementComponent.h"
+
+#include "GameFramework/Character.h"
+
+void FSavedMove_Swat::Clear()
+{
+	Super::Clear();
+
+	bWantsToAim = false;
+}
+
+void FSavedMove_Swat::SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData)
+{
+	Super::SetMoveFor(C, InDeltaTime, NewAccel, ClientData);
+
+	bWantsToAim = CastChecked<USwatMovementComponent>(C->GetCharacterMovement())->WantsToAim();
+}
+
+bool FSavedMove_Swat::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const
+{
+	if (bWantsToAim != static_cast<const FSavedMove_Swat*>(NewMove.Get())->bWantsToAim)
+	{
+		return false;
+	}
+
+	return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+}
+
+void FSavedMove_Swat::PrepMoveFor(ACharacter* C)
+{
+	Super::PrepMoveFor(C);
+
+	// Restore the aim input this move was made with before it gets replayed.
+	CastChecked<USwatMovementComponent>(C->GetCharacterMovement())->SetWantsToAim(bWantsToAim);
+}
+
+FNetworkPredictionData_Client_Swat::FNetworkPredictionData_Client_Swat(const UCharacterMovementComponent& ClientMovement)
+	: Super(ClientMovement)
+{
+}
+
+FSavedMovePtr FNetworkPredictionData_Client_Swat::AllocateNewMove()
+{
+	return FSavedMovePtr(new FSavedMove_Swat());
+}
+
+void FCharacterNetworkMoveData_Swat::ClientFillNetworkMoveData(const FSavedMove_Character& ClientMove, ENetworkMoveType MoveType)
+{
+	Super::ClientFillNetworkMoveData(ClientMove, MoveType);
+
+	bWantsToAim = static_cast<const FSavedMove_Swat&>(ClientMove).bWantsToAim;
+}
+
+bool FCharacterNetworkMoveData_Swat::Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType)
+{
+	Super::Serialize(CharacterMovement, Ar, PackageMap, MoveType);
+
+	Ar.SerializeBits(&bWantsToAim, 1);
+
+	return !Ar.IsError();
+}
+
+FCharacterNetworkMoveDataContainer_Swat::FCharacterNetworkMoveDataContainer_Swat()
+{
+	NewMoveData = &MoveData[0];
+	PendingMoveData = &MoveData[1];
+	OldMoveData = &MoveData[2];
+}
+
+USwatMovementComponent::USwatMovementComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	MaxWalkSpeed = 600.0f;
+	AimWalkSpeed = 300.0f;
+	bWantsToAim = false;
+
+	SetNetworkMoveDataContainer(NetworkMoveDataContainer);
+}
+
+FNetworkPredictionData_Client* USwatMovementComponent::GetPredictionData_Client() const
+{
+	if (ClientPredictionData == nullptr)
+	{
+		USwatMovementComponent* MutableThis = const_cast<USwatMovementComponent*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_Swat(*this);
+	}
+
+	return ClientPredictionData;
+}
+
+float USwatMovementComponent::GetMaxSpeed() const
+{
+	// Crouching keeps MaxWalkSpeedCrouched, as when aiming wrote MaxWalkSpeed.
+	if (bWantsToAim && IsMovingOnGround() && !IsCrouching())
+	{
+		return AimWalkSpeed;
+	}
+
+	return Super::GetMaxSpeed();
+}
+
+void USwatMovementComponent::SetWantsToAim(bool bNewWantsToAim)
+{
+	bWantsToAim = bNewWantsToAim;
+}
+
+void USwatMovementComponent::MoveAutonomous(float ClientTimeStamp, float DeltaTime, uint8 CompressedFlags, const FVector& NewAccel)
+{
+	// Take over the aim input the client made this move with.
+	if (const FCharacterNetworkMoveData_Swat* MoveData = static_cast<const FCharacterNetworkMoveData_Swat*>(GetCurrentNetworkMoveData()))
+	{
+		bWantsToAim = MoveData->bWantsToAim;
+	}
+
+	Super::MoveAutonomous(ClientTimeStamp, DeltaTime, CompressedFlags, NewAccel);
+}
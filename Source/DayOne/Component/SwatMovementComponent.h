@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "SwatMovementComponent.generated.h"
+
+// Saved move carrying the aim input of ASwatCharacter,
+// so the aiming walk speed is replayed and sent to the server with the move it belongs to.
+class FSavedMove_Swat : public FSavedMove_Character
+{
+public:
+	typedef FSavedMove_Character Super;
+
+	bool bWantsToAim = false;
+
+	virtual void Clear() override;
+	virtual void SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData) override;
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override;
+	virtual void PrepMoveFor(ACharacter* C) override;
+};
+
+class FNetworkPredictionData_Client_Swat : public FNetworkPredictionData_Client_Character
+{
+public:
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	FNetworkPredictionData_Client_Swat(const UCharacterMovementComponent& ClientMovement);
+
+	virtual FSavedMovePtr AllocateNewMove() override;
+};
+
+struct FCharacterNetworkMoveData_Swat : public FCharacterNetworkMoveData
+{
+	typedef FCharacterNetworkMoveData Super;
+
+	bool bWantsToAim = false;
+
+	virtual void ClientFillNetworkMoveData(const FSavedMove_Character& ClientMove, ENetworkMoveType MoveType) override;
+	virtual bool Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType) override;
+};
+
+struct FCharacterNetworkMoveDataContainer_Swat : public FCharacterNetworkMoveDataContainer
+{
+	FCharacterNetworkMoveDataContainer_Swat();
+
+	FCharacterNetworkMoveData_Swat MoveData[3];
+};
+
+// Movement of ASwatCharacter: walks at AimWalkSpeed while aiming, computed inside the move from the aim input it carries.
+UCLASS()
+class DAYONE_API USwatMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+	USwatMovementComponent(const FObjectInitializer& ObjectInitializer);
+
+	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+	virtual float GetMaxSpeed() const override;
+
+	// Call on the owning client (or the server for characters it controls), the server takes it over with the next move.
+	void SetWantsToAim(bool bNewWantsToAim);
+	FORCEINLINE bool WantsToAim() const { return bWantsToAim; }
+
+protected:
+	virtual void MoveAutonomous(float ClientTimeStamp, float DeltaTime, uint8 CompressedFlags, const FVector& NewAccel) override;
+
+private:
+	// Max walk speed while aiming, MaxWalkSpeed otherwise.
+	UPROPERTY(EditDefaultsOnly, Category="Character Movement: Walking", meta=(AllowPrivateAccess="true", ClampMin="0", UIMin="0"))
+	float AimWalkSpeed;
+
+	bool bWantsToAim;
+
+	FCharacterNetworkMoveDataContainer_Swat NetworkMoveDataContainer;
+};
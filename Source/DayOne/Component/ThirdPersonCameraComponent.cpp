@@ -4,6 +4,7 @@
 #include "ThirdPersonCameraComponent.h"
 
 #include "DayOne/Character/BaseCharacter.h"
+#include "DayOne/Subsystem/ModelTableSubsystem.h"
 #include "Kismet/GameplayStatics.h"
 #include "Kismet/KismetMathLibrary.h"
 
@@ -164,90 +165,26 @@ void UThirdPersonCameraComponent::GetTraceParams(FVector& TraceOrigin, float& Tr
 void UThirdPersonCameraComponent::LoadCameraModel()
 {
 	check(CameraModel);
-	
-	const FText StandingString = StaticEnum<EStanceState>()->GetDisplayNameTextByIndex(static_cast<int32>(EStanceState::SS_Standing));
-	CameraData.Standing = CameraModel->FindRow<FCameraSettingsGait>(*StandingString.ToString(), "Camera In Standing Context");
-
-	const FText CrouchingString = StaticEnum<EStanceState>()->GetDisplayNameTextByIndex(static_cast<int32>(EStanceState::SS_Crouching));
-	CameraData.Crouching = CameraModel->FindRow<FCameraSettingsGait>(*CrouchingString.ToString(), "Camera In Crouching Context");
 
-	check(CameraData.Standing);
-	check(CameraData.Crouching);
+	// Get the shared, flattened Camera Model, the rows are only resolved by the first camera using it.
+	CameraTable = GEngine->GetEngineSubsystem<UModelTableSubsystem>()->GetCameraModelTable(CameraModel);
 }
 
 void UThirdPersonCameraComponent::UpdateCameraSettings(float DeltaTime)
 {
-	check(Character);
-	
-	if (Character->GetStance() == EStanceState::SS_Standing)
-	{
-		switch (Character->GetGait())
-		{
-		case EGaitState::GS_Walking:
-			// UE_LOG(LogTemp, Warning, TEXT("Switch CameraSettings to Standing Walking"))
-			CurrentCameraSettings.CameraOffset = UKismetMathLibrary::VInterpTo(CurrentCameraSettings.CameraOffset,
-																				CameraData.Standing->Walking.CameraOffset,
-																				DeltaTime, 1.5f);
-			CurrentCameraSettings.PivotLagSpeed = UKismetMathLibrary::VInterpTo(CurrentCameraSettings.PivotLagSpeed,
-																				 CameraData.Standing->Walking.PivotLagSpeed,
-																				 DeltaTime, 1.5f);
-			break;
-		case EGaitState::GS_Running:
-			// UE_LOG(LogTemp, Warning, TEXT("Switch CameraSettings to Standing Running"))
-			CurrentCameraSettings.CameraOffset = UKismetMathLibrary::VInterpTo(CurrentCameraSettings.CameraOffset,
-																				CameraData.Standing->Running.CameraOffset,
-																				DeltaTime, 2.0f);
-			CurrentCameraSettings.PivotLagSpeed = UKismetMathLibrary::VInterpTo(CurrentCameraSettings.PivotLagSpeed,
-																				 CameraData.Standing->Running.PivotLagSpeed,
-																				 DeltaTime, 2.0f);
-			break;
-		case EGaitState::GS_Sprinting:
-			// UE_LOG(LogTemp, Warning, TEXT("Switch CameraSettings to Standing Sprinting"))
-			CurrentCameraSettings.CameraOffset = UKismetMathLibrary::VInterpTo(CurrentCameraSettings.CameraOffset,
-																			    CameraData.Standing->Sprinting.CameraOffset,
-																			    DeltaTime, 0.35f);
-			CurrentCameraSettings.PivotLagSpeed = UKismetMathLibrary::VInterpTo(CurrentCameraSettings.PivotLagSpeed,
-																				 CameraData.Standing->Sprinting.PivotLagSpeed,
-																				 DeltaTime, 0.35f);
-			break;
-		default:
-			checkNoEntry();
-		}
-	}
-	else if (Character->GetStance() == EStanceState::SS_Crouching)
+	check(Character && Character->GetLocomotionComponent() && CameraTable);
+
+	// How fast the camera blends into the settings of each stance and gait.
+	static constexpr float InterpSpeeds[static_cast<int32>(EStanceState::SS_MAX)][static_cast<int32>(EGaitState::GS_MAX)] =
 	{
-		switch (Character->GetGait())
-		{
-		case EGaitState::GS_Walking:
-			UE_LOG(LogTemp, Warning, TEXT("Switch CameraSettings to Crouching Walking"))
-			CurrentCameraSettings.CameraOffset = UKismetMathLibrary::VInterpTo(CurrentCameraSettings.CameraOffset,
-																			    CameraData.Crouching->Walking.CameraOffset,
-																			    DeltaTime, 1.5f);
-			CurrentCameraSettings.PivotLagSpeed = UKismetMathLibrary::VInterpTo(CurrentCameraSettings.PivotLagSpeed,
-			                                                                     CameraData.Crouching->Walking.PivotLagSpeed,
-			                                                                     DeltaTime, 1.5f);
-			break;
-		case EGaitState::GS_Running:
-			UE_LOG(LogTemp, Warning, TEXT("Switch CameraSettings to Crouching Running"))
-			CurrentCameraSettings.CameraOffset = UKismetMathLibrary::VInterpTo(CurrentCameraSettings.CameraOffset,
-																			    CameraData.Crouching->Running.CameraOffset,
-																			    DeltaTime, 1.5f);
-			CurrentCameraSettings.PivotLagSpeed = UKismetMathLibrary::VInterpTo(CurrentCameraSettings.PivotLagSpeed,
-																			     CameraData.Crouching->Running.PivotLagSpeed,
-																			     DeltaTime, 1.5f);
-			break;
-		case EGaitState::GS_Sprinting:
-			UE_LOG(LogTemp, Warning, TEXT("Switch CameraSettings to Crouching Sprinting"))
-			CurrentCameraSettings.CameraOffset = UKismetMathLibrary::VInterpTo(CurrentCameraSettings.CameraOffset,
-																				CameraData.Crouching->Sprinting.CameraOffset,
-																				DeltaTime, 1.5f);
-			CurrentCameraSettings.PivotLagSpeed = UKismetMathLibrary::VInterpTo(CurrentCameraSettings.PivotLagSpeed,
-																				 CameraData.Crouching->Sprinting.PivotLagSpeed,
-																				 DeltaTime, 1.5f);
-			break;
-		default:
-			checkNoEntry();
-		}
-	}
-}
+		{ 1.5f, 2.0f, 0.35f }, // Standing: Walking, Running, Sprinting
+		{ 1.5f, 1.5f, 1.5f },  // Crouching: Walking, Running, Sprinting
+	};
 
+	const FLocomotionSnapshot& Locomotion = Character->GetLocomotionComponent()->GetSnapshot();
+	const FCameraSettings& TargetSettings = CameraTable->Get(Locomotion.Stance, Locomotion.Gait);
+	const float InterpSpeed = InterpSpeeds[static_cast<int32>(Locomotion.Stance)][static_cast<int32>(Locomotion.Gait)];
+
+	CurrentCameraSettings.CameraOffset = UKismetMathLibrary::VInterpTo(CurrentCameraSettings.CameraOffset, TargetSettings.CameraOffset, DeltaTime, InterpSpeed);
+	CurrentCameraSettings.PivotLagSpeed = UKismetMathLibrary::VInterpTo(CurrentCameraSettings.PivotLagSpeed, TargetSettings.PivotLagSpeed, DeltaTime, InterpSpeed);
+}
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "Camera/CameraComponent.h"
 #include "DayOne/Data/CameraModel.h"
+#include "DayOne/Data/ModelTable.h"
 #include "ThirdPersonCameraComponent.generated.h"
 
 
@@ -68,7 +69,8 @@ protected:
 	// The camera data table & config
 	UPROPERTY(EditDefaultsOnly, Category="DataTable")
 	UDataTable* CameraModel;
-	FCameraData CameraData;
+	// CameraModel flattened and shared by every camera using it.
+	TSharedPtr<const FCameraModelTable> CameraTable;
 	// We need interpolate config value between different config settings.
 	// So we have to keep a settings state.
 	FCameraSettings CurrentCameraSettings;
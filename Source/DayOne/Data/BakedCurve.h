@@ -0,0 +1,60 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Math/VectorRegister.h"
+
+// A UCurveFloat or UCurveVector resampled at a fixed resolution over its key range by UCurveBakeSubsystem.
+// A lookup is a clamp, a multiply and a lerp between two neighbouring samples,
+// instead of the key search and tangent evaluation of FRichCurve.
+// Outside the key range the value is clamped, like the default constant extrapolation of the authoring curve.
+struct FBakedCurve
+{
+	static constexpr int32 NumSamples = 256;
+
+	float MinTime = 0.0f;
+	float MaxTime = 0.0f;
+	float InvSampleStep = 0.0f;
+	// Largest difference to the authoring curve measured between the samples when the curve was baked.
+	float MaxError = 0.0f;
+
+protected:
+	FORCEINLINE void Locate(float Time, int32& OutIndex, float& OutAlpha) const
+	{
+		const float Position = FMath::Clamp((Time - MinTime) * InvSampleStep, 0.0f, static_cast<float>(NumSamples - 1));
+		OutIndex = FMath::Min(FMath::TruncToInt32(Position), NumSamples - 2);
+		OutAlpha = Position - static_cast<float>(OutIndex);
+	}
+};
+
+struct FBakedCurveFloat : FBakedCurve
+{
+	TArray<float> Values;
+
+	FORCEINLINE float Evaluate(float Time) const
+	{
+		int32 Index;
+		float Alpha;
+		Locate(Time, Index, Alpha);
+		return FMath::Lerp(Values[Index], Values[Index + 1], Alpha);
+	}
+};
+
+struct FBakedCurveVector : FBakedCurve
+{
+	// One XYZ0 register per sample, so a lookup is two loads and a multiply-add.
+	TArray<VectorRegister4Float> Values;
+
+	FORCEINLINE FVector Evaluate(float Time) const
+	{
+		int32 Index;
+		float Alpha;
+		Locate(Time, Index, Alpha);
+
+		const VectorRegister4Float& A = Values[Index];
+		const VectorRegister4Float& B = Values[Index + 1];
+		const VectorRegister4Float Result = VectorMultiplyAdd(VectorSubtract(B, A), VectorSetFloat1(Alpha), A);
+
+		FVector4f Out;
+		VectorStore(Result, &Out.X);
+		return FVector(Out.X, Out.Y, Out.Z);
+	}
+};
@@ -34,9 +34,3 @@ struct FCameraSettingsGait : public FTableRowBase
 	UPROPERTY(EditAnywhere)
 	FCameraSettings Sprinting;
 };
-
-struct FCameraData
-{
-	FCameraSettingsGait* Standing;
-	FCameraSettingsGait* Crouching;
-};
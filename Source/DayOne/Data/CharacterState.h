@@ -46,6 +46,16 @@ enum class ERotationMode : uint8
 	RM_MAX
 };
 
+UENUM(BlueprintType, meta=(ScriptName="MovementDirection"))
+enum class EMovementDirection : uint8
+{
+	MD_Forward = 0 UMETA(DisplayName = "Forward"),
+	MD_Right UMETA(DisplayName = "Right"),
+	MD_Left UMETA(DisplayName = "Left"),
+	MD_Backward UMETA(DisplayName = "Backward"),
+	MD_MAX
+};
+
 UENUM(BlueprintType, meta=(ScriptName="MovementModel"))
 enum class EMovementModel : uint8
 {
@@ -64,3 +74,24 @@ enum class EViewMode : uint8
 	VM_FirstPerson UMETA(DisplayName = "FirstPerson"),
 	VM_MAX
 };
+
+UENUM(BlueprintType, meta=(ScriptName="OverlayState"))
+enum class EOverlayState : uint8
+{
+	// Upper body pose of the held weapon or prop, each one is a linked anim layer (see UOverlayLayerComponent).
+	// Default and the stance variations need nothing in the hands.
+	OS_Default = 0 UMETA(DisplayName = "Default"),
+	OS_Masculine UMETA(DisplayName = "Masculine"),
+	OS_Feminine UMETA(DisplayName = "Feminine"),
+	OS_Injured UMETA(DisplayName = "Injured"),
+	OS_HandsTied UMETA(DisplayName = "HandsTied"),
+	OS_Rifle UMETA(DisplayName = "Rifle"),
+	OS_PistolOneHanded UMETA(DisplayName = "PistolOneHanded"),
+	OS_PistolTwoHanded UMETA(DisplayName = "PistolTwoHanded"),
+	OS_Bow UMETA(DisplayName = "Bow"),
+	OS_Torch UMETA(DisplayName = "Torch"),
+	OS_Binoculars UMETA(DisplayName = "Binoculars"),
+	OS_Box UMETA(DisplayName = "Box"),
+	OS_Barrel UMETA(DisplayName = "Barrel"),
+	OS_MAX
+};
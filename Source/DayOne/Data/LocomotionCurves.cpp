@@ -0,0 +1,73 @@
+#include "LocomotionCurves.h"
+
+namespace
+{
+	struct FLocomotionCurveNames
+	{
+		FName Names[static_cast<int32>(ELocomotionCurve::Num)];
+
+		FLocomotionCurveNames()
+		{
+			const TCHAR* Strings[] =
+			{
+				TEXT("Mask_AimOffset"),
+				TEXT("Mask_LandPrediction"),
+				TEXT("BasePose_N"),
+				TEXT("BasePose_CLF"),
+				TEXT("Layering_Spine_Add"),
+				TEXT("Layering_Head_Add"),
+				TEXT("Layering_Arm_L_Add"),
+				TEXT("Layering_Arm_R_Add"),
+				TEXT("Layering_Hand_L"),
+				TEXT("Layering_Hand_R"),
+				TEXT("Layering_Arm_L"),
+				TEXT("Layering_Arm_R"),
+				TEXT("Layering_Arm_L_LS"),
+				TEXT("Layering_Arm_R_LS"),
+				TEXT("Enable_HandIK_L"),
+				TEXT("Enable_HandIK_R"),
+				TEXT("Enable_FootIK_L"),
+				TEXT("Enable_FootIK_R"),
+				TEXT("FootLock_L"),
+				TEXT("FootLock_R"),
+				TEXT("Weight_Gait"),
+				TEXT("Enable_Transition"),
+				TEXT("YawOffset"),
+				TEXT("RotationAmount"),
+			};
+			static_assert(UE_ARRAY_COUNT(Strings) == static_cast<int32>(ELocomotionCurve::Num), "Every ELocomotionCurve needs a name");
+
+			for (int32 Index = 0; Index < UE_ARRAY_COUNT(Strings); ++Index)
+			{
+				Names[Index] = FName(Strings[Index]);
+			}
+		}
+	};
+
+	const FLocomotionCurveNames& GetCurveNames()
+	{
+		static const FLocomotionCurveNames CurveNames;
+		return CurveNames;
+	}
+}
+
+const FName& FLocomotionCurveBundle::GetName(ELocomotionCurve Curve)
+{
+	check(Curve < ELocomotionCurve::Num);
+	return GetCurveNames().Names[static_cast<int32>(Curve)];
+}
+
+void FLocomotionCurveBundle::Reset()
+{
+	FMemory::Memzero(Values);
+}
+
+void FLocomotionCurveBundle::Read(const TMap<FName, float>& Curves)
+{
+	const FLocomotionCurveNames& CurveNames = GetCurveNames();
+	for (int32 Index = 0; Index < static_cast<int32>(ELocomotionCurve::Num); ++Index)
+	{
+		const float* Value = Curves.Find(CurveNames.Names[Index]);
+		Values[Index] = Value ? *Value : 0.0f;
+	}
+}
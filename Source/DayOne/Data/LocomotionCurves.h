@@ -0,0 +1,50 @@
+#pragma once
+#include "CoreMinimal.h"
+
+// The anim curves the locomotion code reads every frame.
+enum class ELocomotionCurve : uint8
+{
+	MaskAimOffset,
+	MaskLandPrediction,
+	BasePoseN,
+	BasePoseCLF,
+	LayeringSpineAdd,
+	LayeringHeadAdd,
+	LayeringArmLAdd,
+	LayeringArmRAdd,
+	LayeringHandL,
+	LayeringHandR,
+	LayeringArmL,
+	LayeringArmR,
+	LayeringArmLLS,
+	LayeringArmRLS,
+	EnableHandIKL,
+	EnableHandIKR,
+	EnableFootIKL,
+	EnableFootIKR,
+	FootLockL,
+	FootLockR,
+	WeightGait,
+	EnableTransition,
+	YawOffset,
+	RotationAmount,
+	Num
+};
+
+// The value of every ELocomotionCurve, fetched from the evaluated curves in one pass
+// instead of building a name and looking it up at every use.
+struct DAYONE_API FLocomotionCurveBundle
+{
+	// Name of the curve, built once and shared.
+	static const FName& GetName(ELocomotionCurve Curve);
+
+	void Reset();
+	void Read(const TMap<FName, float>& Curves);
+
+	FORCEINLINE float operator[](ELocomotionCurve Curve) const
+	{
+		return Values[static_cast<int32>(Curve)];
+	}
+
+	float Values[static_cast<int32>(ELocomotionCurve::Num)] = {};
+};
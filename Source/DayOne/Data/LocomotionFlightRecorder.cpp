@@ -0,0 +1,128 @@
+#include "LocomotionFlightRecorder.h"
+
+#include "CharacterState.h"
+#include "LocomotionStateWord.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+	struct FLocomotionFlightFileHeader
+	{
+		static constexpr uint32 ExpectedMagic = 0x52464C44; // "DLFR"
+		static constexpr uint16 CurrentVersion = 1;
+
+		uint32 Magic = ExpectedMagic;
+		uint16 Version = CurrentVersion;
+		uint16 RecordSize = sizeof(FLocomotionFlightRecord);
+		uint32 NumRecords = 0;
+		uint32 Reserved = 0;
+	};
+	static_assert(sizeof(FLocomotionFlightFileHeader) == 16, "FLocomotionFlightFileHeader is written to files as is");
+
+	template <typename TEnum>
+	FString EnumName(TEnum Value)
+	{
+		return StaticEnum<TEnum>()->GetNameStringByValue(static_cast<int64>(Value));
+	}
+}
+
+static FAutoConsoleCommand LocomotionFlightRecorderToCSVCommand(
+	TEXT("DayOne.Locomotion.FlightRecorder.ToCSV"),
+	TEXT("Convert a locomotion flight record to CSV. Usage: DayOne.Locomotion.FlightRecorder.ToCSV <File> [CSVFile]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		if (Args.Num() == 0)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Usage: DayOne.Locomotion.FlightRecorder.ToCSV <File> [CSVFile]"));
+			return;
+		}
+
+		const FString CSVFilename = Args.Num() > 1 ? Args[1] : FPaths::ChangeExtension(Args[0], TEXT(".csv"));
+		if (FLocomotionFlightRecorder::ConvertToCSV(Args[0], CSVFilename))
+		{
+			UE_LOG(LogTemp, Log, TEXT("Wrote %s"), *CSVFilename);
+		}
+	}));
+
+void FLocomotionFlightRecorder::Initialize()
+{
+	Records.SetNumZeroed(Capacity);
+	Head = 0;
+}
+
+void FLocomotionFlightRecorder::Reset()
+{
+	Records.Empty();
+	Head = 0;
+}
+
+bool FLocomotionFlightRecorder::SaveToFile(const FString& Filename) const
+{
+	const int32 NumRecords = Num();
+
+	FLocomotionFlightFileHeader Header;
+	Header.NumRecords = NumRecords;
+
+	TArray<uint8> Bytes;
+	Bytes.SetNumUninitialized(sizeof(Header) + NumRecords * sizeof(FLocomotionFlightRecord));
+	FMemory::Memcpy(Bytes.GetData(), &Header, sizeof(Header));
+
+	// Oldest first: once the ring has wrapped, the oldest record is the one Head writes next.
+	FLocomotionFlightRecord* Out = reinterpret_cast<FLocomotionFlightRecord*>(Bytes.GetData() + sizeof(Header));
+	const uint64 First = Head - NumRecords;
+	for (int32 Index = 0; Index < NumRecords; ++Index)
+	{
+		Out[Index] = Records[(First + Index) & (Capacity - 1)];
+	}
+
+	return FFileHelper::SaveArrayToFile(Bytes, *Filename);
+}
+
+bool FLocomotionFlightRecorder::ConvertToCSV(const FString& Filename, const FString& CSVFilename)
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Filename))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Could not read locomotion flight record %s"), *Filename);
+		return false;
+	}
+
+	FLocomotionFlightFileHeader Header;
+	if (Bytes.Num() < static_cast<int32>(sizeof(Header)))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s is not a locomotion flight record"), *Filename);
+		return false;
+	}
+	FMemory::Memcpy(&Header, Bytes.GetData(), sizeof(Header));
+
+	if (Header.Magic != FLocomotionFlightFileHeader::ExpectedMagic || Header.Version != FLocomotionFlightFileHeader::CurrentVersion
+		|| Header.RecordSize != sizeof(FLocomotionFlightRecord) || Bytes.Num() < static_cast<int64>(sizeof(Header) + Header.NumRecords * sizeof(FLocomotionFlightRecord)))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s is not a version %d locomotion flight record"), *Filename, FLocomotionFlightFileHeader::CurrentVersion);
+		return false;
+	}
+
+	const FLocomotionFlightRecord* Records = reinterpret_cast<const FLocomotionFlightRecord*>(Bytes.GetData() + sizeof(Header));
+
+	FString CSV = TEXT("Frame,Time,Speed,MaxWalkSpeed,AimYawRate,Gait,Stance,RotationMode,MovementAction,MovementState,ServerCorrection,ClientCorrection,ReducedRate,Interpolated\n");
+	CSV.Reserve(CSV.Len() + Header.NumRecords * 128);
+	for (uint32 Index = 0; Index < Header.NumRecords; ++Index)
+	{
+		const FLocomotionFlightRecord& Record = Records[Index];
+		const FLocomotionStateWord State = FLocomotionStateWord::Unpack(Record.State);
+		const ELocomotionFlightFlags Flags = static_cast<ELocomotionFlightFlags>(Record.Flags);
+
+		CSV += FString::Printf(TEXT("%u,%.4f,%u,%u,%d,%s,%s,%s,%s,%s,%d,%d,%d,%d\n"),
+		                       Record.FrameNumber, Record.Time, Record.Speed, Record.MaxWalkSpeed, Record.AimYawRate,
+		                       *EnumName(State.Gait), *EnumName(State.Stance), *EnumName(State.RotationMode),
+		                       *EnumName(State.MovementAction), *EnumName(State.MovementState),
+		                       EnumHasAnyFlags(Flags, ELocomotionFlightFlags::ServerCorrection) ? 1 : 0,
+		                       EnumHasAnyFlags(Flags, ELocomotionFlightFlags::ClientCorrection) ? 1 : 0,
+		                       EnumHasAnyFlags(Flags, ELocomotionFlightFlags::ReducedRate) ? 1 : 0,
+		                       EnumHasAnyFlags(Flags, ELocomotionFlightFlags::Interpolated) ? 1 : 0);
+	}
+
+	return FFileHelper::SaveStringToFile(CSV, *CSVFilename);
+}
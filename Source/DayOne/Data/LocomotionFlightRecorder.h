@@ -0,0 +1,74 @@
+#pragma once
+#include "CoreMinimal.h"
+
+enum class ELocomotionFlightFlags : uint8
+{
+	None = 0,
+	// The server found an error in the client move and sent a correction.
+	ServerCorrection = 1 << 0,
+	// The client applied a correction from the server.
+	ClientCorrection = 1 << 1,
+	// The character was at the reduced locomotion rate.
+	ReducedRate = 1 << 2,
+	// The locomotion update was skipped this tick, the rotation was only interpolated.
+	Interpolated = 1 << 3,
+};
+ENUM_CLASS_FLAGS(ELocomotionFlightFlags);
+
+// One tick of locomotion, packed into 16 bytes.
+struct FLocomotionFlightRecord
+{
+	// Low bits of GFrameCounter.
+	uint32 FrameNumber;
+	// World time, seconds.
+	float Time;
+	// cm/s
+	uint16 Speed;
+	// cm/s
+	uint16 MaxWalkSpeed;
+	// deg/s, clamped to the int16 range.
+	int16 AimYawRate;
+	// Gait, stance, rotation mode, movement action and in air, see FLocomotionStateWord.
+	uint8 State;
+	// ELocomotionFlightFlags
+	uint8 Flags;
+};
+static_assert(sizeof(FLocomotionFlightRecord) == 16, "FLocomotionFlightRecord is written to files as is");
+
+/**
+ * Keeps the last Capacity ticks of locomotion of one character, to investigate rubber-banding and gait flicker after the fact.
+ * Recording is a copy into a ring, dumping writes the records oldest first behind a small header.
+ * Files are converted to CSV with DayOne.Locomotion.FlightRecorder.ToCSV.
+ */
+class DAYONE_API FLocomotionFlightRecorder
+{
+public:
+	// Power of two, about 8 seconds at 120 Hz.
+	static constexpr uint32 Capacity = 1024;
+	static constexpr TCHAR FileExtension[] = TEXT(".dlfr");
+
+	// Allocate the ring, records are dropped until then.
+	void Initialize();
+	void Reset();
+
+	bool IsRecording() const { return Records.Num() > 0; }
+
+	FORCEINLINE void Record(const FLocomotionFlightRecord& InRecord)
+	{
+		if (!IsRecording()) return;
+
+		Records[Head & (Capacity - 1)] = InRecord;
+		++Head;
+	}
+
+	int32 Num() const { return static_cast<int32>(FMath::Min<uint64>(Head, Records.Num())); }
+
+	// Write the records oldest first.
+	bool SaveToFile(const FString& Filename) const;
+
+	static bool ConvertToCSV(const FString& Filename, const FString& CSVFilename);
+
+private:
+	TArray<FLocomotionFlightRecord> Records;
+	uint64 Head = 0;
+};
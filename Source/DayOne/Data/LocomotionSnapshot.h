@@ -0,0 +1,44 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "CharacterState.h"
+
+// Everything the anim instance, the camera and gameplay code read from the locomotion of a character in one frame.
+// Published once per tick by ULocomotionComponent, after the locomotion update,
+// so readers never have to reach into live actor or movement component state.
+struct alignas(PLATFORM_CACHE_LINE_SIZE) FLocomotionSnapshot
+{
+	// Essential values
+	FVector Velocity = FVector::ZeroVector;
+	FVector PhysicalAcceleration = FVector::ZeroVector;
+	FVector MovementInput = FVector::ZeroVector;
+	FRotator AimingRotation = FRotator::ZeroRotator;
+	FRotator ActorRotation = FRotator::ZeroRotator;
+	FRotator LastUpdateRotation = FRotator::ZeroRotator;
+	float Speed = 0.0f;
+	float MovementInputAmount = 0.0f;
+	float AimYawRate = 0.0f;
+	float MaxAcceleration = 0.0f;
+	float MaxBrakingDeceleration = 0.0f;
+	float MaxSpeed = 0.0f;
+	bool bIsMoving = false;
+	bool bHasMovementInput = false;
+	bool bIsMovingOnGround = false;
+	// Far from every player, see ULocomotionSubsystem::UpdateSignificance.
+	bool bBeyondLODDistance = false;
+
+	// Capsule
+	FVector CapsuleLocation = FVector::ZeroVector;
+	float CapsuleRadius = 0.0f;
+	float CapsuleHalfHeight = 0.0f;
+
+	// Current states
+	EMovementState MovementState = EMovementState::MS_None;
+	EMovementState PrevMovementState = EMovementState::MS_None;
+	EMovementAction MovementAction = EMovementAction::MA_None;
+	ERotationMode RotationMode = ERotationMode::RM_Looking;
+	EGaitState Gait = EGaitState::GS_Walking;
+	EStanceState Stance = EStanceState::SS_Standing;
+
+	// GFrameCounter of the tick that published this snapshot.
+	uint64 FrameNumber = 0;
+};
@@ -0,0 +1,70 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "CharacterState.h"
+
+// The locomotion states the server derives, quantized into one byte for replication.
+// Bit layout: Gait [0-1], Stance [2], RotationMode [3-4], MovementAction [5-6], InAir [7].
+struct FLocomotionStateWord
+{
+	EGaitState Gait = EGaitState::GS_Walking;
+	EStanceState Stance = EStanceState::SS_Standing;
+	ERotationMode RotationMode = ERotationMode::RM_Looking;
+	EMovementAction MovementAction = EMovementAction::MA_None;
+	EMovementState MovementState = EMovementState::MS_Grounded;
+
+	uint8 Pack() const
+	{
+		return static_cast<uint8>((static_cast<uint8>(Gait) & 0x3)
+			| (static_cast<uint8>(Stance) & 0x1) << 2
+			| (static_cast<uint8>(RotationMode) & 0x3) << 3
+			| (static_cast<uint8>(MovementAction) & 0x3) << 5
+			| (MovementState == EMovementState::MS_InAir ? 1 : 0) << 7);
+	}
+
+	static FLocomotionStateWord Unpack(uint8 Word)
+	{
+		FLocomotionStateWord State;
+		State.Gait = static_cast<EGaitState>(Word & 0x3);
+		State.Stance = static_cast<EStanceState>((Word >> 2) & 0x1);
+		State.RotationMode = static_cast<ERotationMode>((Word >> 3) & 0x3);
+		State.MovementAction = static_cast<EMovementAction>((Word >> 5) & 0x3);
+		State.MovementState = ((Word >> 7) & 0x1) ? EMovementState::MS_InAir : EMovementState::MS_Grounded;
+		return State;
+	}
+};
+
+static_assert(static_cast<uint8>(EGaitState::GS_MAX) <= 4, "Gait no longer fits in 2 bits of FLocomotionStateWord");
+static_assert(static_cast<uint8>(EStanceState::SS_MAX) <= 2, "Stance no longer fits in 1 bit of FLocomotionStateWord");
+static_assert(static_cast<uint8>(ERotationMode::RM_MAX) <= 4, "RotationMode no longer fits in 2 bits of FLocomotionStateWord");
+static_assert(static_cast<uint8>(EMovementAction::MA_MAX) <= 4, "MovementAction no longer fits in 2 bits of FLocomotionStateWord");
+
+// The locomotion input of the owning client, quantized into one byte for every saved move.
+// Bit layout: DesiredGait [0-1], DesiredStance [2], DesiredRotationMode [3-4], WantsToAim [5], FullMovementInput [6].
+struct FLocomotionInputWord
+{
+	EGaitState DesiredGait = EGaitState::GS_Running;
+	EStanceState DesiredStance = EStanceState::SS_Standing;
+	ERotationMode DesiredRotationMode = ERotationMode::RM_Looking;
+	bool bWantsToAim = false;
+	bool bFullMovementInput = false;
+
+	uint8 Pack() const
+	{
+		return static_cast<uint8>((static_cast<uint8>(DesiredGait) & 0x3)
+			| (static_cast<uint8>(DesiredStance) & 0x1) << 2
+			| (static_cast<uint8>(DesiredRotationMode) & 0x3) << 3
+			| (bWantsToAim ? 1 : 0) << 5
+			| (bFullMovementInput ? 1 : 0) << 6);
+	}
+
+	static FLocomotionInputWord Unpack(uint8 Word)
+	{
+		FLocomotionInputWord Input;
+		Input.DesiredGait = static_cast<EGaitState>(Word & 0x3);
+		Input.DesiredStance = static_cast<EStanceState>((Word >> 2) & 0x1);
+		Input.DesiredRotationMode = static_cast<ERotationMode>((Word >> 3) & 0x3);
+		Input.bWantsToAim = ((Word >> 5) & 0x1) != 0;
+		Input.bFullMovementInput = ((Word >> 6) & 0x1) != 0;
+		return Input;
+	}
+};
@@ -0,0 +1,43 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "BakedCurve.h"
+#include "CameraModel.h"
+#include "CharacterState.h"
+#include "MovementModel.h"
+
+// The settings of one movement model entry, with their curves baked for the hot path.
+// Only the baked data is kept, the authoring curves stay referenced by the DataTable rows.
+struct FMovementModelEntry
+{
+	float WalkSpeed = 0.0f;
+	float RunSpeed = 0.0f;
+	float SprintSpeed = 0.0f;
+	TSharedPtr<const FBakedCurveVector> BakedMovementCurve;
+	TSharedPtr<const FBakedCurveFloat> BakedRotationRateCurve;
+};
+
+// The movement model DataTable flattened into a fixed array indexed by [MovementModel][RotationMode][Stance].
+// Built once per DataTable by UModelTableSubsystem and shared by every character,
+// readers keep references into it instead of copying rows every tick.
+struct FMovementModelTable
+{
+	FMovementModelEntry Settings[static_cast<int32>(EMovementModel::MM_MAX)][static_cast<int32>(ERotationMode::RM_MAX)][static_cast<int32>(EStanceState::SS_MAX)];
+
+	FORCEINLINE const FMovementModelEntry& Get(EMovementModel MovementModel, ERotationMode RotationMode, EStanceState Stance) const
+	{
+		check(MovementModel < EMovementModel::MM_MAX && RotationMode < ERotationMode::RM_MAX && Stance < EStanceState::SS_MAX);
+		return Settings[static_cast<int32>(MovementModel)][static_cast<int32>(RotationMode)][static_cast<int32>(Stance)];
+	}
+};
+
+// The camera model DataTable flattened into a fixed array indexed by [Stance][Gait].
+struct FCameraModelTable
+{
+	FCameraSettings Settings[static_cast<int32>(EStanceState::SS_MAX)][static_cast<int32>(EGaitState::GS_MAX)];
+
+	FORCEINLINE const FCameraSettings& Get(EStanceState Stance, EGaitState Gait) const
+	{
+		check(Stance < EStanceState::SS_MAX && Gait < EGaitState::GS_MAX);
+		return Settings[static_cast<int32>(Stance)][static_cast<int32>(Gait)];
+	}
+};
@@ -0,0 +1,415 @@
+#include "MotionMatchingDatabase.h"
+
+#include "Animation/AnimSequence.h"
+#include "Math/RandomStream.h"
+
+#if WITH_EDITOR
+#include "Animation/AnimationPoseData.h"
+#include "Animation/AttributesRuntime.h"
+#include "BonePose.h"
+#endif
+
+namespace MotionMatchingFeatures
+{
+	static constexpr int32 NumRegisters = Num / 4;
+	// Poses compared between two checks of the search budget.
+	static constexpr int32 PosesPerSlice = 64;
+
+#if WITH_EDITOR
+	// Bones sampled for the pose features.
+	enum EPoseBone
+	{
+		LeftFoot,
+		RightFoot,
+		Pelvis,
+		NumPoseBones
+	};
+
+	// Root transform DeltaTime after Time, relative to the root at Time.
+	static FTransform GetRootDelta(const FMotionMatchingSequence& Entry, float Time, float DeltaTime)
+	{
+		const UAnimSequence* Sequence = Entry.Sequence;
+		// Past the end of a sequence that does not loop, the character has stopped there.
+		if (!Entry.bLoop)
+		{
+			DeltaTime = FMath::Min(DeltaTime, Sequence->GetPlayLength() - Time);
+		}
+		if (Sequence->HasRootMotion())
+		{
+			return Sequence->ExtractRootMotion(Time, DeltaTime, Entry.bLoop);
+		}
+
+		// In place: integrate the velocity and yaw rate it is authored for.
+		const float StepTime = 1.0f / 60.0f;
+		FVector Location = FVector::ZeroVector;
+		float Yaw = 0.0f;
+		for (float Remaining = DeltaTime; Remaining > 0.0f; Remaining -= StepTime)
+		{
+			const float Step = FMath::Min(Remaining, StepTime);
+			Location += FRotator(0.0f, Yaw + 0.5f * Entry.InPlaceYawRate * Step, 0.0f).RotateVector(Entry.InPlaceVelocity) * Step;
+			Yaw += Entry.InPlaceYawRate * Step;
+		}
+		return FTransform(FRotator(0.0f, Yaw, 0.0f), Location);
+	}
+
+	// Component space location of the pose bones at Time.
+	static void SampleBoneLocations(const UAnimSequence* Sequence, const FBoneContainer& BoneContainer,
+	                                const FCompactPoseBoneIndex (&BoneIndices)[NumPoseBones], float Time, FVector (&OutLocations)[NumPoseBones])
+	{
+		FMemMark Mark(FMemStack::Get());
+		FCompactPose Pose;
+		Pose.SetBoneContainer(&BoneContainer);
+		FBlendedCurve Curve;
+		Curve.InitFrom(BoneContainer);
+		UE::Anim::FStackAttributeContainer Attributes;
+		FAnimationPoseData PoseData(Pose, Curve, Attributes);
+		Sequence->GetBonePose(PoseData, FAnimExtractContext(Time));
+
+		FCSPose<FCompactPose> ComponentSpacePose;
+		ComponentSpacePose.InitPose(Pose);
+		for (int32 Bone = 0; Bone < NumPoseBones; ++Bone)
+		{
+			OutLocations[Bone] = ComponentSpacePose.GetComponentSpaceTransform(BoneIndices[Bone]).GetLocation();
+		}
+	}
+#endif
+}
+
+int32 UMotionMatchingDatabase::FindPose(int32 SequenceIndex, float Time) const
+{
+	const FMotionMatchingSequence& Entry = Sequences[SequenceIndex];
+	if (Entry.NumPoses == 0)
+	{
+		return INDEX_NONE;
+	}
+	int32 Sample = FMath::RoundToInt(Time * SampleRate);
+	Sample = Entry.bLoop ? Sample % Entry.NumPoses : FMath::Clamp(Sample, 0, Entry.NumPoses - 1);
+	return Entry.FirstPose + Sample;
+}
+
+void UMotionMatchingDatabase::GetPoseFeatures(int32 Pose, float* OutFeatures) const
+{
+	using namespace MotionMatchingFeatures;
+
+	const uint8* PoseFeatures = Features.GetData() + Pose * Num;
+	for (int32 Feature = 0; Feature < Num; ++Feature)
+	{
+		OutFeatures[Feature] = FeatureOffsets[Feature] + PoseFeatures[Feature] * FeatureScales[Feature];
+	}
+}
+
+void UMotionMatchingDatabase::Quantize(const float* InFeatures, FMotionMatchingQuery& OutQuery) const
+{
+	using namespace MotionMatchingFeatures;
+
+	for (int32 Feature = 0; Feature < Num; ++Feature)
+	{
+		// Not clamped to the byte range: a query outside the database still ranks the poses by distance.
+		OutQuery.Values[Feature] = Feature < NumUsed && FeatureScales[Feature] > 0.0f
+			? (InFeatures[Feature] - FeatureOffsets[Feature]) / FeatureScales[Feature]
+			: 0.0f;
+	}
+}
+
+float UMotionMatchingDatabase::ComputeCost(const FMotionMatchingQuery& Query, int32 Pose) const
+{
+	using namespace MotionMatchingFeatures;
+
+	const uint8* PoseFeatures = Features.GetData() + Pose * Num;
+	float Cost = 0.0f;
+	for (int32 Feature = 0; Feature < Num; ++Feature)
+	{
+		Cost += FMath::Square(PoseFeatures[Feature] - Query.Values[Feature]) * FeatureWeights[Feature];
+	}
+	return Cost;
+}
+
+void UMotionMatchingDatabase::BeginSearch(const FMotionMatchingQuery& Query, FMotionMatchingSearchState& State) const
+{
+	State.Query = Query;
+	State.NextPose = 0;
+	State.BestPose = INDEX_NONE;
+	State.BestCost = MAX_flt;
+}
+
+bool UMotionMatchingDatabase::ContinueSearch(FMotionMatchingSearchState& State, uint64 BudgetCycles) const
+{
+	using namespace MotionMatchingFeatures;
+
+	if (!State.IsRunning())
+	{
+		return true;
+	}
+
+	// At least one slice per call, so a search always ends.
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	const int32 NumPoses = GetNumPoses();
+	while (State.NextPose < NumPoses)
+	{
+		const int32 EndPose = FMath::Min(State.NextPose + PosesPerSlice, NumPoses);
+		const int32 Pose = SearchRange(State.Query, State.NextPose, EndPose, State.BestCost);
+		if (Pose != INDEX_NONE)
+		{
+			State.BestPose = Pose;
+		}
+		State.NextPose = EndPose;
+		if (FPlatformTime::Cycles64() - StartCycles >= BudgetCycles)
+		{
+			break;
+		}
+	}
+
+	if (State.NextPose < NumPoses)
+	{
+		return false;
+	}
+	State.NextPose = INDEX_NONE;
+	return true;
+}
+
+int32 UMotionMatchingDatabase::SearchRange(const FMotionMatchingQuery& Query, int32 FirstPose, int32 EndPose, float& InOutBestCost) const
+{
+	using namespace MotionMatchingFeatures;
+
+	VectorRegister4Float QueryValues[NumRegisters];
+	VectorRegister4Float Weights[NumRegisters];
+	for (int32 Register = 0; Register < NumRegisters; ++Register)
+	{
+		QueryValues[Register] = VectorLoadAligned(Query.Values + Register * 4);
+		Weights[Register] = VectorLoad(FeatureWeights.GetData() + Register * 4);
+	}
+
+	int32 BestPose = INDEX_NONE;
+	float BestCost = InOutBestCost;
+	const uint8* PoseFeatures = Features.GetData() + FirstPose * Num;
+	for (int32 Pose = FirstPose; Pose < EndPose; ++Pose, PoseFeatures += Num)
+	{
+		// Four quantized features per load, widened to floats.
+		VectorRegister4Float Cost = VectorZeroFloat();
+		for (int32 Register = 0; Register < NumRegisters; ++Register)
+		{
+			const VectorRegister4Float Difference = VectorSubtract(VectorLoadByte4(PoseFeatures + Register * 4), QueryValues[Register]);
+			Cost = VectorMultiplyAdd(VectorMultiply(Difference, Difference), Weights[Register], Cost);
+		}
+		const float PoseCost = VectorGetComponent(VectorDot4(Cost, VectorOneFloat()), 0);
+		if (PoseCost < BestCost)
+		{
+			BestCost = PoseCost;
+			BestPose = Pose;
+		}
+	}
+
+	InOutBestCost = BestCost;
+	return BestPose;
+}
+
+int32 UMotionMatchingDatabase::SearchRangeScalar(const FMotionMatchingQuery& Query, int32 FirstPose, int32 EndPose, float& InOutBestCost) const
+{
+	int32 BestPose = INDEX_NONE;
+	for (int32 Pose = FirstPose; Pose < EndPose; ++Pose)
+	{
+		const float PoseCost = ComputeCost(Query, Pose);
+		if (PoseCost < InOutBestCost)
+		{
+			InOutBestCost = PoseCost;
+			BestPose = Pose;
+		}
+	}
+	return BestPose;
+}
+
+void UMotionMatchingDatabase::SetFeatures(const TArray<float>& PoseFeatures)
+{
+	using namespace MotionMatchingFeatures;
+
+	const int32 NumPoses = PoseFeatures.Num() / Num;
+	Features.SetNumZeroed(NumPoses * Num);
+	FeatureOffsets.Init(0.0f, Num);
+	FeatureScales.Init(0.0f, Num);
+	FeatureWeights.Init(0.0f, Num);
+	if (NumPoses == 0)
+	{
+		return;
+	}
+
+	// Quantize every feature over its range in the database, and measure its variance.
+	float Variances[Num] = {};
+	for (int32 Feature = 0; Feature < NumUsed; ++Feature)
+	{
+		float Min = MAX_flt;
+		float Max = -MAX_flt;
+		double Sum = 0.0;
+		double SquaredSum = 0.0;
+		for (int32 Pose = 0; Pose < NumPoses; ++Pose)
+		{
+			const float Value = PoseFeatures[Pose * Num + Feature];
+			Min = FMath::Min(Min, Value);
+			Max = FMath::Max(Max, Value);
+			Sum += Value;
+			SquaredSum += Value * Value;
+		}
+		const double Mean = Sum / NumPoses;
+		Variances[Feature] = static_cast<float>(FMath::Max(SquaredSum / NumPoses - Mean * Mean, 0.0));
+
+		const float Scale = (Max - Min) / 255.0f;
+		FeatureOffsets[Feature] = Min;
+		FeatureScales[Feature] = Scale;
+		for (int32 Pose = 0; Pose < NumPoses; ++Pose)
+		{
+			const float Value = PoseFeatures[Pose * Num + Feature];
+			Features[Pose * Num + Feature] = Scale > 0.0f ? static_cast<uint8>(FMath::Clamp(FMath::RoundToInt((Value - Min) / Scale), 0, 255)) : 0;
+		}
+	}
+
+	// Every group is normalized by its mean variance, so its weight does not depend on its units.
+	// The search compares quantized features, the squared scale of every feature is folded in its weight.
+	struct FFeatureGroup
+	{
+		int32 First;
+		int32 Num;
+		float Weight;
+	};
+	const FFeatureGroup Groups[] =
+	{
+		{ TrajectoryPosition, 2 * NumTrajectoryPoints, TrajectoryPositionWeight },
+		{ TrajectoryFacing, 2 * NumTrajectoryPoints, TrajectoryFacingWeight },
+		{ FootPosition, 6, FootPositionWeight },
+		{ FootVelocity, 6, FootVelocityWeight },
+		{ PelvisVelocity, 3, PelvisVelocityWeight },
+	};
+	for (const FFeatureGroup& Group : Groups)
+	{
+		float MeanVariance = 0.0f;
+		for (int32 Feature = Group.First; Feature < Group.First + Group.Num; ++Feature)
+		{
+			MeanVariance += Variances[Feature] / Group.Num;
+		}
+		for (int32 Feature = Group.First; Feature < Group.First + Group.Num; ++Feature)
+		{
+			FeatureWeights[Feature] = Group.Weight / FMath::Max(MeanVariance, SMALL_NUMBER) * FMath::Square(FeatureScales[Feature]);
+		}
+	}
+}
+
+#if WITH_EDITOR
+void UMotionMatchingDatabase::BuildDatabase()
+{
+	using namespace MotionMatchingFeatures;
+
+	TArray<float> PoseFeatures;
+	PoseSequences.Reset();
+	PoseTimes.Reset();
+	const float SampleInterval = 1.0f / SampleRate;
+
+	for (int32 SequenceIndex = 0; SequenceIndex < Sequences.Num(); ++SequenceIndex)
+	{
+		FMotionMatchingSequence& Entry = Sequences[SequenceIndex];
+		Entry.FirstPose = PoseTimes.Num();
+		Entry.NumPoses = 0;
+
+		const UAnimSequence* Sequence = Entry.Sequence;
+		USkeleton* Skeleton = Sequence ? Sequence->GetSkeleton() : nullptr;
+		if (!Skeleton)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("UMotionMatchingDatabase: %s, sequence %d has no animation or skeleton"), *GetName(), SequenceIndex);
+			continue;
+		}
+
+		// Every bone, so the component space transforms of the pose bones are complete.
+		const FReferenceSkeleton& ReferenceSkeleton = Skeleton->GetReferenceSkeleton();
+		TArray<FBoneIndexType> RequiredBones;
+		for (int32 BoneIndex = 0; BoneIndex < ReferenceSkeleton.GetNum(); ++BoneIndex)
+		{
+			RequiredBones.Add(static_cast<FBoneIndexType>(BoneIndex));
+		}
+		const FBoneContainer BoneContainer(RequiredBones, FCurveEvaluationOption(false), *Skeleton);
+
+		const FName BoneNames[NumPoseBones] = { LeftFootBone, RightFootBone, PelvisBone };
+		FCompactPoseBoneIndex BoneIndices[NumPoseBones] = { FCompactPoseBoneIndex(INDEX_NONE), FCompactPoseBoneIndex(INDEX_NONE), FCompactPoseBoneIndex(INDEX_NONE) };
+		bool bHasBones = true;
+		for (int32 Bone = 0; Bone < NumPoseBones; ++Bone)
+		{
+			const int32 SkeletonIndex = ReferenceSkeleton.FindBoneIndex(BoneNames[Bone]);
+			BoneIndices[Bone] = SkeletonIndex != INDEX_NONE ? BoneContainer.GetCompactPoseIndexFromSkeletonIndex(SkeletonIndex) : FCompactPoseBoneIndex(INDEX_NONE);
+			bHasBones &= BoneIndices[Bone].IsValid();
+		}
+		if (!bHasBones)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("UMotionMatchingDatabase: %s, %s misses a foot or pelvis bone"), *GetName(), *Sequence->GetName());
+			continue;
+		}
+
+		// A looping sequence's last frame is its first one.
+		const float Length = Sequence->GetPlayLength();
+		const int32 NumSamples = FMath::Max(FMath::FloorToInt(Length * SampleRate) + (Entry.bLoop ? 0 : 1), 1);
+		for (int32 Sample = 0; Sample < NumSamples; ++Sample)
+		{
+			const float Time = FMath::Min(Sample * SampleInterval, Length);
+			const int32 Offset = PoseFeatures.AddZeroed(Num);
+			float* Out = PoseFeatures.GetData() + Offset;
+
+			for (int32 Point = 0; Point < NumTrajectoryPoints; ++Point)
+			{
+				const FTransform Delta = GetRootDelta(Entry, Time, TrajectoryTimes[Point]);
+				const FVector Facing = Delta.GetRotation().RotateVector(ForwardAxis);
+				Out[TrajectoryPosition + 2 * Point] = Delta.GetLocation().X;
+				Out[TrajectoryPosition + 2 * Point + 1] = Delta.GetLocation().Y;
+				Out[TrajectoryFacing + 2 * Point] = Facing.X;
+				Out[TrajectoryFacing + 2 * Point + 1] = Facing.Y;
+			}
+
+			// Velocities by backward difference, forward at the start of a sequence that does not loop.
+			const bool bBackward = Entry.bLoop || Time >= SampleInterval;
+			float OtherTime = bBackward ? Time - SampleInterval : Time + SampleInterval;
+			if (Entry.bLoop && OtherTime < 0.0f)
+			{
+				OtherTime += Length;
+			}
+			FVector Locations[NumPoseBones];
+			FVector OtherLocations[NumPoseBones];
+			SampleBoneLocations(Sequence, BoneContainer, BoneIndices, Time, Locations);
+			SampleBoneLocations(Sequence, BoneContainer, BoneIndices, FMath::Clamp(OtherTime, 0.0f, Length), OtherLocations);
+			const float VelocityScale = (bBackward ? 1.0f : -1.0f) / SampleInterval;
+			for (int32 Axis = 0; Axis < 3; ++Axis)
+			{
+				Out[FootPosition + Axis] = Locations[LeftFoot][Axis];
+				Out[FootPosition + 3 + Axis] = Locations[RightFoot][Axis];
+				Out[FootVelocity + Axis] = (Locations[LeftFoot][Axis] - OtherLocations[LeftFoot][Axis]) * VelocityScale;
+				Out[FootVelocity + 3 + Axis] = (Locations[RightFoot][Axis] - OtherLocations[RightFoot][Axis]) * VelocityScale;
+				Out[PelvisVelocity + Axis] = (Locations[Pelvis][Axis] - OtherLocations[Pelvis][Axis]) * VelocityScale;
+			}
+
+			PoseSequences.Add(SequenceIndex);
+			PoseTimes.Add(Time);
+			++Entry.NumPoses;
+		}
+	}
+
+	SetFeatures(PoseFeatures);
+	MarkPackageDirty();
+	UE_LOG(LogTemp, Log, TEXT("UMotionMatchingDatabase: %s, %d poses of %d sequences, %d feature bytes"),
+	       *GetName(), GetNumPoses(), Sequences.Num(), Features.Num());
+}
+#endif
+
+#if !UE_BUILD_SHIPPING
+void UMotionMatchingDatabase::BuildRandom(int32 NumPoses, FRandomStream& Random)
+{
+	using namespace MotionMatchingFeatures;
+
+	TArray<float> PoseFeatures;
+	PoseFeatures.SetNumZeroed(NumPoses * Num);
+	PoseSequences.Reset(NumPoses);
+	PoseTimes.Reset(NumPoses);
+	for (int32 Pose = 0; Pose < NumPoses; ++Pose)
+	{
+		for (int32 Feature = 0; Feature < NumUsed; ++Feature)
+		{
+			PoseFeatures[Pose * Num + Feature] = Random.FRandRange(-100.0f, 100.0f);
+		}
+		PoseSequences.Add(INDEX_NONE);
+		PoseTimes.Add(Pose / SampleRate);
+	}
+	SetFeatures(PoseFeatures);
+}
+#endif
@@ -0,0 +1,188 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "MotionMatchingDatabase.generated.h"
+
+class UAnimSequence;
+struct FRandomStream;
+
+// Feature vector layout of a pose, all in the mesh component space.
+namespace MotionMatchingFeatures
+{
+	// Future times of the trajectory points, in seconds.
+	static constexpr float TrajectoryTimes[] = { 0.33f, 0.66f, 1.0f };
+	static constexpr int32 NumTrajectoryPoints = UE_ARRAY_COUNT(TrajectoryTimes);
+
+	// Trajectory positions (XY), trajectory facing directions (XY), then the pose:
+	// left and right foot positions, left and right foot velocities, pelvis velocity.
+	static constexpr int32 TrajectoryPosition = 0;
+	static constexpr int32 TrajectoryFacing = TrajectoryPosition + 2 * NumTrajectoryPoints;
+	static constexpr int32 FootPosition = TrajectoryFacing + 2 * NumTrajectoryPoints;
+	static constexpr int32 FootVelocity = FootPosition + 6;
+	static constexpr int32 PelvisVelocity = FootVelocity + 6;
+	static constexpr int32 NumUsed = PelvisVelocity + 3;
+	// Padded to whole SIMD registers of four features, the padding has no weight.
+	static constexpr int32 Num = Align(NumUsed, 4);
+}
+
+// A query in the quantized feature space of a database, see UMotionMatchingDatabase::Quantize.
+struct alignas(16) FMotionMatchingQuery
+{
+	float Values[MotionMatchingFeatures::Num];
+};
+
+// Progress of one character's search, which may be spread over several frames to stay in its budget.
+struct FMotionMatchingSearchState
+{
+	FMotionMatchingQuery Query;
+	// Next pose to compare, INDEX_NONE when no search is running.
+	int32 NextPose = INDEX_NONE;
+	int32 BestPose = INDEX_NONE;
+	float BestCost = MAX_flt;
+
+	FORCEINLINE bool IsRunning() const
+	{
+		return NextPose != INDEX_NONE;
+	}
+};
+
+USTRUCT()
+struct FMotionMatchingSequence
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category="MotionMatching")
+	UAnimSequence* Sequence = nullptr;
+
+	UPROPERTY(EditAnywhere, Category="MotionMatching")
+	bool bLoop = false;
+
+	// Root velocity (component space, cm/s) and yaw rate (deg/s) the sequence is authored for, if it plays in place,
+	// like the ALS cycles. Ignored for sequences with root motion.
+	UPROPERTY(EditAnywhere, Category="MotionMatching")
+	FVector InPlaceVelocity = FVector::ZeroVector;
+	UPROPERTY(EditAnywhere, Category="MotionMatching")
+	float InPlaceYawRate = 0.0f;
+
+	// Poses of the sequence in the database, set by the build.
+	UPROPERTY(VisibleAnywhere, Category="MotionMatching")
+	int32 FirstPose = 0;
+	UPROPERTY(VisibleAnywhere, Category="MotionMatching")
+	int32 NumPoses = 0;
+};
+
+/**
+ * Pose database of the motion matching locomotion mode (DayOne.Anim.MotionMatching).
+ * Built offline in the editor from the locomotion sequences: every sequence is sampled at SampleRate,
+ * and every sample stores the MotionMatchingFeatures of its pose quantized to a byte per feature.
+ * At runtime a query is searched by brute force over the whole database, four features per SIMD instruction,
+ * in slices that keep every character within its time budget.
+ */
+UCLASS(BlueprintType)
+class DAYONE_API UMotionMatchingDatabase : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	FORCEINLINE bool IsBuilt() const
+	{
+		return PoseTimes.Num() > 0 && Features.Num() == PoseTimes.Num() * MotionMatchingFeatures::Num;
+	}
+	FORCEINLINE int32 GetNumPoses() const
+	{
+		return PoseTimes.Num();
+	}
+	FORCEINLINE const FMotionMatchingSequence& GetSequence(int32 SequenceIndex) const
+	{
+		return Sequences[SequenceIndex];
+	}
+	FORCEINLINE int32 GetPoseSequence(int32 Pose) const
+	{
+		return PoseSequences[Pose];
+	}
+	FORCEINLINE float GetPoseTime(int32 Pose) const
+	{
+		return PoseTimes[Pose];
+	}
+
+	// Pose of the sequence sampled nearest to Time.
+	int32 FindPose(int32 SequenceIndex, float Time) const;
+	// Dequantized features of Pose.
+	void GetPoseFeatures(int32 Pose, float* OutFeatures) const;
+	// Map Features (MotionMatchingFeatures layout) into the quantized space the search compares in.
+	void Quantize(const float* InFeatures, FMotionMatchingQuery& OutQuery) const;
+	// Weighted squared distance between the query and Pose.
+	float ComputeCost(const FMotionMatchingQuery& Query, int32 Pose) const;
+
+	// Begin a search for Query, replacing any running one.
+	void BeginSearch(const FMotionMatchingQuery& Query, FMotionMatchingSearchState& State) const;
+	// Continue State's search until it ends or BudgetCycles have passed. True when it has ended, the result is in State.
+	bool ContinueSearch(FMotionMatchingSearchState& State, uint64 BudgetCycles) const;
+
+	// Best pose in [FirstPose, EndPose) costing less than InOutBestCost, INDEX_NONE if none does.
+	int32 SearchRange(const FMotionMatchingQuery& Query, int32 FirstPose, int32 EndPose, float& InOutBestCost) const;
+	// The same without SIMD, to check SearchRange against.
+	int32 SearchRangeScalar(const FMotionMatchingQuery& Query, int32 FirstPose, int32 EndPose, float& InOutBestCost) const;
+
+#if WITH_EDITOR
+	// Sample the sequences and rebuild the features.
+	UFUNCTION(CallInEditor, Category="MotionMatching")
+	void BuildDatabase();
+#endif
+
+#if !UE_BUILD_SHIPPING
+	// Fill the database with NumPoses poses of random features, for the benchmark.
+	void BuildRandom(int32 NumPoses, FRandomStream& Random);
+#endif
+
+protected:
+	UPROPERTY(EditAnywhere, Category="MotionMatching")
+	TArray<FMotionMatchingSequence> Sequences;
+
+	// Poses per second of sequence.
+	UPROPERTY(EditAnywhere, Category="MotionMatching", meta=(ClampMin="1"))
+	float SampleRate = 30.0f;
+
+	// Forward direction of the character in the mesh component space, +Y for the UE mannequin.
+	UPROPERTY(EditAnywhere, Category="MotionMatching")
+	FVector ForwardAxis = FVector(0.0f, 1.0f, 0.0f);
+
+	UPROPERTY(EditAnywhere, Category="MotionMatching")
+	FName LeftFootBone = TEXT("foot_l");
+	UPROPERTY(EditAnywhere, Category="MotionMatching")
+	FName RightFootBone = TEXT("foot_r");
+	UPROPERTY(EditAnywhere, Category="MotionMatching")
+	FName PelvisBone = TEXT("pelvis");
+
+	// Weight of every feature group, each group is normalized by its variance over the database first.
+	UPROPERTY(EditAnywhere, Category="MotionMatching|Weights")
+	float TrajectoryPositionWeight = 1.0f;
+	UPROPERTY(EditAnywhere, Category="MotionMatching|Weights")
+	float TrajectoryFacingWeight = 1.0f;
+	UPROPERTY(EditAnywhere, Category="MotionMatching|Weights")
+	float FootPositionWeight = 1.0f;
+	UPROPERTY(EditAnywhere, Category="MotionMatching|Weights")
+	float FootVelocityWeight = 1.0f;
+	UPROPERTY(EditAnywhere, Category="MotionMatching|Weights")
+	float PelvisVelocityWeight = 1.0f;
+
+private:
+	// Quantize the features of every pose, NumPoses x MotionMatchingFeatures::Num floats, and set the weights.
+	void SetFeatures(const TArray<float>& PoseFeatures);
+
+	// Built data.
+	// NumPoses x MotionMatchingFeatures::Num bytes, a feature is FeatureOffsets + byte * FeatureScales.
+	UPROPERTY()
+	TArray<uint8> Features;
+	UPROPERTY()
+	TArray<float> FeatureOffsets;
+	UPROPERTY()
+	TArray<float> FeatureScales;
+	// Weight of every feature in the quantized space.
+	UPROPERTY()
+	TArray<float> FeatureWeights;
+	UPROPERTY()
+	TArray<int32> PoseSequences;
+	UPROPERTY()
+	TArray<float> PoseTimes;
+};
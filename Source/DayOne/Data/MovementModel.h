@@ -51,9 +51,4 @@ struct FMovementSettingsState : public FTableRowBase
 	// Character always move toward aiming direction.
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	FMovementSettingsStance Aiming;
-};
-
-struct FMovementData
-{
-	FMovementSettingsState* Normal;
 };
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include "TurnInPlaceTable.h"
+
+#include "Animation/AnimSequence.h"
+
+void FTurnInPlaceTable::Build(const FStanceAssets (&Assets)[static_cast<int32>(EStanceState::SS_MAX)], float InTurn180Threshold)
+{
+	check(IsInGameThread());
+	bResolved.store(false);
+	Turn180Threshold = InTurn180Threshold;
+
+	for (int32 Stance = 0; Stance < static_cast<int32>(EStanceState::SS_MAX); ++Stance)
+	{
+		for (int32 Turn = 0; Turn < static_cast<int32>(ETurnInPlaceTurn::Num); ++Turn)
+		{
+			const FTurnInPlaceAsset* Asset = Assets[Stance][Turn];
+			check(Asset);
+
+			FTurnInPlaceTableEntry& Entry = Entries[Stance][Turn];
+			Entry.Animation = nullptr;
+			Entry.SlotName = Asset->SlotName;
+			Entry.PlayRate = Asset->PlayRate;
+			Entry.AnimatedAngle = Asset->bScaleTurnAngle ? FMath::Abs(Asset->AnimatedAngle) : 0.0f;
+			EntryAssets[Stance][Turn] = Asset;
+		}
+	}
+}
+
+void FTurnInPlaceTable::GetAnimationPaths(TArray<FSoftObjectPath>& OutPaths) const
+{
+	for (const auto& StanceAssets : EntryAssets)
+	{
+		for (const FTurnInPlaceAsset* Asset : StanceAssets)
+		{
+			if (Asset && !Asset->Animation.IsNull())
+			{
+				OutPaths.AddUnique(Asset->Animation.ToSoftObjectPath());
+			}
+		}
+	}
+}
+
+void FTurnInPlaceTable::ResolveAnimations()
+{
+	check(IsInGameThread());
+
+	for (int32 Stance = 0; Stance < static_cast<int32>(EStanceState::SS_MAX); ++Stance)
+	{
+		for (int32 Turn = 0; Turn < static_cast<int32>(ETurnInPlaceTurn::Num); ++Turn)
+		{
+			const FTurnInPlaceAsset* Asset = EntryAssets[Stance][Turn];
+			Entries[Stance][Turn].Animation = Asset ? Asset->Animation.Get() : nullptr;
+		}
+	}
+
+	// Publishes the animations to the anim update threads.
+	bResolved.store(true, std::memory_order_release);
+}
+
+const FTurnInPlaceTableEntry* FTurnInPlaceTable::Find(EStanceState Stance, float TurnAngle) const
+{
+	if (!bResolved.load(std::memory_order_acquire) || Stance >= EStanceState::SS_MAX) return nullptr;
+
+	const bool bTurn180 = FMath::Abs(TurnAngle) >= Turn180Threshold;
+	const ETurnInPlaceTurn Turn = TurnAngle < 0.0f
+		                              ? (bTurn180 ? ETurnInPlaceTurn::L180 : ETurnInPlaceTurn::L90)
+		                              : (bTurn180 ? ETurnInPlaceTurn::R180 : ETurnInPlaceTurn::R90);
+	const FTurnInPlaceTableEntry& Entry = Entries[static_cast<int32>(Stance)][static_cast<int32>(Turn)];
+	return Entry.Animation ? &Entry : nullptr;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Engine/DataTable.h"
+#include "DayOne/Data/CharacterState.h"
+#include "TurnInPlaceTable.generated.h"
+
+class UAnimSequence;
+
+USTRUCT(BlueprintType)
+struct FTurnInPlaceAsset : public FTableRowBase
+{
+	GENERATED_BODY()
+
+	// Soft, so the anim blueprint does not load every turn. FTurnInPlaceTable preloads it.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TSoftObjectPtr<UAnimSequence> Animation;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float AnimatedAngle;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FName SlotName;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float PlayRate;
+	
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bScaleTurnAngle;
+};
+
+// The turn in place assets of one character, by stance and turn.
+enum class ETurnInPlaceTurn : uint8
+{
+	L90,
+	R90,
+	L180,
+	R180,
+	Num
+};
+
+// The turn to play for a stance and turn angle.
+struct FTurnInPlaceTableEntry
+{
+	// Null until the animations are loaded, or if the asset has none.
+	UAnimSequence* Animation = nullptr;
+	FName SlotName;
+	float PlayRate = 1.0f;
+	// Absolute animated angle, 0 if the asset does not scale the rotation by the turn angle.
+	float AnimatedAngle = 0.0f;
+
+	// Rotation scale of a turn of TurnAngle degrees: the turn angle over the animated angle (if allowed), and the play rate.
+	float GetRotationScale(float TurnAngle) const
+	{
+		return AnimatedAngle > 0.0f ? FMath::Abs(TurnAngle) / AnimatedAngle * PlayRate : PlayRate;
+	}
+};
+
+// Turn in place asset selection, resolved for every stance and turn, so choosing a turn is an array lookup.
+// The animations are async loaded up front, a turn never loads anything.
+struct DAYONE_API FTurnInPlaceTable
+{
+	using FStanceAssets = const FTurnInPlaceAsset* [static_cast<int32>(ETurnInPlaceTurn::Num)];
+
+	// Turns below InTurn180Threshold degrees pick the 90 degree assets. The assets must outlive the table.
+	void Build(const FStanceAssets (&Assets)[static_cast<int32>(EStanceState::SS_MAX)], float InTurn180Threshold);
+	// Every animation Build referenced, to load before ResolveAnimations.
+	void GetAnimationPaths(TArray<FSoftObjectPath>& OutPaths) const;
+	// Game thread, once the animations are loaded. Until then Find returns null.
+	void ResolveAnimations();
+
+	// Any thread. Null while loading, or if the asset has no animation.
+	const FTurnInPlaceTableEntry* Find(EStanceState Stance, float TurnAngle) const;
+
+private:
+	FTurnInPlaceTableEntry Entries[static_cast<int32>(EStanceState::SS_MAX)][static_cast<int32>(ETurnInPlaceTurn::Num)];
+	// The asset of each entry, for ResolveAnimations.
+	const FTurnInPlaceAsset* EntryAssets[static_cast<int32>(EStanceState::SS_MAX)][static_cast<int32>(ETurnInPlaceTurn::Num)] = {};
+	float Turn180Threshold = 180.0f;
+	std::atomic<bool> bResolved{false};
+};
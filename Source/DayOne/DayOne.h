@@ -3,4 +3,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Stats/Stats.h"
 
+// Performance counters of the DayOne gameplay systems, shown with "stat DayOne".
+DECLARE_STATS_GROUP(TEXT("DayOne"), STATGROUP_DayOne, STATCAT_Advanced);
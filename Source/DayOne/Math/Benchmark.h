@@ -0,0 +1,44 @@
+#pragma once
+#include "CoreMinimal.h"
+
+// Shared pieces of the DayOne benchmark console commands.
+namespace DayOneBenchmark
+{
+	// Seed of the random inputs, so runs of different builds measure the same inputs.
+	static constexpr int32 Seed = 0xD1;
+
+	// Measured results are folded into this, so the optimizer cannot drop the measured loops.
+	inline volatile double Sink = 0.0;
+
+	template <typename ValueType>
+	FORCEINLINE void Consume(ValueType Value)
+	{
+		Sink = Sink + static_cast<double>(Value);
+	}
+
+	// Wall time of one call of Body.
+	template <typename BodyType>
+	double Seconds(BodyType&& Body)
+	{
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		Body();
+		return FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+	}
+
+	// Time per element of Body, which processes Num elements, over Iterations calls after a warm up call.
+	template <typename BodyType>
+	double NanosecondsPerElement(int32 Num, int32 Iterations, BodyType&& Body)
+	{
+		// Warm up the caches and the branch predictors.
+		Body();
+
+		const double TotalSeconds = Seconds([&]()
+		{
+			for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+			{
+				Body();
+			}
+		});
+		return TotalSeconds * 1e9 / (static_cast<double>(Num) * Iterations);
+	}
+}
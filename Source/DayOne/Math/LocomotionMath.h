@@ -0,0 +1,446 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "DayOne/Data/CharacterState.h"
+
+// The pure math of locomotion and the locomotion anim graph.
+// Only depends on Core, so it can be called from any thread and measured and tested without a world,
+// see DayOne.Locomotion.BenchmarkMath and the DayOne.Locomotion.Math automation tests.
+// Batch variants process four characters per iteration in SIMD registers and the remainder with the scalar kernels,
+// their inputs and outputs are plain SoA arrays.
+namespace LocomotionMath
+{
+	FORCEINLINE float MapRangeClamped(float Value, float InMin, float InMax, float OutMin, float OutMax)
+	{
+		return FMath::GetMappedRangeValueClamped(FVector2f(InMin, InMax), FVector2f(OutMin, OutMax), Value);
+	}
+
+	FORCEINLINE VectorRegister4Float MapRangeClamped(const VectorRegister4Float& Value, const VectorRegister4Float& InMin, const VectorRegister4Float& InMax,
+	                                                 const VectorRegister4Float& OutMin, const VectorRegister4Float& OutMax)
+	{
+		const VectorRegister4Float Divisor = VectorSubtract(InMax, InMin);
+		// Like FMath::GetRangePct, a degenerate input range steps from 0 to 1 at InMax instead of dividing by zero.
+		const VectorRegister4Float DegenerateMask = VectorCompareLT(VectorAbs(Divisor), VectorSetFloat1(SMALL_NUMBER));
+		const VectorRegister4Float StepPct = VectorSelect(VectorCompareGE(Value, InMax), VectorOneFloat(), VectorZeroFloat());
+		const VectorRegister4Float Pct = VectorSelect(DegenerateMask, StepPct, VectorDivide(VectorSubtract(Value, InMin), Divisor));
+		const VectorRegister4Float ClampedPct = VectorMin(VectorMax(Pct, VectorZeroFloat()), VectorOneFloat());
+		return VectorMultiplyAdd(VectorSubtract(OutMax, OutMin), ClampedPct, OutMin);
+	}
+
+	/** Gait */
+
+	// Sprinting is only allowed with heavy input close to the control direction.
+	inline bool CanSprint(ERotationMode RotationMode, bool bHasMovementInput, float MovementInputAmount,
+	                      const FVector& MovementInput, const FRotator& ControlRotation)
+	{
+		if (!bHasMovementInput) return false;
+
+		if (RotationMode == ERotationMode::RM_Aiming) return false;
+
+		if (RotationMode == ERotationMode::RM_Looking)
+		{
+			// Try to find the angle of  player input direct and current player controller direct
+			// If player has heavy input and input direction between with controller direction almost the same, sprint.
+			const FRotator DeltaRotation = (MovementInput.ToOrientationRotator() - ControlRotation).GetNormalized();
+			return MovementInputAmount > 0.9f && FMath::Abs(DeltaRotation.Yaw) < 50.0f;
+		}
+
+		// The character turns toward its velocity, any direction of full input sprints.
+		return MovementInputAmount > 0.9f;
+	}
+
+	// The gait the character is allowed to move at in its stance and rotation mode.
+	inline EGaitState AllowedGait(EStanceState Stance, ERotationMode RotationMode, EGaitState DesiredGait, bool bCanSprint)
+	{
+		if (Stance == EStanceState::SS_Standing)
+		{
+			if (RotationMode == ERotationMode::RM_Looking || RotationMode == ERotationMode::RM_Velocity)
+			{
+				if (DesiredGait == EGaitState::GS_Sprinting)
+				{
+					return bCanSprint ? EGaitState::GS_Sprinting : EGaitState::GS_Running;
+				}
+				return DesiredGait;
+			}
+			if (RotationMode == ERotationMode::RM_Aiming)
+			{
+				return DesiredGait == EGaitState::GS_Walking ? EGaitState::GS_Walking : EGaitState::GS_Running;
+			}
+		}
+		else if (Stance == EStanceState::SS_Crouching)
+		{
+			return DesiredGait == EGaitState::GS_Walking ? EGaitState::GS_Walking : EGaitState::GS_Running;
+		}
+
+		return EGaitState::GS_MAX;
+	}
+
+	// The gait the character actually moves at, from its speed.
+	// Sprinting is only reported when it is allowed, so the character does not sprint while accelerating.
+	FORCEINLINE EGaitState ActualGait(EGaitState AllowedGait, float Speed, float WalkSpeed, float RunSpeed)
+	{
+		if (Speed >= RunSpeed + 10.0f)
+		{
+			return AllowedGait == EGaitState::GS_Sprinting ? EGaitState::GS_Sprinting : EGaitState::GS_Running;
+		}
+		return Speed >= WalkSpeed + 10.0f ? EGaitState::GS_Running : EGaitState::GS_Walking;
+	}
+
+	// Map the speed to the gait speeds: 0 stopped, 1 walking, 2 running, 3 sprinting.
+	FORCEINLINE float MappedSpeed(float Speed, float WalkSpeed, float RunSpeed, float SprintSpeed)
+	{
+		if (Speed > RunSpeed)
+		{
+			return MapRangeClamped(Speed, RunSpeed, SprintSpeed, 2.0f, 3.0f);
+		}
+		if (Speed > WalkSpeed)
+		{
+			return MapRangeClamped(Speed, WalkSpeed, RunSpeed, 1.0f, 2.0f);
+		}
+		return MapRangeClamped(Speed, 0.0f, WalkSpeed, 0.0f, 1.0f);
+	}
+
+	inline void MappedSpeedBatch(const float* RESTRICT Speed, const float* RESTRICT WalkSpeed, const float* RESTRICT RunSpeed,
+	                             const float* RESTRICT SprintSpeed, float* RESTRICT OutMappedSpeed, int32 Num)
+	{
+		int32 Index = 0;
+		for (; Index + 4 <= Num; Index += 4)
+		{
+			const VectorRegister4Float VSpeed = VectorLoad(Speed + Index);
+			const VectorRegister4Float VWalkSpeed = VectorLoad(WalkSpeed + Index);
+			const VectorRegister4Float VRunSpeed = VectorLoad(RunSpeed + Index);
+			const VectorRegister4Float VSprintSpeed = VectorLoad(SprintSpeed + Index);
+
+			const VectorRegister4Float Walk = MapRangeClamped(VSpeed, VectorZeroFloat(), VWalkSpeed, VectorZeroFloat(), VectorOneFloat());
+			const VectorRegister4Float Run = MapRangeClamped(VSpeed, VWalkSpeed, VRunSpeed, VectorOneFloat(), VectorSetFloat1(2.0f));
+			const VectorRegister4Float Sprint = MapRangeClamped(VSpeed, VRunSpeed, VSprintSpeed, VectorSetFloat1(2.0f), VectorSetFloat1(3.0f));
+
+			const VectorRegister4Float Result = VectorSelect(VectorCompareGT(VSpeed, VRunSpeed), Sprint,
+			                                                 VectorSelect(VectorCompareGT(VSpeed, VWalkSpeed), Run, Walk));
+			VectorStore(Result, OutMappedSpeed + Index);
+		}
+		for (; Index < Num; ++Index)
+		{
+			OutMappedSpeed[Index] = MappedSpeed(Speed[Index], WalkSpeed[Index], RunSpeed[Index], SprintSpeed[Index]);
+		}
+	}
+
+	/** Rotation */
+
+	// Scale the rotation rate curve value by the aim yaw rate, so the character turns faster while the camera turns fast.
+	FORCEINLINE float GroundedRotationRate(float RotationRateCurveValue, float AimYawRate)
+	{
+		return RotationRateCurveValue * MapRangeClamped(AimYawRate, 0.0f, 300.0f, 1.0f, 3.0f);
+	}
+
+	inline void GroundedRotationRateBatch(const float* RESTRICT RotationRateCurveValue, const float* RESTRICT AimYawRate,
+	                                      float* RESTRICT OutRotationRate, int32 Num)
+	{
+		int32 Index = 0;
+		for (; Index + 4 <= Num; Index += 4)
+		{
+			const VectorRegister4Float MappedAimYawRate = MapRangeClamped(VectorLoad(AimYawRate + Index), VectorZeroFloat(), VectorSetFloat1(300.0f),
+			                                                              VectorOneFloat(), VectorSetFloat1(3.0f));
+			VectorStore(VectorMultiply(VectorLoad(RotationRateCurveValue + Index), MappedAimYawRate), OutRotationRate + Index);
+		}
+		for (; Index < Num; ++Index)
+		{
+			OutRotationRate[Index] = GroundedRotationRate(RotationRateCurveValue[Index], AimYawRate[Index]);
+		}
+	}
+
+	// Interpolate the target rotation at a constant speed, then the actor rotation toward it.
+	FORCEINLINE FRotator SmoothedRotation(FRotator& InOutTargetRotation, const FRotator& Target, const FRotator& ActorRotation,
+	                                      float DeltaTime, float TargetInterpSpeed, float ActorInterpSpeed)
+	{
+		InOutTargetRotation = FMath::RInterpConstantTo(InOutTargetRotation, Target, DeltaTime, TargetInterpSpeed);
+
+		return FMath::RInterpTo(ActorRotation, InOutTargetRotation, DeltaTime, ActorInterpSpeed);
+	}
+
+	/** Anim graph */
+
+	// The velocity amount in each direction relative to the actor, normalized so that diagonals equal .5 for each direction.
+	// Returned as (F, B, L, R).
+	FORCEINLINE FVector4f VelocityBlend(const FVector& Velocity, const FRotator& ActorRotation)
+	{
+		const FVector RelativeVelocityDir = ActorRotation.UnrotateVector(Velocity.GetSafeNormal(0.1f));
+
+		// Map diagonals vector from 1.0 to 0.5
+		const float Sum = FMath::Abs(RelativeVelocityDir.X) + FMath::Abs(RelativeVelocityDir.Y) + FMath::Abs(RelativeVelocityDir.Z);
+		const float X = RelativeVelocityDir.X / Sum;
+		const float Y = RelativeVelocityDir.Y / Sum;
+
+		return FVector4f(FMath::Clamp(X, 0.0f, 1.0f), FMath::Abs(FMath::Clamp(X, -1.0f, 0.0f)),
+		                 FMath::Abs(FMath::Clamp(Y, -1.0f, 0.0f)), FMath::Clamp(Y, 0.0f, 1.0f));
+	}
+
+	// The acceleration relative to the actor, normalized to -1 at the max braking deceleration and 1 at the max acceleration.
+	FORCEINLINE FVector RelativeAccelerationAmount(const FVector& PhysicalAcceleration, const FVector& Velocity, const FRotator& ActorRotation,
+	                                               float MaxAcceleration, float MaxBrakingDeceleration)
+	{
+		const float MaxAmount = FVector::DotProduct(PhysicalAcceleration, Velocity) > 0.0f ? MaxAcceleration : MaxBrakingDeceleration;
+		return ActorRotation.UnrotateVector(PhysicalAcceleration.GetClampedToMaxSize(MaxAmount) / MaxAmount);
+	}
+
+	/** Anim parameter batch */
+
+	// The batch kernels below run in single precision against the double precision scalar kernels,
+	// and match them within this. They take the actor yaw only, characters with pitch or roll stay on the scalar kernels.
+	constexpr float AnimParameterBatchTolerance = 1e-4f;
+
+	// FRotator::NormalizeAxis of four angles, into (-180, 180].
+	FORCEINLINE VectorRegister4Float NormalizeAxis(const VectorRegister4Float& Angle)
+	{
+		const VectorRegister4Float FullTurn = VectorSetFloat1(360.0f);
+		const VectorRegister4Float Turns = VectorFloor(VectorMultiply(Angle, VectorSetFloat1(1.0f / 360.0f)));
+		const VectorRegister4Float Clamped = VectorSubtract(Angle, VectorMultiply(Turns, FullTurn));
+		return VectorSelect(VectorCompareGT(Clamped, VectorSetFloat1(180.0f)), VectorSubtract(Clamped, FullTurn), Clamped);
+	}
+
+	// FRotator(0, Yaw, 0).UnrotateVector of four (X, Y) vectors, Z is unchanged.
+	FORCEINLINE void UnrotateByYaw(const VectorRegister4Float& Yaw, VectorRegister4Float& InOutX, VectorRegister4Float& InOutY)
+	{
+		const VectorRegister4Float Radians = VectorMultiply(Yaw, VectorSetFloat1(UE_PI / 180.0f));
+		VectorRegister4Float Sin, Cos;
+		VectorSinCos(&Sin, &Cos, &Radians);
+
+		const VectorRegister4Float X = VectorMultiplyAdd(Cos, InOutX, VectorMultiply(Sin, InOutY));
+		InOutY = VectorSubtract(VectorMultiply(Cos, InOutY), VectorMultiply(Sin, InOutX));
+		InOutX = X;
+	}
+
+	// FMath::FInterpTo of four values.
+	FORCEINLINE VectorRegister4Float InterpTo(const VectorRegister4Float& Current, const VectorRegister4Float& Target,
+	                                          const VectorRegister4Float& DeltaTime, const VectorRegister4Float& InterpSpeed)
+	{
+		const VectorRegister4Float Distance = VectorSubtract(Target, Current);
+		const VectorRegister4Float Alpha = VectorMin(VectorMax(VectorMultiply(DeltaTime, InterpSpeed), VectorZeroFloat()), VectorOneFloat());
+		const VectorRegister4Float Result = VectorMultiplyAdd(Distance, Alpha, Current);
+		// Snap to the target without a speed, or when it is close.
+		const VectorRegister4Float SnapMask = VectorBitwiseOr(VectorCompareLE(InterpSpeed, VectorZeroFloat()),
+		                                                      VectorCompareLT(VectorMultiply(Distance, Distance), VectorSetFloat1(SMALL_NUMBER)));
+		return VectorSelect(SnapMask, Target, Result);
+	}
+
+	inline void InterpToBatch(const float* RESTRICT Current, const float* RESTRICT Target, const float* RESTRICT DeltaTime,
+	                          const float* RESTRICT InterpSpeed, float* RESTRICT OutValue, int32 Num)
+	{
+		int32 Index = 0;
+		for (; Index + 4 <= Num; Index += 4)
+		{
+			VectorStore(InterpTo(VectorLoad(Current + Index), VectorLoad(Target + Index), VectorLoad(DeltaTime + Index), VectorLoad(InterpSpeed + Index)),
+			            OutValue + Index);
+		}
+		for (; Index < Num; ++Index)
+		{
+			OutValue[Index] = FMath::FInterpTo(Current[Index], Target[Index], DeltaTime[Index], InterpSpeed[Index]);
+		}
+	}
+
+	// Without velocity the blend is 0 in every direction, where the scalar kernel divides 0 by 0.
+	inline void VelocityBlendBatch(const float* RESTRICT VelocityX, const float* RESTRICT VelocityY, const float* RESTRICT VelocityZ,
+	                               const float* RESTRICT ActorYaw, float* RESTRICT OutF, float* RESTRICT OutB,
+	                               float* RESTRICT OutL, float* RESTRICT OutR, int32 Num)
+	{
+		int32 Index = 0;
+		for (; Index + 4 <= Num; Index += 4)
+		{
+			VectorRegister4Float X = VectorLoad(VelocityX + Index);
+			VectorRegister4Float Y = VectorLoad(VelocityY + Index);
+			const VectorRegister4Float Z = VectorLoad(VelocityZ + Index);
+
+			// FVector::GetSafeNormal(0.1f)
+			const VectorRegister4Float SizeSquared = VectorMultiplyAdd(X, X, VectorMultiplyAdd(Y, Y, VectorMultiply(Z, Z)));
+			const VectorRegister4Float Scale = VectorSelect(VectorCompareLT(SizeSquared, VectorSetFloat1(0.1f)), VectorZeroFloat(), VectorReciprocalSqrt(SizeSquared));
+			X = VectorMultiply(X, Scale);
+			Y = VectorMultiply(Y, Scale);
+			UnrotateByYaw(VectorLoad(ActorYaw + Index), X, Y);
+
+			// Map diagonals vector from 1.0 to 0.5
+			const VectorRegister4Float Sum = VectorAdd(VectorAdd(VectorAbs(X), VectorAbs(Y)), VectorAbs(VectorMultiply(Z, Scale)));
+			const VectorRegister4Float InvSum = VectorSelect(VectorCompareGT(Sum, VectorZeroFloat()), VectorReciprocal(Sum), VectorZeroFloat());
+			X = VectorMultiply(X, InvSum);
+			Y = VectorMultiply(Y, InvSum);
+
+			VectorStore(VectorMin(VectorMax(X, VectorZeroFloat()), VectorOneFloat()), OutF + Index);
+			VectorStore(VectorMin(VectorMax(VectorNegate(X), VectorZeroFloat()), VectorOneFloat()), OutB + Index);
+			VectorStore(VectorMin(VectorMax(VectorNegate(Y), VectorZeroFloat()), VectorOneFloat()), OutL + Index);
+			VectorStore(VectorMin(VectorMax(Y, VectorZeroFloat()), VectorOneFloat()), OutR + Index);
+		}
+		for (; Index < Num; ++Index)
+		{
+			const FVector Velocity(VelocityX[Index], VelocityY[Index], VelocityZ[Index]);
+			const FVector4f Blend = Velocity.SizeSquared() < 0.1f ? FVector4f(0.0f, 0.0f, 0.0f, 0.0f) : VelocityBlend(Velocity, FRotator(0.0f, ActorYaw[Index], 0.0f));
+			OutF[Index] = Blend.X;
+			OutB[Index] = Blend.Y;
+			OutL[Index] = Blend.Z;
+			OutR[Index] = Blend.W;
+		}
+	}
+
+	inline void RelativeAccelerationAmountBatch(const float* RESTRICT AccelerationX, const float* RESTRICT AccelerationY, const float* RESTRICT AccelerationZ,
+	                                            const float* RESTRICT VelocityX, const float* RESTRICT VelocityY, const float* RESTRICT VelocityZ,
+	                                            const float* RESTRICT ActorYaw, const float* RESTRICT MaxAcceleration, const float* RESTRICT MaxBrakingDeceleration,
+	                                            float* RESTRICT OutX, float* RESTRICT OutY, float* RESTRICT OutZ, int32 Num)
+	{
+		int32 Index = 0;
+		for (; Index + 4 <= Num; Index += 4)
+		{
+			VectorRegister4Float X = VectorLoad(AccelerationX + Index);
+			VectorRegister4Float Y = VectorLoad(AccelerationY + Index);
+			VectorRegister4Float Z = VectorLoad(AccelerationZ + Index);
+
+			const VectorRegister4Float Dot = VectorMultiplyAdd(X, VectorLoad(VelocityX + Index),
+			                                                   VectorMultiplyAdd(Y, VectorLoad(VelocityY + Index), VectorMultiply(Z, VectorLoad(VelocityZ + Index))));
+			const VectorRegister4Float MaxAmount = VectorSelect(VectorCompareGT(Dot, VectorZeroFloat()), VectorLoad(MaxAcceleration + Index), VectorLoad(MaxBrakingDeceleration + Index));
+
+			// FVector::GetClampedToMaxSize(MaxAmount) / MaxAmount
+			const VectorRegister4Float SizeSquared = VectorMultiplyAdd(X, X, VectorMultiplyAdd(Y, Y, VectorMultiply(Z, Z)));
+			const VectorRegister4Float InvMaxAmount = VectorReciprocal(MaxAmount);
+			const VectorRegister4Float Scale = VectorSelect(VectorCompareGT(SizeSquared, VectorMultiply(MaxAmount, MaxAmount)),
+			                                                VectorReciprocalSqrt(SizeSquared), InvMaxAmount);
+			X = VectorMultiply(X, Scale);
+			Y = VectorMultiply(Y, Scale);
+			Z = VectorMultiply(Z, Scale);
+			UnrotateByYaw(VectorLoad(ActorYaw + Index), X, Y);
+
+			VectorStore(X, OutX + Index);
+			VectorStore(Y, OutY + Index);
+			VectorStore(Z, OutZ + Index);
+		}
+		for (; Index < Num; ++Index)
+		{
+			const FVector Amount = RelativeAccelerationAmount(FVector(AccelerationX[Index], AccelerationY[Index], AccelerationZ[Index]),
+			                                                  FVector(VelocityX[Index], VelocityY[Index], VelocityZ[Index]),
+			                                                  FRotator(0.0f, ActorYaw[Index], 0.0f), MaxAcceleration[Index], MaxBrakingDeceleration[Index]);
+			OutX[Index] = Amount.X;
+			OutY[Index] = Amount.Y;
+			OutZ[Index] = Amount.Z;
+		}
+	}
+
+	// The aiming rotation relative to the actor, as (Yaw, Pitch).
+	FORCEINLINE FVector2f AimingAngle(const FRotator& AimingRotation, const FRotator& ActorRotation)
+	{
+		const FRotator Delta = (AimingRotation - ActorRotation).GetNormalized();
+		return FVector2f(Delta.Yaw, Delta.Pitch);
+	}
+
+	inline void AimingAngleBatch(const float* RESTRICT AimingYaw, const float* RESTRICT AimingPitch, const float* RESTRICT ActorYaw,
+	                             float* RESTRICT OutX, float* RESTRICT OutY, int32 Num)
+	{
+		int32 Index = 0;
+		for (; Index + 4 <= Num; Index += 4)
+		{
+			VectorStore(NormalizeAxis(VectorSubtract(VectorLoad(AimingYaw + Index), VectorLoad(ActorYaw + Index))), OutX + Index);
+			VectorStore(NormalizeAxis(VectorLoad(AimingPitch + Index)), OutY + Index);
+		}
+		for (; Index < Num; ++Index)
+		{
+			const FVector2f Angle = AimingAngle(FRotator(AimingPitch[Index], AimingYaw[Index], 0.0f), FRotator(0.0f, ActorYaw[Index], 0.0f));
+			OutX[Index] = Angle.X;
+			OutY[Index] = Angle.Y;
+		}
+	}
+
+	FORCEINLINE bool AngleInRange(float Angle, float MinAngle, float MaxAngle, float Buffer, bool bIncreaseBuffer)
+	{
+		if (bIncreaseBuffer)
+		{
+			return Angle >= MinAngle - Buffer && Angle <= MaxAngle + Buffer;
+		}
+		return Angle >= MinAngle + Buffer && Angle <= MaxAngle - Buffer;
+	}
+
+	// Take the input angle and determine its quadrant (direction).
+	// The current direction widens or narrows the buffers on the angle ranges of each quadrant.
+	inline EMovementDirection Quadrant(EMovementDirection Current, float FRThreshold, float FLThreshold,
+	                                   float BRThreshold, float BLThreshold, float Buffer, float Angle)
+	{
+		// Calculate forward direction
+		bool bIncreaseBuffer = Current != EMovementDirection::MD_Forward || Current != EMovementDirection::MD_Backward;
+		if (AngleInRange(Angle, FLThreshold, FRThreshold, Buffer, bIncreaseBuffer))
+		{
+			return EMovementDirection::MD_Forward;
+		}
+
+		// Calculate right direction
+		bIncreaseBuffer = Current != EMovementDirection::MD_Right || Current != EMovementDirection::MD_Left;
+		if (AngleInRange(Angle, FRThreshold, BRThreshold, Buffer, bIncreaseBuffer))
+		{
+			return EMovementDirection::MD_Right;
+		}
+
+		// Calculate left direction
+		if (AngleInRange(Angle, BLThreshold, FLThreshold, Buffer, bIncreaseBuffer))
+		{
+			return EMovementDirection::MD_Left;
+		}
+
+		return EMovementDirection::MD_Backward;
+	}
+
+	// Play rate of the standing cycles: the speed divided by the animated speed of each gait,
+	// blended by the "Weight_Gait" curve (1 walk, 2 run, 3 sprint), then divided by the stride blend and the mesh scale.
+	FORCEINLINE float StandingPlayRate(float Speed, float AnimatedWalkSpeed, float AnimatedRunSpeed, float AnimatedSprintSpeed,
+	                                   float GaitWeight, float StrideBlend, float ScaleZ)
+	{
+		const float WalkRunSpeedRate = FMath::Lerp(Speed / AnimatedWalkSpeed, Speed / AnimatedRunSpeed, FMath::Clamp(GaitWeight - 1.0f, 0.0f, 1.0f));
+		const float RunSprintSpeedRate = FMath::Lerp(WalkRunSpeedRate, Speed / AnimatedSprintSpeed, FMath::Clamp(GaitWeight - 2.0f, 0.0f, 1.0f));
+
+		return FMath::Clamp(RunSprintSpeedRate / StrideBlend / ScaleZ, 0.0f, 3.0f);
+	}
+
+	inline void StandingPlayRateBatch(const float* RESTRICT Speed, float AnimatedWalkSpeed, float AnimatedRunSpeed, float AnimatedSprintSpeed,
+	                                  const float* RESTRICT GaitWeight, const float* RESTRICT StrideBlend, const float* RESTRICT ScaleZ,
+	                                  float* RESTRICT OutPlayRate, int32 Num)
+	{
+		const VectorRegister4Float InvAnimatedWalkSpeed = VectorSetFloat1(1.0f / AnimatedWalkSpeed);
+		const VectorRegister4Float InvAnimatedRunSpeed = VectorSetFloat1(1.0f / AnimatedRunSpeed);
+		const VectorRegister4Float InvAnimatedSprintSpeed = VectorSetFloat1(1.0f / AnimatedSprintSpeed);
+
+		int32 Index = 0;
+		for (; Index + 4 <= Num; Index += 4)
+		{
+			const VectorRegister4Float VSpeed = VectorLoad(Speed + Index);
+			const VectorRegister4Float VGaitWeight = VectorLoad(GaitWeight + Index);
+			const VectorRegister4Float WalkRunWeight = VectorMin(VectorMax(VectorSubtract(VGaitWeight, VectorOneFloat()), VectorZeroFloat()), VectorOneFloat());
+			const VectorRegister4Float RunSprintWeight = VectorMin(VectorMax(VectorSubtract(VGaitWeight, VectorSetFloat1(2.0f)), VectorZeroFloat()), VectorOneFloat());
+
+			const VectorRegister4Float WalkSpeedRate = VectorMultiply(VSpeed, InvAnimatedWalkSpeed);
+			const VectorRegister4Float WalkRunSpeedRate = VectorMultiplyAdd(VectorSubtract(VectorMultiply(VSpeed, InvAnimatedRunSpeed), WalkSpeedRate), WalkRunWeight, WalkSpeedRate);
+			const VectorRegister4Float RunSprintSpeedRate = VectorMultiplyAdd(VectorSubtract(VectorMultiply(VSpeed, InvAnimatedSprintSpeed), WalkRunSpeedRate), RunSprintWeight, WalkRunSpeedRate);
+
+			const VectorRegister4Float PlayRate = VectorDivide(RunSprintSpeedRate, VectorMultiply(VectorLoad(StrideBlend + Index), VectorLoad(ScaleZ + Index)));
+			VectorStore(VectorMin(VectorMax(PlayRate, VectorZeroFloat()), VectorSetFloat1(3.0f)), OutPlayRate + Index);
+		}
+		for (; Index < Num; ++Index)
+		{
+			OutPlayRate[Index] = StandingPlayRate(Speed[Index], AnimatedWalkSpeed, AnimatedRunSpeed, AnimatedSprintSpeed, GaitWeight[Index], StrideBlend[Index], ScaleZ[Index]);
+		}
+	}
+
+	// Play rate of the crouching cycles, kept separate from the standing one to improve the blend from crouch to stand while in motion.
+	FORCEINLINE float CrouchingPlayRate(float Speed, float AnimatedCrouchSpeed, float StrideBlend, float ScaleZ)
+	{
+		return FMath::Clamp(Speed / AnimatedCrouchSpeed / StrideBlend / ScaleZ, 0.0f, 2.0f);
+	}
+
+	inline void CrouchingPlayRateBatch(const float* RESTRICT Speed, float AnimatedCrouchSpeed, const float* RESTRICT StrideBlend,
+	                                   const float* RESTRICT ScaleZ, float* RESTRICT OutPlayRate, int32 Num)
+	{
+		const VectorRegister4Float InvAnimatedCrouchSpeed = VectorSetFloat1(1.0f / AnimatedCrouchSpeed);
+
+		int32 Index = 0;
+		for (; Index + 4 <= Num; Index += 4)
+		{
+			const VectorRegister4Float SpeedRate = VectorMultiply(VectorLoad(Speed + Index), InvAnimatedCrouchSpeed);
+			const VectorRegister4Float PlayRate = VectorDivide(SpeedRate, VectorMultiply(VectorLoad(StrideBlend + Index), VectorLoad(ScaleZ + Index)));
+			VectorStore(VectorMin(VectorMax(PlayRate, VectorZeroFloat()), VectorSetFloat1(2.0f)), OutPlayRate + Index);
+		}
+		for (; Index < Num; ++Index)
+		{
+			OutPlayRate[Index] = CrouchingPlayRate(Speed[Index], AnimatedCrouchSpeed, StrideBlend[Index], ScaleZ[Index]);
+		}
+	}
+}
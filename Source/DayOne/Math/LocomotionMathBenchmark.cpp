@@ -0,0 +1,271 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+#include "DayOne/Math/Benchmark.h"
+#include "DayOne/Math/LocomotionMath.h"
+
+#if !UE_BUILD_SHIPPING
+
+// Microbenchmark of the locomotion math kernels. Needs no world, so it also runs headless, e.g.
+// DayOneServer -nullrhi -ExecCmds="DayOne.Locomotion.BenchmarkMath 4096 2000, Quit"
+namespace LocomotionMathBenchmark
+{
+	using DayOneBenchmark::NanosecondsPerElement;
+
+	static float MaxDifference(const TArray<float>& A, const TArray<float>& B)
+	{
+		float Result = 0.0f;
+		for (int32 Index = 0; Index < A.Num(); ++Index)
+		{
+			Result = FMath::Max(Result, FMath::Abs(A[Index] - B[Index]));
+		}
+		return Result;
+	}
+
+	static void LogBatch(const TCHAR* Name, double ScalarNs, double BatchNs, float Difference)
+	{
+		UE_LOG(LogTemp, Display, TEXT("%-24s scalar %7.3f ns  batch %7.3f ns  x%5.2f  max diff %g"),
+		       Name, ScalarNs, BatchNs, ScalarNs / FMath::Max(BatchNs, 1e-6), Difference);
+	}
+
+	static void Run(const TArray<FString>& Args)
+	{
+		const int32 Num = FMath::Max(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1024, 1);
+		const int32 Iterations = FMath::Max(Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 1000, 1);
+
+		FRandomStream Random(DayOneBenchmark::Seed);
+
+		TArray<float> Speed, WalkSpeed, RunSpeed, SprintSpeed, AimYawRate, RotationRateCurveValue, GaitWeight, StrideBlend, ScaleZ;
+		// Structure-of-arrays copies of the vectors and rotators below, for the anim parameter kernels.
+		TArray<float> VelocityX, VelocityY, VelocityZ, AccelerationX, AccelerationY, AccelerationZ, ActorYaw, AimingYaw, AimingPitch;
+		TArray<float> MaxAcceleration, MaxBrakingDeceleration, DeltaTime, InterpSpeed, InterpCurrent, InterpTarget;
+		TArray<FVector> Velocity, Acceleration, MovementInput;
+		TArray<FRotator> ActorRotation, ControlRotation;
+		for (TArray<float>* Array : { &Speed, &WalkSpeed, &RunSpeed, &SprintSpeed, &AimYawRate, &RotationRateCurveValue, &GaitWeight, &StrideBlend, &ScaleZ,
+		                              &VelocityX, &VelocityY, &VelocityZ, &AccelerationX, &AccelerationY, &AccelerationZ, &ActorYaw, &AimingYaw, &AimingPitch,
+		                              &MaxAcceleration, &MaxBrakingDeceleration, &DeltaTime, &InterpSpeed, &InterpCurrent, &InterpTarget })
+		{
+			Array->SetNumUninitialized(Num);
+		}
+		Velocity.SetNumUninitialized(Num);
+		Acceleration.SetNumUninitialized(Num);
+		MovementInput.SetNumUninitialized(Num);
+		ActorRotation.SetNumUninitialized(Num);
+		ControlRotation.SetNumUninitialized(Num);
+
+		for (int32 Index = 0; Index < Num; ++Index)
+		{
+			Speed[Index] = Random.FRandRange(0.0f, 700.0f);
+			WalkSpeed[Index] = Random.FRandRange(150.0f, 200.0f);
+			RunSpeed[Index] = Random.FRandRange(350.0f, 400.0f);
+			SprintSpeed[Index] = Random.FRandRange(600.0f, 650.0f);
+			AimYawRate[Index] = Random.FRandRange(0.0f, 400.0f);
+			RotationRateCurveValue[Index] = Random.FRandRange(0.0f, 20.0f);
+			GaitWeight[Index] = Random.FRandRange(1.0f, 3.0f);
+			StrideBlend[Index] = Random.FRandRange(0.2f, 1.0f);
+			ScaleZ[Index] = Random.FRandRange(0.9f, 1.1f);
+			Velocity[Index] = Random.GetUnitVector() * Speed[Index];
+			Acceleration[Index] = Random.GetUnitVector() * Random.FRandRange(0.0f, 2000.0f);
+			MovementInput[Index] = Random.GetUnitVector();
+			ActorRotation[Index] = FRotator(0.0f, Random.FRandRange(-180.0f, 180.0f), 0.0f);
+			ControlRotation[Index] = FRotator(Random.FRandRange(-60.0f, 60.0f), Random.FRandRange(-180.0f, 180.0f), 0.0f);
+
+			VelocityX[Index] = Velocity[Index].X;
+			VelocityY[Index] = Velocity[Index].Y;
+			VelocityZ[Index] = Velocity[Index].Z;
+			AccelerationX[Index] = Acceleration[Index].X;
+			AccelerationY[Index] = Acceleration[Index].Y;
+			AccelerationZ[Index] = Acceleration[Index].Z;
+			ActorYaw[Index] = ActorRotation[Index].Yaw;
+			AimingYaw[Index] = ControlRotation[Index].Yaw;
+			AimingPitch[Index] = ControlRotation[Index].Pitch;
+			MaxAcceleration[Index] = 2000.0f;
+			MaxBrakingDeceleration[Index] = 1500.0f;
+			DeltaTime[Index] = Random.FRandRange(1.0f / 144.0f, 1.0f / 20.0f);
+			InterpSpeed[Index] = Random.FRandRange(0.0f, 12.0f);
+			InterpCurrent[Index] = Random.FRandRange(-1.0f, 1.0f);
+			InterpTarget[Index] = Random.FRandRange(-1.0f, 1.0f);
+		}
+
+		// The anim parameter kernels have up to four outputs.
+		TArray<float> ScalarResult, BatchResult, ScalarResult1, BatchResult1, ScalarResult2, BatchResult2, ScalarResult3, BatchResult3;
+		for (TArray<float>* Array : { &ScalarResult, &BatchResult, &ScalarResult1, &BatchResult1, &ScalarResult2, &BatchResult2, &ScalarResult3, &BatchResult3 })
+		{
+			Array->SetNumZeroed(Num);
+		}
+
+		UE_LOG(LogTemp, Display, TEXT("Locomotion math, %d elements x %d iterations, per element:"), Num, Iterations);
+
+		// Batched kernels, checked against their scalar kernel.
+		{
+			const double ScalarNs = NanosecondsPerElement(Num, Iterations, [&]()
+			{
+				for (int32 Index = 0; Index < Num; ++Index)
+				{
+					ScalarResult[Index] = LocomotionMath::MappedSpeed(Speed[Index], WalkSpeed[Index], RunSpeed[Index], SprintSpeed[Index]);
+				}
+			});
+			const double BatchNs = NanosecondsPerElement(Num, Iterations, [&]()
+			{
+				LocomotionMath::MappedSpeedBatch(Speed.GetData(), WalkSpeed.GetData(), RunSpeed.GetData(), SprintSpeed.GetData(), BatchResult.GetData(), Num);
+			});
+			LogBatch(TEXT("MappedSpeed"), ScalarNs, BatchNs, MaxDifference(ScalarResult, BatchResult));
+		}
+		{
+			const double ScalarNs = NanosecondsPerElement(Num, Iterations, [&]()
+			{
+				for (int32 Index = 0; Index < Num; ++Index)
+				{
+					ScalarResult[Index] = LocomotionMath::GroundedRotationRate(RotationRateCurveValue[Index], AimYawRate[Index]);
+				}
+			});
+			const double BatchNs = NanosecondsPerElement(Num, Iterations, [&]()
+			{
+				LocomotionMath::GroundedRotationRateBatch(RotationRateCurveValue.GetData(), AimYawRate.GetData(), BatchResult.GetData(), Num);
+			});
+			LogBatch(TEXT("GroundedRotationRate"), ScalarNs, BatchNs, MaxDifference(ScalarResult, BatchResult));
+		}
+		{
+			const double ScalarNs = NanosecondsPerElement(Num, Iterations, [&]()
+			{
+				for (int32 Index = 0; Index < Num; ++Index)
+				{
+					ScalarResult[Index] = LocomotionMath::StandingPlayRate(Speed[Index], 150.0f, 350.0f, 600.0f, GaitWeight[Index], StrideBlend[Index], ScaleZ[Index]);
+				}
+			});
+			const double BatchNs = NanosecondsPerElement(Num, Iterations, [&]()
+			{
+				LocomotionMath::StandingPlayRateBatch(Speed.GetData(), 150.0f, 350.0f, 600.0f, GaitWeight.GetData(), StrideBlend.GetData(), ScaleZ.GetData(), BatchResult.GetData(), Num);
+			});
+			LogBatch(TEXT("StandingPlayRate"), ScalarNs, BatchNs, MaxDifference(ScalarResult, BatchResult));
+		}
+		{
+			const double ScalarNs = NanosecondsPerElement(Num, Iterations, [&]()
+			{
+				for (int32 Index = 0; Index < Num; ++Index)
+				{
+					ScalarResult[Index] = LocomotionMath::CrouchingPlayRate(Speed[Index], 150.0f, StrideBlend[Index], ScaleZ[Index]);
+				}
+			});
+			const double BatchNs = NanosecondsPerElement(Num, Iterations, [&]()
+			{
+				LocomotionMath::CrouchingPlayRateBatch(Speed.GetData(), 150.0f, StrideBlend.GetData(), ScaleZ.GetData(), BatchResult.GetData(), Num);
+			});
+			LogBatch(TEXT("CrouchingPlayRate"), ScalarNs, BatchNs, MaxDifference(ScalarResult, BatchResult));
+		}
+
+		// Anim parameter kernels of ULocomotionSubsystem::UpdateAnimParameters, the scalar side is what UBaseAnimInstance computes otherwise.
+		{
+			const double ScalarNs = NanosecondsPerElement(Num, Iterations, [&]()
+			{
+				for (int32 Index = 0; Index < Num; ++Index)
+				{
+					ScalarResult[Index] = FMath::FInterpTo(InterpCurrent[Index], InterpTarget[Index], DeltaTime[Index], InterpSpeed[Index]);
+				}
+			});
+			const double BatchNs = NanosecondsPerElement(Num, Iterations, [&]()
+			{
+				LocomotionMath::InterpToBatch(InterpCurrent.GetData(), InterpTarget.GetData(), DeltaTime.GetData(), InterpSpeed.GetData(), BatchResult.GetData(), Num);
+			});
+			LogBatch(TEXT("InterpTo"), ScalarNs, BatchNs, MaxDifference(ScalarResult, BatchResult));
+		}
+		{
+			const double ScalarNs = NanosecondsPerElement(Num, Iterations, [&]()
+			{
+				for (int32 Index = 0; Index < Num; ++Index)
+				{
+					const FVector4f Blend = LocomotionMath::VelocityBlend(Velocity[Index], ActorRotation[Index]);
+					ScalarResult[Index] = Blend.X;
+					ScalarResult1[Index] = Blend.Y;
+					ScalarResult2[Index] = Blend.Z;
+					ScalarResult3[Index] = Blend.W;
+				}
+			});
+			const double BatchNs = NanosecondsPerElement(Num, Iterations, [&]()
+			{
+				LocomotionMath::VelocityBlendBatch(VelocityX.GetData(), VelocityY.GetData(), VelocityZ.GetData(), ActorYaw.GetData(),
+				                                   BatchResult.GetData(), BatchResult1.GetData(), BatchResult2.GetData(), BatchResult3.GetData(), Num);
+			});
+			LogBatch(TEXT("VelocityBlend"), ScalarNs, BatchNs,
+			         FMath::Max(FMath::Max(MaxDifference(ScalarResult, BatchResult), MaxDifference(ScalarResult1, BatchResult1)),
+			                    FMath::Max(MaxDifference(ScalarResult2, BatchResult2), MaxDifference(ScalarResult3, BatchResult3))));
+		}
+		{
+			const double ScalarNs = NanosecondsPerElement(Num, Iterations, [&]()
+			{
+				for (int32 Index = 0; Index < Num; ++Index)
+				{
+					const FVector Amount = LocomotionMath::RelativeAccelerationAmount(Acceleration[Index], Velocity[Index], ActorRotation[Index], 2000.0f, 1500.0f);
+					ScalarResult[Index] = Amount.X;
+					ScalarResult1[Index] = Amount.Y;
+					ScalarResult2[Index] = Amount.Z;
+				}
+			});
+			const double BatchNs = NanosecondsPerElement(Num, Iterations, [&]()
+			{
+				LocomotionMath::RelativeAccelerationAmountBatch(AccelerationX.GetData(), AccelerationY.GetData(), AccelerationZ.GetData(),
+				                                                VelocityX.GetData(), VelocityY.GetData(), VelocityZ.GetData(), ActorYaw.GetData(),
+				                                                MaxAcceleration.GetData(), MaxBrakingDeceleration.GetData(),
+				                                                BatchResult.GetData(), BatchResult1.GetData(), BatchResult2.GetData(), Num);
+			});
+			LogBatch(TEXT("RelativeAcceleration"), ScalarNs, BatchNs,
+			         FMath::Max3(MaxDifference(ScalarResult, BatchResult), MaxDifference(ScalarResult1, BatchResult1), MaxDifference(ScalarResult2, BatchResult2)));
+		}
+		{
+			const double ScalarNs = NanosecondsPerElement(Num, Iterations, [&]()
+			{
+				for (int32 Index = 0; Index < Num; ++Index)
+				{
+					// What UBaseAnimInstance::UpdateAimingAngle computes.
+					const FRotator Delta = (ControlRotation[Index] - ActorRotation[Index]).GetNormalized();
+					ScalarResult[Index] = Delta.Yaw;
+					ScalarResult1[Index] = Delta.Pitch;
+				}
+			});
+			const double BatchNs = NanosecondsPerElement(Num, Iterations, [&]()
+			{
+				LocomotionMath::AimingAngleBatch(AimingYaw.GetData(), AimingPitch.GetData(), ActorYaw.GetData(), BatchResult.GetData(), BatchResult1.GetData(), Num);
+			});
+			LogBatch(TEXT("AimingAngle"), ScalarNs, BatchNs, FMath::Max(MaxDifference(ScalarResult, BatchResult), MaxDifference(ScalarResult1, BatchResult1)));
+		}
+
+		// Scalar only kernels.
+		const auto LogScalar = [](const TCHAR* Name, double ScalarNs)
+		{
+			UE_LOG(LogTemp, Display, TEXT("%-24s scalar %7.3f ns"), Name, ScalarNs);
+		};
+
+		LogScalar(TEXT("Gait"), NanosecondsPerElement(Num, Iterations, [&]()
+		{
+			float Sum = 0.0f;
+			for (int32 Index = 0; Index < Num; ++Index)
+			{
+				const bool bCanSprint = LocomotionMath::CanSprint(ERotationMode::RM_Looking, true, 1.0f, MovementInput[Index], ControlRotation[Index]);
+				const EGaitState AllowedGait = LocomotionMath::AllowedGait(EStanceState::SS_Standing, ERotationMode::RM_Looking, EGaitState::GS_Sprinting, bCanSprint);
+				Sum += static_cast<float>(LocomotionMath::ActualGait(AllowedGait, Speed[Index], WalkSpeed[Index], RunSpeed[Index]));
+			}
+			DayOneBenchmark::Consume(Sum);
+		}));
+		LogScalar(TEXT("Quadrant"), NanosecondsPerElement(Num, Iterations, [&]()
+		{
+			float Sum = 0.0f;
+			EMovementDirection Direction = EMovementDirection::MD_Forward;
+			for (int32 Index = 0; Index < Num; ++Index)
+			{
+				Direction = LocomotionMath::Quadrant(Direction, 70.0f, -70.0f, 110.0f, -110.0f, 5.0f, ActorRotation[Index].Yaw);
+				Sum += static_cast<float>(Direction);
+			}
+			DayOneBenchmark::Consume(Sum);
+		}));
+	}
+}
+
+static FAutoConsoleCommand BenchmarkLocomotionMathCommand(
+	TEXT("DayOne.Locomotion.BenchmarkMath"),
+	TEXT("Time the locomotion math kernels and check the batched kernels against the scalar ones.\n")
+	TEXT("Usage: DayOne.Locomotion.BenchmarkMath [Num=1024] [Iterations=1000]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&LocomotionMathBenchmark::Run));
+
+#endif
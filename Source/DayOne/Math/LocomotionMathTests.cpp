@@ -0,0 +1,268 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+#include "DayOne/Math/LocomotionMath.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace LocomotionMathTests
+{
+	static constexpr EAutomationTestFlags::Type TestFlags = static_cast<EAutomationTestFlags::Type>(EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter);
+
+	// Not a multiple of four, so the scalar remainder of every batch kernel runs too.
+	static constexpr int32 NumElements = 1027;
+
+	// Largest difference between the two arrays, angles are compared on the circle.
+	static float MaxDifference(const TArray<float>& A, const TArray<float>& B, bool bAngles = false)
+	{
+		float Result = 0.0f;
+		for (int32 Index = 0; Index < A.Num(); ++Index)
+		{
+			const float Difference = bAngles ? FRotator::NormalizeAxis(A[Index] - B[Index]) : A[Index] - B[Index];
+			Result = FMath::Max(Result, FMath::Abs(Difference));
+		}
+		return Result;
+	}
+
+	static TArray<float> RandomArray(FRandomStream& Random, float Min, float Max)
+	{
+		TArray<float> Array;
+		Array.SetNumUninitialized(NumElements);
+		for (float& Value : Array)
+		{
+			Value = Random.FRandRange(Min, Max);
+		}
+		return Array;
+	}
+
+	static TArray<float> ZeroedArray()
+	{
+		TArray<float> Array;
+		Array.SetNumZeroed(NumElements);
+		return Array;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLocomotionMathBatchTest, "DayOne.Locomotion.Math.BatchMatchesScalar", LocomotionMathTests::TestFlags)
+
+bool FLocomotionMathBatchTest::RunTest(const FString& Parameters)
+{
+	using namespace LocomotionMathTests;
+	using LocomotionMath::AnimParameterBatchTolerance;
+
+	FRandomStream Random(0xD1);
+	const TArray<float> Speed = RandomArray(Random, 0.0f, 700.0f);
+	const TArray<float> WalkSpeed = RandomArray(Random, 150.0f, 200.0f);
+	const TArray<float> RunSpeed = RandomArray(Random, 350.0f, 400.0f);
+	const TArray<float> SprintSpeed = RandomArray(Random, 600.0f, 650.0f);
+	const TArray<float> AimYawRate = RandomArray(Random, 0.0f, 400.0f);
+	const TArray<float> RotationRateCurveValue = RandomArray(Random, 0.0f, 20.0f);
+	const TArray<float> GaitWeight = RandomArray(Random, 1.0f, 3.0f);
+	const TArray<float> StrideBlend = RandomArray(Random, 0.2f, 1.0f);
+	const TArray<float> ScaleZ = RandomArray(Random, 0.9f, 1.1f);
+	const TArray<float> VelocityX = RandomArray(Random, -600.0f, 600.0f);
+	const TArray<float> VelocityY = RandomArray(Random, -600.0f, 600.0f);
+	const TArray<float> VelocityZ = RandomArray(Random, -100.0f, 100.0f);
+	const TArray<float> AccelerationX = RandomArray(Random, -2000.0f, 2000.0f);
+	const TArray<float> AccelerationY = RandomArray(Random, -2000.0f, 2000.0f);
+	const TArray<float> AccelerationZ = RandomArray(Random, -500.0f, 500.0f);
+	const TArray<float> ActorYaw = RandomArray(Random, -180.0f, 180.0f);
+	const TArray<float> AimingYaw = RandomArray(Random, -180.0f, 180.0f);
+	const TArray<float> AimingPitch = RandomArray(Random, -60.0f, 60.0f);
+	const TArray<float> MaxAcceleration = RandomArray(Random, 1000.0f, 2000.0f);
+	const TArray<float> MaxBrakingDeceleration = RandomArray(Random, 1000.0f, 2000.0f);
+	const TArray<float> DeltaTime = RandomArray(Random, 1.0f / 144.0f, 1.0f / 20.0f);
+	const TArray<float> InterpSpeed = RandomArray(Random, 0.0f, 12.0f);
+	const TArray<float> InterpCurrent = RandomArray(Random, -1.0f, 1.0f);
+	const TArray<float> InterpTarget = RandomArray(Random, -1.0f, 1.0f);
+
+	TArray<float> Scalar[4] = { ZeroedArray(), ZeroedArray(), ZeroedArray(), ZeroedArray() };
+	TArray<float> Batch[4] = { ZeroedArray(), ZeroedArray(), ZeroedArray(), ZeroedArray() };
+
+	for (int32 Index = 0; Index < NumElements; ++Index)
+	{
+		Scalar[0][Index] = LocomotionMath::MappedSpeed(Speed[Index], WalkSpeed[Index], RunSpeed[Index], SprintSpeed[Index]);
+	}
+	LocomotionMath::MappedSpeedBatch(Speed.GetData(), WalkSpeed.GetData(), RunSpeed.GetData(), SprintSpeed.GetData(), Batch[0].GetData(), NumElements);
+	TestTrue(TEXT("MappedSpeedBatch matches MappedSpeed"), MaxDifference(Scalar[0], Batch[0]) <= AnimParameterBatchTolerance);
+
+	for (int32 Index = 0; Index < NumElements; ++Index)
+	{
+		Scalar[0][Index] = LocomotionMath::GroundedRotationRate(RotationRateCurveValue[Index], AimYawRate[Index]);
+	}
+	LocomotionMath::GroundedRotationRateBatch(RotationRateCurveValue.GetData(), AimYawRate.GetData(), Batch[0].GetData(), NumElements);
+	TestTrue(TEXT("GroundedRotationRateBatch matches GroundedRotationRate"), MaxDifference(Scalar[0], Batch[0]) <= AnimParameterBatchTolerance);
+
+	for (int32 Index = 0; Index < NumElements; ++Index)
+	{
+		Scalar[0][Index] = LocomotionMath::StandingPlayRate(Speed[Index], 150.0f, 350.0f, 600.0f, GaitWeight[Index], StrideBlend[Index], ScaleZ[Index]);
+	}
+	LocomotionMath::StandingPlayRateBatch(Speed.GetData(), 150.0f, 350.0f, 600.0f, GaitWeight.GetData(), StrideBlend.GetData(), ScaleZ.GetData(),
+	                                      Batch[0].GetData(), NumElements);
+	TestTrue(TEXT("StandingPlayRateBatch matches StandingPlayRate"), MaxDifference(Scalar[0], Batch[0]) <= AnimParameterBatchTolerance);
+
+	for (int32 Index = 0; Index < NumElements; ++Index)
+	{
+		Scalar[0][Index] = LocomotionMath::CrouchingPlayRate(Speed[Index], 150.0f, StrideBlend[Index], ScaleZ[Index]);
+	}
+	LocomotionMath::CrouchingPlayRateBatch(Speed.GetData(), 150.0f, StrideBlend.GetData(), ScaleZ.GetData(), Batch[0].GetData(), NumElements);
+	TestTrue(TEXT("CrouchingPlayRateBatch matches CrouchingPlayRate"), MaxDifference(Scalar[0], Batch[0]) <= AnimParameterBatchTolerance);
+
+	for (int32 Index = 0; Index < NumElements; ++Index)
+	{
+		Scalar[0][Index] = FMath::FInterpTo(InterpCurrent[Index], InterpTarget[Index], DeltaTime[Index], InterpSpeed[Index]);
+	}
+	LocomotionMath::InterpToBatch(InterpCurrent.GetData(), InterpTarget.GetData(), DeltaTime.GetData(), InterpSpeed.GetData(), Batch[0].GetData(), NumElements);
+	TestTrue(TEXT("InterpToBatch matches FInterpTo"), MaxDifference(Scalar[0], Batch[0]) <= AnimParameterBatchTolerance);
+
+	for (int32 Index = 0; Index < NumElements; ++Index)
+	{
+		const FVector4f Blend = LocomotionMath::VelocityBlend(FVector(VelocityX[Index], VelocityY[Index], VelocityZ[Index]), FRotator(0.0f, ActorYaw[Index], 0.0f));
+		Scalar[0][Index] = Blend.X;
+		Scalar[1][Index] = Blend.Y;
+		Scalar[2][Index] = Blend.Z;
+		Scalar[3][Index] = Blend.W;
+	}
+	LocomotionMath::VelocityBlendBatch(VelocityX.GetData(), VelocityY.GetData(), VelocityZ.GetData(), ActorYaw.GetData(),
+	                                   Batch[0].GetData(), Batch[1].GetData(), Batch[2].GetData(), Batch[3].GetData(), NumElements);
+	for (int32 Output = 0; Output < 4; ++Output)
+	{
+		TestTrue(*FString::Printf(TEXT("VelocityBlendBatch matches VelocityBlend, output %d"), Output), MaxDifference(Scalar[Output], Batch[Output]) <= AnimParameterBatchTolerance);
+	}
+
+	for (int32 Index = 0; Index < NumElements; ++Index)
+	{
+		const FVector Amount = LocomotionMath::RelativeAccelerationAmount(FVector(AccelerationX[Index], AccelerationY[Index], AccelerationZ[Index]),
+		                                                                  FVector(VelocityX[Index], VelocityY[Index], VelocityZ[Index]),
+		                                                                  FRotator(0.0f, ActorYaw[Index], 0.0f), MaxAcceleration[Index], MaxBrakingDeceleration[Index]);
+		Scalar[0][Index] = Amount.X;
+		Scalar[1][Index] = Amount.Y;
+		Scalar[2][Index] = Amount.Z;
+	}
+	LocomotionMath::RelativeAccelerationAmountBatch(AccelerationX.GetData(), AccelerationY.GetData(), AccelerationZ.GetData(),
+	                                                VelocityX.GetData(), VelocityY.GetData(), VelocityZ.GetData(), ActorYaw.GetData(),
+	                                                MaxAcceleration.GetData(), MaxBrakingDeceleration.GetData(),
+	                                                Batch[0].GetData(), Batch[1].GetData(), Batch[2].GetData(), NumElements);
+	for (int32 Output = 0; Output < 3; ++Output)
+	{
+		TestTrue(*FString::Printf(TEXT("RelativeAccelerationAmountBatch matches RelativeAccelerationAmount, output %d"), Output),
+		         MaxDifference(Scalar[Output], Batch[Output]) <= AnimParameterBatchTolerance);
+	}
+
+	for (int32 Index = 0; Index < NumElements; ++Index)
+	{
+		const FVector2f Angle = LocomotionMath::AimingAngle(FRotator(AimingPitch[Index], AimingYaw[Index], 0.0f), FRotator(0.0f, ActorYaw[Index], 0.0f));
+		Scalar[0][Index] = Angle.X;
+		Scalar[1][Index] = Angle.Y;
+	}
+	LocomotionMath::AimingAngleBatch(AimingYaw.GetData(), AimingPitch.GetData(), ActorYaw.GetData(), Batch[0].GetData(), Batch[1].GetData(), NumElements);
+	TestTrue(TEXT("AimingAngleBatch matches AimingAngle, yaw"), MaxDifference(Scalar[0], Batch[0], true) <= AnimParameterBatchTolerance);
+	TestTrue(TEXT("AimingAngleBatch matches AimingAngle, pitch"), MaxDifference(Scalar[1], Batch[1], true) <= AnimParameterBatchTolerance);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLocomotionMathMappedSpeedTest, "DayOne.Locomotion.Math.MappedSpeed", LocomotionMathTests::TestFlags)
+
+bool FLocomotionMathMappedSpeedTest::RunTest(const FString& Parameters)
+{
+	const float WalkSpeed = 165.0f;
+	const float RunSpeed = 375.0f;
+	const float SprintSpeed = 600.0f;
+
+	TestEqual(TEXT("Stopped"), LocomotionMath::MappedSpeed(0.0f, WalkSpeed, RunSpeed, SprintSpeed), 0.0f);
+	TestEqual(TEXT("Walk speed"), LocomotionMath::MappedSpeed(WalkSpeed, WalkSpeed, RunSpeed, SprintSpeed), 1.0f);
+	TestEqual(TEXT("Run speed"), LocomotionMath::MappedSpeed(RunSpeed, WalkSpeed, RunSpeed, SprintSpeed), 2.0f);
+	TestEqual(TEXT("Sprint speed"), LocomotionMath::MappedSpeed(SprintSpeed, WalkSpeed, RunSpeed, SprintSpeed), 3.0f);
+	TestEqual(TEXT("Between walk and run"), LocomotionMath::MappedSpeed(0.5f * (WalkSpeed + RunSpeed), WalkSpeed, RunSpeed, SprintSpeed), 1.5f, KINDA_SMALL_NUMBER);
+	TestEqual(TEXT("Past sprint speed"), LocomotionMath::MappedSpeed(2.0f * SprintSpeed, WalkSpeed, RunSpeed, SprintSpeed), 3.0f);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLocomotionMathAllowedGaitTest, "DayOne.Locomotion.Math.AllowedGait", LocomotionMathTests::TestFlags)
+
+bool FLocomotionMathAllowedGaitTest::RunTest(const FString& Parameters)
+{
+	using LocomotionMath::AllowedGait;
+
+	const EGaitState Walking = EGaitState::GS_Walking;
+	const EGaitState Running = EGaitState::GS_Running;
+	const EGaitState Sprinting = EGaitState::GS_Sprinting;
+	const EStanceState Standing = EStanceState::SS_Standing;
+	const EStanceState Crouching = EStanceState::SS_Crouching;
+
+	for (const ERotationMode RotationMode : { ERotationMode::RM_Velocity, ERotationMode::RM_Looking })
+	{
+		const FString Mode = StaticEnum<ERotationMode>()->GetNameStringByValue(static_cast<int64>(RotationMode));
+		TestTrue(*(Mode + TEXT(", standing, walk")), AllowedGait(Standing, RotationMode, Walking, true) == Walking);
+		TestTrue(*(Mode + TEXT(", standing, run")), AllowedGait(Standing, RotationMode, Running, true) == Running);
+		TestTrue(*(Mode + TEXT(", standing, sprint allowed")), AllowedGait(Standing, RotationMode, Sprinting, true) == Sprinting);
+		TestTrue(*(Mode + TEXT(", standing, sprint not allowed")), AllowedGait(Standing, RotationMode, Sprinting, false) == Running);
+	}
+
+	TestTrue(TEXT("Aiming, standing, walk"), AllowedGait(Standing, ERotationMode::RM_Aiming, Walking, true) == Walking);
+	TestTrue(TEXT("Aiming, standing, run"), AllowedGait(Standing, ERotationMode::RM_Aiming, Running, true) == Running);
+	TestTrue(TEXT("Aiming, standing, sprint"), AllowedGait(Standing, ERotationMode::RM_Aiming, Sprinting, true) == Running);
+
+	for (const ERotationMode RotationMode : { ERotationMode::RM_Velocity, ERotationMode::RM_Looking, ERotationMode::RM_Aiming })
+	{
+		const FString Mode = StaticEnum<ERotationMode>()->GetNameStringByValue(static_cast<int64>(RotationMode));
+		TestTrue(*(Mode + TEXT(", crouching, walk")), AllowedGait(Crouching, RotationMode, Walking, true) == Walking);
+		TestTrue(*(Mode + TEXT(", crouching, run")), AllowedGait(Crouching, RotationMode, Running, true) == Running);
+		TestTrue(*(Mode + TEXT(", crouching, sprint")), AllowedGait(Crouching, RotationMode, Sprinting, true) == Running);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLocomotionMathCanSprintTest, "DayOne.Locomotion.Math.CanSprint", LocomotionMathTests::TestFlags)
+
+bool FLocomotionMathCanSprintTest::RunTest(const FString& Parameters)
+{
+	using LocomotionMath::CanSprint;
+
+	const FRotator Control(0.0f, 90.0f, 0.0f);
+	const FVector Ahead = Control.Vector();
+	const FVector Behind = -Ahead;
+
+	TestFalse(TEXT("Without input"), CanSprint(ERotationMode::RM_Looking, false, 0.0f, Ahead, Control));
+	TestFalse(TEXT("Aiming"), CanSprint(ERotationMode::RM_Aiming, true, 1.0f, Ahead, Control));
+	TestTrue(TEXT("Looking, full input ahead"), CanSprint(ERotationMode::RM_Looking, true, 1.0f, Ahead, Control));
+	TestFalse(TEXT("Looking, partial input ahead"), CanSprint(ERotationMode::RM_Looking, true, 0.5f, Ahead, Control));
+	TestFalse(TEXT("Looking, full input behind"), CanSprint(ERotationMode::RM_Looking, true, 1.0f, Behind, Control));
+	TestTrue(TEXT("Velocity, full input behind"), CanSprint(ERotationMode::RM_Velocity, true, 1.0f, Behind, Control));
+	TestFalse(TEXT("Velocity, partial input"), CanSprint(ERotationMode::RM_Velocity, true, 0.5f, Behind, Control));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLocomotionMathQuadrantTest, "DayOne.Locomotion.Math.Quadrant", LocomotionMathTests::TestFlags)
+
+bool FLocomotionMathQuadrantTest::RunTest(const FString& Parameters)
+{
+	// The thresholds and buffer of the anim graph.
+	const auto Quadrant = [](float Angle)
+	{
+		return LocomotionMath::Quadrant(EMovementDirection::MD_Forward, 70.0f, -70.0f, 110.0f, -110.0f, 5.0f, Angle);
+	};
+
+	TestTrue(TEXT("Straight ahead"), Quadrant(0.0f) == EMovementDirection::MD_Forward);
+	// Every range is widened by the buffer.
+	TestTrue(TEXT("Front right threshold plus buffer"), Quadrant(75.0f) == EMovementDirection::MD_Forward);
+	TestTrue(TEXT("Past the front right buffer"), Quadrant(75.5f) == EMovementDirection::MD_Right);
+	TestTrue(TEXT("Front left threshold plus buffer"), Quadrant(-75.0f) == EMovementDirection::MD_Forward);
+	TestTrue(TEXT("Past the front left buffer"), Quadrant(-75.5f) == EMovementDirection::MD_Left);
+	TestTrue(TEXT("Back right threshold plus buffer"), Quadrant(115.0f) == EMovementDirection::MD_Right);
+	TestTrue(TEXT("Past the back right buffer"), Quadrant(115.5f) == EMovementDirection::MD_Backward);
+	TestTrue(TEXT("Back left threshold plus buffer"), Quadrant(-115.0f) == EMovementDirection::MD_Left);
+	TestTrue(TEXT("Past the back left buffer"), Quadrant(-115.5f) == EMovementDirection::MD_Backward);
+	TestTrue(TEXT("Straight behind"), Quadrant(180.0f) == EMovementDirection::MD_Backward);
+	TestTrue(TEXT("Straight behind, negative"), Quadrant(-180.0f) == EMovementDirection::MD_Backward);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,183 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AnimEventSubsystem.h"
+
+#include "DayOne/DayOne.h"
+#include "Engine/World.h"
+
+static TAutoConsoleVariable<int32> CVarAnimEvents(
+	TEXT("DayOne.Anim.Events"),
+	1,
+	TEXT("Push the footstep, landing, turn in place and gait change events of the anim update to UAnimEventSubsystem."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarAnimEventsCapacity(
+	TEXT("DayOne.Anim.Events.Capacity"),
+	2048,
+	TEXT("Events the anim updates can push in one frame, read when the world starts. Further events are dropped."),
+	ECVF_Default);
+
+DECLARE_CYCLE_STAT(TEXT("Anim Event Dispatch"), STAT_AnimEventDispatch, STATGROUP_DayOne);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Anim Events Dispatched"), STAT_AnimEventsDispatched, STATGROUP_DayOne);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Anim Events Dropped"), STAT_AnimEventsDropped, STATGROUP_DayOne);
+
+void FAnimEventQueue::Allocate(int32 Capacity)
+{
+	const uint32 NumSlots = FMath::RoundUpToPowerOfTwo(static_cast<uint32>(FMath::Max(Capacity, 2)));
+	Slots = MakeUnique<FSlot[]>(NumSlots);
+	Mask = NumSlots - 1;
+	for (uint32 Index = 0; Index < NumSlots; ++Index)
+	{
+		Slots[Index].Sequence.store(Index, std::memory_order_relaxed);
+	}
+	EnqueuePosition.store(0, std::memory_order_relaxed);
+	DequeuePosition = 0;
+}
+
+void FAnimEventQueue::Empty()
+{
+	Slots.Reset();
+	Mask = 0;
+	EnqueuePosition.store(0, std::memory_order_relaxed);
+	DequeuePosition = 0;
+}
+
+bool FAnimEventQueue::Enqueue(const FAnimEvent& Event)
+{
+	if (!Slots) return false;
+
+	// Claim a position, then write its slot and publish it to the consumer.
+	uint32 Position = EnqueuePosition.load(std::memory_order_relaxed);
+	FSlot* Slot;
+	for (;;)
+	{
+		Slot = &Slots[Position & Mask];
+		const int32 Diff = static_cast<int32>(Slot->Sequence.load(std::memory_order_acquire) - Position);
+		if (Diff == 0)
+		{
+			if (EnqueuePosition.compare_exchange_weak(Position, Position + 1, std::memory_order_relaxed)) break;
+		}
+		else if (Diff < 0)
+		{
+			// The slot still holds the event of the previous lap: full.
+			return false;
+		}
+		else
+		{
+			Position = EnqueuePosition.load(std::memory_order_relaxed);
+		}
+	}
+
+	Slot->Event = Event;
+	Slot->Sequence.store(Position + 1, std::memory_order_release);
+	return true;
+}
+
+bool FAnimEventQueue::Dequeue(FAnimEvent& OutEvent)
+{
+	if (!Slots) return false;
+
+	FSlot& Slot = Slots[DequeuePosition & Mask];
+	if (Slot.Sequence.load(std::memory_order_acquire) != DequeuePosition + 1) return false;
+
+	OutEvent = MoveTemp(Slot.Event);
+	// Free the slot for the producers of the next lap.
+	Slot.Sequence.store(DequeuePosition + Mask + 1, std::memory_order_release);
+	++DequeuePosition;
+	return true;
+}
+
+void FAnimEventTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Subsystem && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Subsystem->DispatchEvents();
+	}
+}
+
+FString FAnimEventTickFunction::DiagnosticMessage()
+{
+	return TEXT("FAnimEventTickFunction");
+}
+
+void UAnimEventSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Events.Allocate(CVarAnimEventsCapacity.GetValueOnGameThread());
+	NumDropped.store(0, std::memory_order_relaxed);
+}
+
+void UAnimEventSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Every mesh tick, and the parallel animation update it waits for, is done by then.
+	DispatchTickFunction.Subsystem = this;
+	DispatchTickFunction.TickGroup = TG_PostUpdateWork;
+	DispatchTickFunction.bCanEverTick = true;
+	DispatchTickFunction.bStartWithTickEnabled = true;
+	DispatchTickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+}
+
+void UAnimEventSubsystem::Deinitialize()
+{
+	if (DispatchTickFunction.IsTickFunctionRegistered())
+	{
+		DispatchTickFunction.UnRegisterTickFunction();
+	}
+	DispatchTickFunction.Subsystem = nullptr;
+
+	Events.Empty();
+	for (FOnAnimEvent& Delegate : Delegates)
+	{
+		Delegate.Clear();
+	}
+
+	Super::Deinitialize();
+}
+
+bool UAnimEventSubsystem::IsEnabled()
+{
+	return CVarAnimEvents.GetValueOnAnyThread() != 0;
+}
+
+void UAnimEventSubsystem::Push(const FAnimEvent& Event)
+{
+	check(Event.Type < EAnimEventType::Num);
+	if (!Events.Enqueue(Event))
+	{
+		NumDropped.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+UAnimEventSubsystem::FOnAnimEvent& UAnimEventSubsystem::OnAnimEvent(EAnimEventType Type)
+{
+	check(IsInGameThread());
+	check(Type < EAnimEventType::Num);
+	return Delegates[static_cast<int32>(Type)];
+}
+
+void UAnimEventSubsystem::DispatchEvents()
+{
+	SCOPE_CYCLE_COUNTER(STAT_AnimEventDispatch);
+
+	int32 NumDispatched = 0;
+	FAnimEvent Event;
+	while (Events.Dequeue(Event))
+	{
+		if (!Event.Actor.IsValid()) continue;
+
+		Delegates[static_cast<int32>(Event.Type)].Broadcast(Event);
+		++NumDispatched;
+	}
+
+	SET_DWORD_STAT(STAT_AnimEventsDispatched, NumDispatched);
+	SET_DWORD_STAT(STAT_AnimEventsDropped, NumDropped.exchange(0, std::memory_order_relaxed));
+}
+
+bool UAnimEventSubsystem::DoesSupportWorldType(EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
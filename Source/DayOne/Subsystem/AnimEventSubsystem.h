@@ -0,0 +1,129 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AnimEventSubsystem.generated.h"
+
+class UAnimEventSubsystem;
+
+// What the anim update detected.
+enum class EAnimEventType : uint8
+{
+	// A foot lock alpha reached 1: a footstep. Param is the foot, 0 left and 1 right.
+	FootLocked,
+	FootUnlocked,
+	// The character went from in air to grounded. Value is the last fall speed (negative when falling).
+	Landed,
+	// A turn in place was started. Value is the turn angle, Param the EStanceState.
+	TurnInPlace,
+	// Value is the speed, Param the new EGaitState.
+	GaitChanged,
+	Num
+};
+
+// One event, small enough to be pushed from the anim worker threads every frame.
+struct FAnimEvent
+{
+	TWeakObjectPtr<AActor> Actor;
+	// World location: the foot for the foot events, the mesh otherwise.
+	FVector3f Location = FVector3f::ZeroVector;
+	float Value = 0.0f;
+	EAnimEventType Type = EAnimEventType::Num;
+	uint8 Param = 0;
+};
+
+// Bounded lock-free queue of events, many producers and a single consumer.
+// The slots are allocated once, so pushing never allocates. A push to a full queue fails.
+struct FAnimEventQueue
+{
+	// Capacity is rounded up to a power of two. Not thread-safe, call before any push.
+	void Allocate(int32 Capacity);
+	void Empty();
+
+	// Any thread. False if the queue is full.
+	bool Enqueue(const FAnimEvent& Event);
+	// Consumer thread only. False if the queue is empty, or the next event is still being written.
+	bool Dequeue(FAnimEvent& OutEvent);
+
+private:
+	struct FSlot
+	{
+		// Equals the position of the slot when it is free to write, the position + 1 once it holds an event.
+		std::atomic<uint32> Sequence{0};
+		FAnimEvent Event;
+	};
+
+	TUniquePtr<FSlot[]> Slots;
+	uint32 Mask = 0;
+	std::atomic<uint32> EnqueuePosition{0};
+	uint32 DequeuePosition = 0;
+};
+
+// Dispatches the events pushed during the frame, after the animation update.
+USTRUCT()
+struct FAnimEventTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	UAnimEventSubsystem* Subsystem = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FAnimEventTickFunction> : public TStructOpsTypeTraitsBase2<FAnimEventTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * Carries the events the anim instances detect in their thread-safe update (footsteps, landings, turns in place, gait changes)
+ * to the game thread, so footstep audio, VFX and telemetry react to them without polling the anim instances.
+ * The anim worker threads push into one preallocated lock-free MPSC ring of DayOne.Anim.Events.Capacity events,
+ * the game thread drains it once per frame in TG_PostUpdateWork and calls the delegate of each event type.
+ * Events pushed after that are dispatched the next frame, events pushed to a full ring are dropped.
+ * Turn off with DayOne.Anim.Events.
+ */
+UCLASS()
+class DAYONE_API UAnimEventSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	friend struct FAnimEventTickFunction;
+
+	DECLARE_MULTICAST_DELEGATE_OneParam(FOnAnimEvent, const FAnimEvent&);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	// Is pushing enabled by DayOne.Anim.Events? Any thread.
+	static bool IsEnabled();
+
+	// Any thread.
+	void Push(const FAnimEvent& Event);
+
+	// Game thread. Broadcast for every event of Type whose actor is still alive.
+	FOnAnimEvent& OnAnimEvent(EAnimEventType Type);
+
+protected:
+	virtual bool DoesSupportWorldType(EWorldType::Type WorldType) const override;
+
+private:
+	void DispatchEvents();
+
+	FAnimEventQueue Events;
+	// Pushes that found the ring full since the last dispatch.
+	std::atomic<int32> NumDropped{0};
+	FOnAnimEvent Delegates[static_cast<int32>(EAnimEventType::Num)];
+
+	FAnimEventTickFunction DispatchTickFunction;
+};
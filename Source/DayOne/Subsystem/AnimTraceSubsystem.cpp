@@ -0,0 +1,228 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AnimTraceSubsystem.h"
+
+#include "Components/SkeletalMeshComponent.h"
+#include "DayOne/DayOne.h"
+#include "Engine/World.h"
+
+static TAutoConsoleVariable<int32> CVarFootIKAsyncTraces(
+	TEXT("DayOne.FootIK.AsyncTraces"),
+	1,
+	TEXT("How the foot IK ground traces are run.\n")
+	TEXT(" 0: every anim instance traces synchronously in its update\n")
+	TEXT(" 1: UAnimTraceSubsystem runs all traces as one async batch, results are one frame old (default)"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarFootIKTraceSkipDistance(
+	TEXT("DayOne.FootIK.TraceSkipDistance"),
+	0.5f,
+	TEXT("Distance (cm) a foot trace has to move before it is traced again, closer requests keep the last result. 0 traces every frame."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarLandPredictionAsyncSweeps(
+	TEXT("DayOne.LandPrediction.AsyncSweeps"),
+	1,
+	TEXT("How the land prediction sweeps of falling characters are run.\n")
+	TEXT(" 0: every anim instance sweeps synchronously in each update\n")
+	TEXT(" 1: UAnimTraceSubsystem runs the sweeps as async traces at DayOne.LandPrediction.SweepRate (default)"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarLandPredictionSweepRate(
+	TEXT("DayOne.LandPrediction.SweepRate"),
+	20.0f,
+	TEXT("Land prediction sweeps per second of a falling character, the hit is extrapolated with the fall velocity in between."),
+	ECVF_Default);
+
+DECLARE_CYCLE_STAT(TEXT("Anim Trace Collect"), STAT_AnimTraceCollect, STATGROUP_DayOne);
+DECLARE_CYCLE_STAT(TEXT("Anim Trace Submit"), STAT_AnimTraceSubmit, STATGROUP_DayOne);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Foot Traces Submitted"), STAT_FootTracesSubmitted, STATGROUP_DayOne);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Foot Traces Skipped"), STAT_FootTracesSkipped, STATGROUP_DayOne);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Land Prediction Sweeps Submitted"), STAT_LandPredictionSweepsSubmitted, STATGROUP_DayOne);
+
+const FName FLandPredictionSweep::ProfileName(TEXT("ALS_Character"));
+
+void FAnimTraceTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Subsystem && TickType != LEVELTICK_ViewportsOnly)
+	{
+		if (bSubmit)
+		{
+			Subsystem->SubmitTraces();
+		}
+		else
+		{
+			Subsystem->CollectResults();
+		}
+	}
+}
+
+FString FAnimTraceTickFunction::DiagnosticMessage()
+{
+	return bSubmit ? TEXT("FAnimTraceTickFunction[Submit]") : TEXT("FAnimTraceTickFunction[Collect]");
+}
+
+void UAnimTraceSubsystem::Deinitialize()
+{
+	for (FAnimTraceTickFunction* TickFunction : { &CollectTickFunction, &SubmitTickFunction })
+	{
+		if (TickFunction->IsTickFunctionRegistered())
+		{
+			TickFunction->UnRegisterTickFunction();
+		}
+		TickFunction->Subsystem = nullptr;
+	}
+
+	TraceSets.Reset();
+
+	Super::Deinitialize();
+}
+
+bool UAnimTraceSubsystem::IsAsyncFootTraceEnabled()
+{
+	return CVarFootIKAsyncTraces.GetValueOnAnyThread() == 1;
+}
+
+bool UAnimTraceSubsystem::IsAsyncLandPredictionEnabled()
+{
+	return CVarLandPredictionAsyncSweeps.GetValueOnAnyThread() == 1;
+}
+
+float UAnimTraceSubsystem::GetLandPredictionSweepInterval()
+{
+	return 1.0f / FMath::Max(CVarLandPredictionSweepRate.GetValueOnAnyThread(), 1.0f);
+}
+
+void UAnimTraceSubsystem::RegisterTraceSet(FAnimTraceSet* TraceSet, USkeletalMeshComponent* Mesh)
+{
+	check(IsInGameThread());
+	check(TraceSet && Mesh);
+
+	if (!CollectTickFunction.IsTickFunctionRegistered())
+	{
+		// Before the meshes, which are made to wait for it below.
+		CollectTickFunction.Subsystem = this;
+		CollectTickFunction.bSubmit = false;
+		CollectTickFunction.TickGroup = TG_PrePhysics;
+		CollectTickFunction.bCanEverTick = true;
+		CollectTickFunction.bStartWithTickEnabled = true;
+		CollectTickFunction.RegisterTickFunction(GetWorld()->PersistentLevel);
+
+		// Every mesh tick, and the parallel animation update it waits for, is done by then.
+		SubmitTickFunction.Subsystem = this;
+		SubmitTickFunction.bSubmit = true;
+		SubmitTickFunction.TickGroup = TG_PostUpdateWork;
+		SubmitTickFunction.bCanEverTick = true;
+		SubmitTickFunction.bStartWithTickEnabled = true;
+		SubmitTickFunction.RegisterTickFunction(GetWorld()->PersistentLevel);
+	}
+
+	TraceSet->Mesh = Mesh;
+	TraceSets.AddUnique(TraceSet);
+
+	Mesh->PrimaryComponentTick.AddPrerequisite(this, CollectTickFunction);
+}
+
+void UAnimTraceSubsystem::UnregisterTraceSet(FAnimTraceSet* TraceSet, USkeletalMeshComponent* Mesh)
+{
+	check(IsInGameThread());
+
+	TraceSets.RemoveSingleSwap(TraceSet);
+	TraceSet->Mesh = nullptr;
+
+	if (Mesh)
+	{
+		Mesh->PrimaryComponentTick.RemovePrerequisite(this, CollectTickFunction);
+	}
+}
+
+bool UAnimTraceSubsystem::DoesSupportWorldType(EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UAnimTraceSubsystem::CollectResults()
+{
+	SCOPE_CYCLE_COUNTER(STAT_AnimTraceCollect);
+
+	UWorld* World = GetWorld();
+	FTraceDatum TraceDatum;
+	for (FAnimTraceSet* TraceSet : TraceSets)
+	{
+		for (FFootTrace& Foot : TraceSet->Feet)
+		{
+			if (!Foot.Handle.IsValid()) continue;
+
+			if (World->QueryTraceData(Foot.Handle, TraceDatum))
+			{
+				// A single trace without a blocking hit returns no hit.
+				Foot.HitResult = TraceDatum.OutHits.Num() > 0 ? TraceDatum.OutHits[0] : FHitResult();
+				Foot.bHasResult = true;
+				Foot.bResultUpToDate = true;
+			}
+			else
+			{
+				// The result was lost, e.g. the world was paused for a frame. Keep the last one and trace again.
+				Foot.bResultUpToDate = false;
+			}
+			Foot.Handle = FTraceHandle();
+		}
+
+		FLandPredictionSweep& LandPrediction = TraceSet->LandPrediction;
+		if (LandPrediction.Handle.IsValid())
+		{
+			// A lost result is not retried, the next sweep is due soon.
+			if (World->QueryTraceData(LandPrediction.Handle, TraceDatum))
+			{
+				LandPrediction.HitResult = TraceDatum.OutHits.Num() > 0 ? TraceDatum.OutHits[0] : FHitResult();
+				LandPrediction.bHasResult = true;
+			}
+			LandPrediction.Handle = FTraceHandle();
+		}
+	}
+}
+
+void UAnimTraceSubsystem::SubmitTraces()
+{
+	SCOPE_CYCLE_COUNTER(STAT_AnimTraceSubmit);
+
+	UWorld* World = GetWorld();
+	const float SkipDistanceSquared = FMath::Square(CVarFootIKTraceSkipDistance.GetValueOnGameThread());
+	int32 NumSubmitted = 0;
+	int32 NumSkipped = 0;
+	int32 NumSweeps = 0;
+	for (FAnimTraceSet* TraceSet : TraceSets)
+	{
+		for (FFootTrace& Foot : TraceSet->Feet)
+		{
+			if (!Foot.bRequested) continue;
+			Foot.bRequested = false;
+
+			if (Foot.bResultUpToDate
+				&& FVector::DistSquared(Foot.Start, Foot.TracedStart) < SkipDistanceSquared
+				&& FVector::DistSquared(Foot.End, Foot.TracedEnd) < SkipDistanceSquared)
+			{
+				++NumSkipped;
+				continue;
+			}
+
+			Foot.Handle = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Foot.Start, Foot.End, ECC_Visibility, TraceSet->QueryParams);
+			Foot.TracedStart = Foot.Start;
+			Foot.TracedEnd = Foot.End;
+			++NumSubmitted;
+		}
+
+		FLandPredictionSweep& LandPrediction = TraceSet->LandPrediction;
+		if (LandPrediction.bRequested)
+		{
+			LandPrediction.bRequested = false;
+			LandPrediction.Handle = World->AsyncSweepByProfile(EAsyncTraceType::Single, LandPrediction.Start, LandPrediction.End, FQuat::Identity,
+			                                                   FLandPredictionSweep::ProfileName, LandPrediction.Shape, TraceSet->QueryParams);
+			++NumSweeps;
+		}
+	}
+	SET_DWORD_STAT(STAT_FootTracesSubmitted, NumSubmitted);
+	SET_DWORD_STAT(STAT_FootTracesSkipped, NumSkipped);
+	SET_DWORD_STAT(STAT_LandPredictionSweepsSubmitted, NumSweeps);
+}
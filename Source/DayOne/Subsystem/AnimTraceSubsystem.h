@@ -0,0 +1,140 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CollisionQueryParams.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Engine/HitResult.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "AnimTraceSubsystem.generated.h"
+
+class UAnimTraceSubsystem;
+
+// Ground trace of one foot.
+// The anim update writes the request, UAnimTraceSubsystem traces it after the frame's animation
+// and hands the hit back before the next one, so the result is one frame old.
+struct FFootTrace
+{
+	// Written by the anim update.
+	FVector Start = FVector::ZeroVector;
+	FVector End = FVector::ZeroVector;
+	bool bRequested = false;
+
+	// Written by the subsystem, read by the anim update.
+	FHitResult HitResult;
+	bool bHasResult = false;
+
+private:
+	friend UAnimTraceSubsystem;
+
+	// The trace in flight, and where the current result was traced from.
+	FTraceHandle Handle;
+	FVector TracedStart = FVector::ZeroVector;
+	FVector TracedEnd = FVector::ZeroVector;
+	bool bResultUpToDate = false;
+};
+
+// Land prediction capsule sweep of a falling character.
+// Requested at DayOne.LandPrediction.SweepRate, the anim update extrapolates the hit between two results.
+struct FLandPredictionSweep
+{
+	// Collision profile of the swept capsule.
+	static const FName ProfileName;
+
+	// Written by the anim update.
+	FVector Start = FVector::ZeroVector;
+	FVector End = FVector::ZeroVector;
+	FCollisionShape Shape;
+	bool bRequested = false;
+
+	// Written by the subsystem, read by the anim update, which clears bHasResult on landing.
+	FHitResult HitResult;
+	bool bHasResult = false;
+
+private:
+	friend UAnimTraceSubsystem;
+
+	FTraceHandle Handle;
+};
+
+// The traces of one character, owned by its anim instance.
+struct FAnimTraceSet
+{
+	enum { Left, Right, Num };
+
+	FFootTrace Feet[Num];
+	FLandPredictionSweep LandPrediction;
+	// Built once, ignores the character.
+	FCollisionQueryParams QueryParams;
+
+private:
+	friend UAnimTraceSubsystem;
+
+	const USkeletalMeshComponent* Mesh = nullptr;
+};
+
+// Collects the results of last frame's traces before the meshes update their animation (bSubmit false),
+// or submits the traces requested by this frame's animation (bSubmit true).
+USTRUCT()
+struct FAnimTraceTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	UAnimTraceSubsystem* Subsystem = nullptr;
+	bool bSubmit = false;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FAnimTraceTickFunction> : public TStructOpsTypeTraitsBase2<FAnimTraceTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * Runs the foot IK ground traces and land prediction sweeps of every character as one batch of async traces.
+ * The anim instances only write their trace requests on the worker threads,
+ * the requests are submitted together after the animation update, and the hits are collected before the next one.
+ * A foot that moved less than DayOne.FootIK.TraceSkipDistance since its last trace keeps its last result.
+ * Switch between this and synchronous traces in the anim update with DayOne.FootIK.AsyncTraces and DayOne.LandPrediction.AsyncSweeps.
+ */
+UCLASS()
+class DAYONE_API UAnimTraceSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	friend struct FAnimTraceTickFunction;
+
+	virtual void Deinitialize() override;
+
+	// Is the async path selected by DayOne.FootIK.AsyncTraces?
+	static bool IsAsyncFootTraceEnabled();
+	// Is the async path selected by DayOne.LandPrediction.AsyncSweeps?
+	static bool IsAsyncLandPredictionEnabled();
+	// Time between two land prediction sweeps of a falling character.
+	static float GetLandPredictionSweepInterval();
+
+	// TraceSet must stay valid until it is unregistered. The mesh waits for the results each frame.
+	void RegisterTraceSet(FAnimTraceSet* TraceSet, USkeletalMeshComponent* Mesh);
+	void UnregisterTraceSet(FAnimTraceSet* TraceSet, USkeletalMeshComponent* Mesh);
+
+protected:
+	virtual bool DoesSupportWorldType(EWorldType::Type WorldType) const override;
+
+private:
+	void CollectResults();
+	void SubmitTraces();
+
+	TArray<FAnimTraceSet*> TraceSets;
+
+	FAnimTraceTickFunction CollectTickFunction;
+	FAnimTraceTickFunction SubmitTickFunction;
+};
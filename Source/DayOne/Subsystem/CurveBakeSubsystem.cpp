@@ -0,0 +1,234 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CurveBakeSubsystem.h"
+
+#include "Curves/CurveFloat.h"
+#include "Curves/CurveVector.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UObjectGlobals.h"
+
+static TAutoConsoleVariable<float> CVarCurveBakeErrorTolerance(
+	TEXT("DayOne.CurveBake.ErrorTolerance"),
+	0.01f,
+	TEXT("Fraction of its value range a baked curve may differ from its authoring curve before its bake logs a warning."),
+	ECVF_Default);
+
+// Points checked against the authoring curve between two samples when measuring the error of a bake.
+static constexpr int32 ErrorChecksPerSample = 4;
+
+static void LogBake(const UCurveBase& Curve, const FBakedCurve& BakedCurve, float ValueRange)
+{
+	const float Tolerance = CVarCurveBakeErrorTolerance.GetValueOnGameThread() * ValueRange;
+	if (BakedCurve.MaxError > FMath::Max(Tolerance, KINDA_SMALL_NUMBER))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Baked %s: max error %f over a value range of %f, above the tolerance of %f. ")
+		       TEXT("Its keys change faster than %d samples over [%f, %f] follow."),
+		       *Curve.GetPathName(), BakedCurve.MaxError, ValueRange, Tolerance, FBakedCurve::NumSamples, BakedCurve.MinTime, BakedCurve.MaxTime);
+		return;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Baked %s: %d samples over [%f, %f], max error %f"),
+	       *Curve.GetPathName(), FBakedCurve::NumSamples, BakedCurve.MinTime, BakedCurve.MaxTime, BakedCurve.MaxError);
+}
+
+void UCurveBakeSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddUObject(this, &ThisClass::EvictUnusedCurves);
+}
+
+void UCurveBakeSubsystem::Deinitialize()
+{
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+
+#if WITH_EDITOR
+	for (const TPair<TObjectKey<UCurveBase>, FDelegateHandle>& Pair : CurveUpdatedHandles)
+	{
+		if (UCurveBase* Curve = Pair.Key.ResolveObjectPtr())
+		{
+			Curve->OnUpdateCurve.Remove(Pair.Value);
+		}
+	}
+	CurveUpdatedHandles.Reset();
+#endif
+
+	FloatCurves.Reset();
+	VectorCurves.Reset();
+
+	Super::Deinitialize();
+}
+
+TSharedPtr<const FBakedCurveFloat> UCurveBakeSubsystem::GetBakedCurve(const UCurveFloat* Curve)
+{
+	check(IsInGameThread());
+	if (!Curve) return nullptr;
+
+	if (const TSharedRef<FBakedCurveFloat>* ExistingCurve = FloatCurves.Find(Curve))
+	{
+		return *ExistingCurve;
+	}
+
+	TSharedRef<FBakedCurveFloat> BakedCurve = MakeShared<FBakedCurveFloat>();
+	BakeCurve(*Curve, BakedCurve.Get());
+	FloatCurves.Add(Curve, BakedCurve);
+
+#if WITH_EDITOR
+	WatchCurve(Curve);
+#endif
+
+	return BakedCurve;
+}
+
+TSharedPtr<const FBakedCurveVector> UCurveBakeSubsystem::GetBakedCurve(const UCurveVector* Curve)
+{
+	check(IsInGameThread());
+	if (!Curve) return nullptr;
+
+	if (const TSharedRef<FBakedCurveVector>* ExistingCurve = VectorCurves.Find(Curve))
+	{
+		return *ExistingCurve;
+	}
+
+	TSharedRef<FBakedCurveVector> BakedCurve = MakeShared<FBakedCurveVector>();
+	BakeCurve(*Curve, BakedCurve.Get());
+	VectorCurves.Add(Curve, BakedCurve);
+
+#if WITH_EDITOR
+	WatchCurve(Curve);
+#endif
+
+	return BakedCurve;
+}
+
+void UCurveBakeSubsystem::InitializeSampling(const UCurveBase& Curve, FBakedCurve& OutBakedCurve)
+{
+	float MinTime, MaxTime;
+	Curve.GetTimeRange(MinTime, MaxTime);
+
+	OutBakedCurve.MinTime = MinTime;
+	OutBakedCurve.MaxTime = MaxTime;
+	// A curve with a single key is constant, every sample holds the same value.
+	OutBakedCurve.InvSampleStep = MaxTime > MinTime ? (FBakedCurve::NumSamples - 1) / (MaxTime - MinTime) : 0.0f;
+	OutBakedCurve.MaxError = 0.0f;
+}
+
+void UCurveBakeSubsystem::BakeCurve(const UCurveFloat& Curve, FBakedCurveFloat& OutBakedCurve)
+{
+	InitializeSampling(Curve, OutBakedCurve);
+	const float Range = OutBakedCurve.MaxTime - OutBakedCurve.MinTime;
+
+	float MinValue = MAX_flt;
+	float MaxValue = -MAX_flt;
+	OutBakedCurve.Values.SetNumUninitialized(FBakedCurve::NumSamples);
+	for (int32 Index = 0; Index < FBakedCurve::NumSamples; ++Index)
+	{
+		const float Time = OutBakedCurve.MinTime + Range * Index / (FBakedCurve::NumSamples - 1);
+		OutBakedCurve.Values[Index] = Curve.GetFloatValue(Time);
+		MinValue = FMath::Min(MinValue, OutBakedCurve.Values[Index]);
+		MaxValue = FMath::Max(MaxValue, OutBakedCurve.Values[Index]);
+	}
+
+	const int32 NumChecks = (FBakedCurve::NumSamples - 1) * ErrorChecksPerSample;
+	for (int32 CheckIndex = 0; CheckIndex <= NumChecks; ++CheckIndex)
+	{
+		const float Time = OutBakedCurve.MinTime + Range * CheckIndex / NumChecks;
+		const float Error = FMath::Abs(Curve.GetFloatValue(Time) - OutBakedCurve.Evaluate(Time));
+		OutBakedCurve.MaxError = FMath::Max(OutBakedCurve.MaxError, Error);
+	}
+
+	LogBake(Curve, OutBakedCurve, MaxValue - MinValue);
+}
+
+void UCurveBakeSubsystem::BakeCurve(const UCurveVector& Curve, FBakedCurveVector& OutBakedCurve)
+{
+	InitializeSampling(Curve, OutBakedCurve);
+	const float Range = OutBakedCurve.MaxTime - OutBakedCurve.MinTime;
+
+	// The error is the largest of the three axes, so is the range.
+	FVector MinValues(MAX_flt);
+	FVector MaxValues(-MAX_flt);
+	OutBakedCurve.Values.SetNumUninitialized(FBakedCurve::NumSamples);
+	for (int32 Index = 0; Index < FBakedCurve::NumSamples; ++Index)
+	{
+		const float Time = OutBakedCurve.MinTime + Range * Index / (FBakedCurve::NumSamples - 1);
+		const FVector Value = Curve.GetVectorValue(Time);
+		OutBakedCurve.Values[Index] = MakeVectorRegisterFloat(static_cast<float>(Value.X), static_cast<float>(Value.Y), static_cast<float>(Value.Z), 0.0f);
+		MinValues = MinValues.ComponentMin(Value);
+		MaxValues = MaxValues.ComponentMax(Value);
+	}
+
+	const int32 NumChecks = (FBakedCurve::NumSamples - 1) * ErrorChecksPerSample;
+	for (int32 CheckIndex = 0; CheckIndex <= NumChecks; ++CheckIndex)
+	{
+		const float Time = OutBakedCurve.MinTime + Range * CheckIndex / NumChecks;
+		const float Error = (Curve.GetVectorValue(Time) - OutBakedCurve.Evaluate(Time)).GetAbsMax();
+		OutBakedCurve.MaxError = FMath::Max(OutBakedCurve.MaxError, Error);
+	}
+
+	LogBake(Curve, OutBakedCurve, static_cast<float>((MaxValues - MinValues).GetMax()));
+}
+
+void UCurveBakeSubsystem::EvictUnusedCurves()
+{
+	// Only this subsystem holds a unique table, its readers are gone.
+	for (auto It = FloatCurves.CreateIterator(); It; ++It)
+	{
+		if (It->Value.IsUnique() || !It->Key.ResolveObjectPtr())
+		{
+			It.RemoveCurrent();
+		}
+	}
+	for (auto It = VectorCurves.CreateIterator(); It; ++It)
+	{
+		if (It->Value.IsUnique() || !It->Key.ResolveObjectPtr())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+#if WITH_EDITOR
+	for (auto It = CurveUpdatedHandles.CreateIterator(); It; ++It)
+	{
+		UCurveBase* Curve = It->Key.ResolveObjectPtr();
+		if (Curve && (FloatCurves.Contains(Cast<UCurveFloat>(Curve)) || VectorCurves.Contains(Cast<UCurveVector>(Curve))))
+		{
+			continue;
+		}
+		if (Curve)
+		{
+			Curve->OnUpdateCurve.Remove(It->Value);
+		}
+		It.RemoveCurrent();
+	}
+#endif
+}
+
+#if WITH_EDITOR
+void UCurveBakeSubsystem::WatchCurve(const UCurveBase* Curve)
+{
+	if (CurveUpdatedHandles.Contains(Curve)) return;
+
+	UCurveBase* MutableCurve = const_cast<UCurveBase*>(Curve);
+	CurveUpdatedHandles.Add(Curve, MutableCurve->OnUpdateCurve.AddUObject(this, &ThisClass::OnCurveUpdated));
+}
+
+void UCurveBakeSubsystem::OnCurveUpdated(UCurveBase* Curve, EPropertyChangeType::Type ChangeType)
+{
+	if (const UCurveFloat* FloatCurve = Cast<UCurveFloat>(Curve))
+	{
+		if (TSharedRef<FBakedCurveFloat>* BakedCurve = FloatCurves.Find(FloatCurve))
+		{
+			BakeCurve(*FloatCurve, BakedCurve->Get());
+		}
+	}
+	else if (const UCurveVector* VectorCurve = Cast<UCurveVector>(Curve))
+	{
+		if (TSharedRef<FBakedCurveVector>* BakedCurve = VectorCurves.Find(VectorCurve))
+		{
+			BakeCurve(*VectorCurve, BakedCurve->Get());
+		}
+	}
+}
+#endif
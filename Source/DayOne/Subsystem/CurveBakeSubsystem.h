@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/EngineSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "DayOne/Data/BakedCurve.h"
+#include "CurveBakeSubsystem.generated.h"
+
+class UCurveBase;
+class UCurveFloat;
+class UCurveVector;
+
+/**
+ * Bakes the curves evaluated on the per-frame hot path into fixed resolution lookup tables.
+ * Every curve is baked once, the first time it is asked for, and the same table is shared by every reader.
+ * The error against the authoring curve is logged at bake time.
+ * In editor, a table is rebaked in place when its curve is edited, so references into it stay valid.
+ * After every garbage collection, the tables of destroyed curves and the tables no reader holds any more are released.
+ */
+UCLASS()
+class DAYONE_API UCurveBakeSubsystem : public UEngineSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// Return nullptr for a null curve.
+	TSharedPtr<const FBakedCurveFloat> GetBakedCurve(const UCurveFloat* Curve);
+	TSharedPtr<const FBakedCurveVector> GetBakedCurve(const UCurveVector* Curve);
+
+private:
+	static void BakeCurve(const UCurveFloat& Curve, FBakedCurveFloat& OutBakedCurve);
+	static void BakeCurve(const UCurveVector& Curve, FBakedCurveVector& OutBakedCurve);
+	static void InitializeSampling(const UCurveBase& Curve, FBakedCurve& OutBakedCurve);
+
+	void EvictUnusedCurves();
+	FDelegateHandle PostGarbageCollectHandle;
+
+#if WITH_EDITOR
+	void WatchCurve(const UCurveBase* Curve);
+	void OnCurveUpdated(UCurveBase* Curve, EPropertyChangeType::Type ChangeType);
+
+	TMap<TObjectKey<UCurveBase>, FDelegateHandle> CurveUpdatedHandles;
+#endif
+
+	TMap<TObjectKey<UCurveFloat>, TSharedRef<FBakedCurveFloat>> FloatCurves;
+	TMap<TObjectKey<UCurveVector>, TSharedRef<FBakedCurveVector>> VectorCurves;
+};
@@ -0,0 +1,709 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LocomotionSubsystem.h"
+
+#include "Async/ParallelFor.h"
+#include "DayOne/DayOne.h"
+#include "DayOne/Character/BaseAnimInstance.h"
+#include "DayOne/Character/BaseCharacter.h"
+#include "DayOne/Component/LocomotionComponent.h"
+#include "DayOne/Math/LocomotionMath.h"
+#include "GameFramework/PlayerController.h"
+#include "Kismet/KismetMathLibrary.h"
+#include "Misc/App.h"
+#include "Misc/Paths.h"
+
+static TAutoConsoleVariable<int32> CVarLocomotionUpdateMode(
+	TEXT("DayOne.Locomotion.UpdateMode"),
+	1,
+	TEXT("How the locomotion of characters is updated.\n")
+	TEXT(" 0: every ULocomotionComponent updates itself in TickComponent\n")
+	TEXT(" 1: ULocomotionSubsystem updates all characters in one batch (default)"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarLocomotionBatchChunkSize(
+	TEXT("DayOne.Locomotion.BatchChunkSize"),
+	8,
+	TEXT("Number of characters updated by one ParallelFor task in the batched locomotion update."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarLocomotionLODEnable(
+	TEXT("DayOne.Locomotion.LOD.Enable"),
+	1,
+	TEXT("On a dedicated server, update the locomotion of characters far from every player at a reduced rate."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarLocomotionLODDistance(
+	TEXT("DayOne.Locomotion.LOD.Distance"),
+	3000.0f,
+	TEXT("Distance (cm) to the closest player view point beyond which a character's locomotion runs at the reduced rate,\n")
+	TEXT("and a falling character does not predict its landing."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarLocomotionLODReducedRate(
+	TEXT("DayOne.Locomotion.LOD.ReducedRate"),
+	10.0f,
+	TEXT("Locomotion updates per second of characters at the reduced rate."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarLocomotionFlightRecorderHitchDumpMs(
+	TEXT("DayOne.Locomotion.FlightRecorder.HitchDumpMs"),
+	0.0f,
+	TEXT("Dump the locomotion flight recorders when a frame takes longer than this many milliseconds. 0 disables."),
+	ECVF_Default);
+
+static FAutoConsoleCommandWithWorldAndArgs LocomotionFlightRecorderDumpCommand(
+	TEXT("DayOne.Locomotion.FlightRecorder.Dump"),
+	TEXT("Write the locomotion flight recorder of every character to Saved/Locomotion. Usage: DayOne.Locomotion.FlightRecorder.Dump [Reason]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (const ULocomotionSubsystem* Subsystem = World ? World->GetSubsystem<ULocomotionSubsystem>() : nullptr)
+		{
+			Subsystem->DumpFlightRecorders(Args.Num() > 0 ? Args[0] : TEXT("Manual"));
+		}
+	}));
+
+static TAutoConsoleVariable<int32> CVarAnimParameterBatch(
+	TEXT("DayOne.Anim.ParameterBatch"),
+	1,
+	TEXT("Compute the velocity blend, lean, relative acceleration and aiming angle of visible characters in one SIMD batch,\n")
+	TEXT("instead of in each anim update. See also DayOne.Anim.ParameterBatch.Validate."),
+	ECVF_Default);
+
+// Minimum real time between two dumps on hitch, so a stall does not flood the disk.
+static constexpr double HitchDumpCooldown = 30.0;
+
+DECLARE_CYCLE_STAT(TEXT("Locomotion Batch Gather"), STAT_LocomotionBatchGather, STATGROUP_DayOne);
+DECLARE_CYCLE_STAT(TEXT("Locomotion Batch Update"), STAT_LocomotionBatchUpdate, STATGROUP_DayOne);
+DECLARE_CYCLE_STAT(TEXT("Locomotion Batch Scatter"), STAT_LocomotionBatchScatter, STATGROUP_DayOne);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Locomotion Batch Characters"), STAT_LocomotionBatchCharacters, STATGROUP_DayOne);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Locomotion Reduced Rate Characters"), STAT_LocomotionReducedRateCharacters, STATGROUP_DayOne);
+DECLARE_CYCLE_STAT(TEXT("Anim Parameter Batch"), STAT_AnimParameterBatch, STATGROUP_DayOne);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Anim Parameter Batch Characters"), STAT_AnimParameterBatchCharacters, STATGROUP_DayOne);
+
+void FLocomotionBatchTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Subsystem && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Subsystem->UpdateLocomotion(DeltaTime);
+		Subsystem->UpdateAnimParameters(DeltaTime);
+	}
+}
+
+FString FLocomotionBatchTickFunction::DiagnosticMessage()
+{
+	return TEXT("FLocomotionBatchTickFunction");
+}
+
+void FLocomotionBatchBuffers::SetNum(int32 Num)
+{
+	DeltaTime.SetNumUninitialized(Num);
+	Velocity.SetNumUninitialized(Num);
+	PreviousVelocity.SetNumUninitialized(Num);
+	MovementInput.SetNumUninitialized(Num);
+	MaxAcceleration.SetNumUninitialized(Num);
+	ControlRotation.SetNumUninitialized(Num);
+	ActorRotation.SetNumUninitialized(Num);
+	PreviousAimYaw.SetNumUninitialized(Num);
+	MovementState.SetNumUninitialized(Num);
+	MovementAction.SetNumUninitialized(Num);
+	Stance.SetNumUninitialized(Num);
+	RotationMode.SetNumUninitialized(Num);
+	DesiredGait.SetNumUninitialized(Num);
+	bHasAnyRootMotion.SetNumUninitialized(Num);
+	bSimulatedProxy.SetNumUninitialized(Num);
+	YawOffsetCurve.SetNumUninitialized(Num);
+	RotationAmountCurve.SetNumUninitialized(Num);
+	CurrentSettings.SetNumUninitialized(Num);
+
+	PhysicalAcceleration.SetNumUninitialized(Num);
+	Speed.SetNumUninitialized(Num);
+	bIsMoving.SetNumUninitialized(Num);
+	MovementInputAmount.SetNumUninitialized(Num);
+	bHasMovementInput.SetNumUninitialized(Num);
+	AimYawRate.SetNumUninitialized(Num);
+
+	LastVelocityRotation.SetNumUninitialized(Num);
+	LastMovementInputRotation.SetNumUninitialized(Num);
+	Gait.SetNumUninitialized(Num);
+	TargetRotation.SetNumUninitialized(Num);
+	InAirRotation.SetNumUninitialized(Num);
+
+	ActorInterpSpeed.SetNumUninitialized(Num);
+	bRotationChanged.SetNumUninitialized(Num);
+	NewActorRotation.SetNumUninitialized(Num);
+}
+
+void FAnimParameterBatchBuffers::SetNum(int32 Num)
+{
+	DeltaTime.SetNumUninitialized(Num);
+	VelocityX.SetNumUninitialized(Num);
+	VelocityY.SetNumUninitialized(Num);
+	VelocityZ.SetNumUninitialized(Num);
+	AccelerationX.SetNumUninitialized(Num);
+	AccelerationY.SetNumUninitialized(Num);
+	AccelerationZ.SetNumUninitialized(Num);
+	ActorYaw.SetNumUninitialized(Num);
+	AimingYaw.SetNumUninitialized(Num);
+	AimingPitch.SetNumUninitialized(Num);
+	MaxAcceleration.SetNumUninitialized(Num);
+	MaxBrakingDeceleration.SetNumUninitialized(Num);
+	VelocityBlendInterpSpeed.SetNumUninitialized(Num);
+	LeanInterpSpeed.SetNumUninitialized(Num);
+	VelocityBlendF.SetNumUninitialized(Num);
+	VelocityBlendB.SetNumUninitialized(Num);
+	VelocityBlendL.SetNumUninitialized(Num);
+	VelocityBlendR.SetNumUninitialized(Num);
+	LeanLR.SetNumUninitialized(Num);
+	LeanFB.SetNumUninitialized(Num);
+	TargetVelocityBlendF.SetNumUninitialized(Num);
+	TargetVelocityBlendB.SetNumUninitialized(Num);
+	TargetVelocityBlendL.SetNumUninitialized(Num);
+	TargetVelocityBlendR.SetNumUninitialized(Num);
+	RelativeAccelerationX.SetNumUninitialized(Num);
+	RelativeAccelerationY.SetNumUninitialized(Num);
+	RelativeAccelerationZ.SetNumUninitialized(Num);
+	NewVelocityBlendF.SetNumUninitialized(Num);
+	NewVelocityBlendB.SetNumUninitialized(Num);
+	NewVelocityBlendL.SetNumUninitialized(Num);
+	NewVelocityBlendR.SetNumUninitialized(Num);
+	NewLeanLR.SetNumUninitialized(Num);
+	NewLeanFB.SetNumUninitialized(Num);
+	AimingAngleX.SetNumUninitialized(Num);
+	AimingAngleY.SetNumUninitialized(Num);
+}
+
+void ULocomotionSubsystem::Deinitialize()
+{
+	if (BatchTickFunction.IsTickFunctionRegistered())
+	{
+		BatchTickFunction.UnRegisterTickFunction();
+	}
+	BatchTickFunction.Subsystem = nullptr;
+
+	Components.Reset();
+	BatchComponents.Reset();
+	AnimParameterInstances.Reset();
+
+	Super::Deinitialize();
+}
+
+bool ULocomotionSubsystem::IsBatchedUpdateEnabled()
+{
+	return CVarLocomotionUpdateMode.GetValueOnGameThread() == 1;
+}
+
+float ULocomotionSubsystem::GetReducedUpdateInterval()
+{
+	return 1.0f / FMath::Max(CVarLocomotionLODReducedRate.GetValueOnGameThread(), 1.0f);
+}
+
+void ULocomotionSubsystem::RegisterComponent(ULocomotionComponent* Component)
+{
+	check(Component && Component->Character && Component->Character->GetMesh());
+
+	if (!BatchTickFunction.IsTickFunctionRegistered())
+	{
+		BatchTickFunction.Subsystem = this;
+		BatchTickFunction.TickGroup = TG_PrePhysics;
+		BatchTickFunction.bCanEverTick = true;
+		BatchTickFunction.bStartWithTickEnabled = true;
+		BatchTickFunction.RegisterTickFunction(GetWorld()->PersistentLevel);
+	}
+
+	Components.AddUnique(Component);
+
+	// Run after the component has moved, and before the mesh updates its animation.
+	BatchTickFunction.AddPrerequisite(Component, Component->PrimaryComponentTick);
+	Component->Character->GetMesh()->PrimaryComponentTick.AddPrerequisite(this, BatchTickFunction);
+}
+
+void ULocomotionSubsystem::UnregisterComponent(ULocomotionComponent* Component)
+{
+	check(Component);
+
+	Components.RemoveSingleSwap(Component);
+
+	BatchTickFunction.RemovePrerequisite(Component, Component->PrimaryComponentTick);
+	if (Component->Character && Component->Character->GetMesh())
+	{
+		Component->Character->GetMesh()->PrimaryComponentTick.RemovePrerequisite(this, BatchTickFunction);
+	}
+}
+
+bool ULocomotionSubsystem::DoesSupportWorldType(EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void ULocomotionSubsystem::DumpFlightRecorders(const FString& Reason) const
+{
+	const FString Directory = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Locomotion"));
+	const FString Prefix = FString::Printf(TEXT("%s_%s_%s"), *FDateTime::Now().ToString(), *Reason,
+	                                       GetWorld()->GetNetMode() == NM_Client ? TEXT("Client") : TEXT("Server"));
+
+	int32 NumDumped = 0;
+	for (const ULocomotionComponent* Component : Components)
+	{
+		if (!IsValid(Component) || !Component->Character || !Component->GetFlightRecorder().IsRecording()) continue;
+
+		const FString Filename = FPaths::Combine(Directory, Prefix + TEXT("_") + Component->Character->GetName() + FLocomotionFlightRecorder::FileExtension);
+		if (Component->GetFlightRecorder().SaveToFile(Filename))
+		{
+			++NumDumped;
+		}
+		else
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Could not write locomotion flight record %s"), *Filename);
+		}
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Dumped %d locomotion flight records to %s (%s)"), NumDumped, *Directory, *Reason);
+}
+
+void ULocomotionSubsystem::UpdateLocomotion(float DeltaTime)
+{
+	const float HitchDumpMs = CVarLocomotionFlightRecorderHitchDumpMs.GetValueOnGameThread();
+	if (HitchDumpMs > 0.0f && FApp::GetDeltaTime() * 1000.0 > HitchDumpMs)
+	{
+		const double Now = FPlatformTime::Seconds();
+		if (Now - LastHitchDumpTime > HitchDumpCooldown)
+		{
+			LastHitchDumpTime = Now;
+			DumpFlightRecorders(TEXT("Hitch"));
+		}
+	}
+
+	// Both update paths follow the significance, the per-component one picks it up next tick.
+	UpdateSignificance();
+
+	if (!IsBatchedUpdateEnabled() || DeltaTime <= 0.0f) return;
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_LocomotionBatchGather);
+		Gather(DeltaTime);
+	}
+
+	const int32 NumCharacters = BatchComponents.Num();
+	SET_DWORD_STAT(STAT_LocomotionBatchCharacters, NumCharacters);
+	if (NumCharacters == 0) return;
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_LocomotionBatchUpdate);
+
+		const int32 ChunkSize = FMath::Max(1, CVarLocomotionBatchChunkSize.GetValueOnGameThread());
+		const int32 NumChunks = FMath::DivideAndRoundUp(NumCharacters, ChunkSize);
+		ParallelFor(NumChunks, [this, NumCharacters, ChunkSize](int32 ChunkIndex)
+		{
+			const int32 Start = ChunkIndex * ChunkSize;
+			const int32 End = FMath::Min(Start + ChunkSize, NumCharacters);
+			for (int32 Index = Start; Index < End; ++Index)
+			{
+				UpdateCharacter(Buffers, Index, Buffers.DeltaTime[Index]);
+			}
+		}, NumChunks > 1 ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_LocomotionBatchScatter);
+		Scatter();
+	}
+}
+
+void ULocomotionSubsystem::UpdateSignificance()
+{
+	const bool bEnabled = CVarLocomotionLODEnable.GetValueOnGameThread() != 0 && GetWorld()->GetNetMode() == NM_DedicatedServer;
+
+	// The distance is also read by the anim instances on clients, e.g. to skip the land prediction.
+	TArray<FVector, TInlineAllocator<16>> ViewLocations;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APlayerController* PlayerController = It->Get())
+		{
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+			ViewLocations.Add(ViewLocation);
+		}
+	}
+
+	const float LODDistanceSquared = FMath::Square(CVarLocomotionLODDistance.GetValueOnGameThread());
+	int32 NumReduced = 0;
+	for (ULocomotionComponent* Component : Components)
+	{
+		if (!IsValid(Component) || !Component->Character) continue;
+
+		bool bBeyondLODDistance = true;
+		const FVector Location = Component->Character->GetActorLocation();
+		for (const FVector& ViewLocation : ViewLocations)
+		{
+			if (FVector::DistSquared(Location, ViewLocation) < LODDistanceSquared)
+			{
+				bBeyondLODDistance = false;
+				break;
+			}
+		}
+
+		// Aiming characters are in combat and always stay at full rate.
+		const bool bReduced = bEnabled && bBeyondLODDistance && Component->RotationMode != ERotationMode::RM_Aiming;
+		Component->bBeyondLODDistance = bBeyondLODDistance;
+		Component->bReducedLocomotionRate = bReduced;
+		NumReduced += bReduced ? 1 : 0;
+	}
+	SET_DWORD_STAT(STAT_LocomotionReducedRateCharacters, NumReduced);
+}
+
+void ULocomotionSubsystem::Gather(float DeltaTime)
+{
+	// Only update the components that ticked their movement this frame,
+	// and that are due for an update at their rate.
+	BatchComponents.Reset();
+	for (ULocomotionComponent* Component : Components)
+	{
+		if (IsValid(Component) && Component->Character && Component->IsComponentTickEnabled())
+		{
+			if (Component->bLocomotionUpdateDue)
+			{
+				BatchComponents.Add(Component);
+			}
+			else
+			{
+				Component->InterpolateSkippedRotation(DeltaTime);
+				Component->PublishSnapshot();
+			}
+		}
+	}
+
+	Buffers.SetNum(BatchComponents.Num());
+
+	for (int32 Index = 0; Index < BatchComponents.Num(); ++Index)
+	{
+		const ULocomotionComponent* Component = BatchComponents[Index];
+		const ABaseCharacter* Character = Component->Character;
+
+		Buffers.DeltaTime[Index] = Component->LocomotionDeltaTime;
+		Buffers.Velocity[Index] = Character->GetVelocity();
+		Buffers.PreviousVelocity[Index] = Component->PreviousVelocity;
+		Buffers.MovementInput[Index] = Component->GetCurrentAcceleration();
+		Buffers.MaxAcceleration[Index] = Component->MaxAcceleration;
+		Buffers.ControlRotation[Index] = Character->GetControlRotation();
+		Buffers.ActorRotation[Index] = Character->GetActorRotation();
+		Buffers.PreviousAimYaw[Index] = Component->PreviousAimYaw;
+		Buffers.MovementState[Index] = Component->MovementState;
+		Buffers.MovementAction[Index] = Component->MovementAction;
+		Buffers.Stance[Index] = Component->Stance;
+		Buffers.RotationMode[Index] = Component->RotationMode;
+		Buffers.DesiredGait[Index] = Component->DesiredGait;
+		Buffers.bHasAnyRootMotion[Index] = Character->HasAnyRootMotion();
+		Buffers.bSimulatedProxy[Index] = Component->IsSimulatedProxy();
+		Buffers.YawOffsetCurve[Index] = Component->GetAnimCurveValue(ELocomotionCurve::YawOffset);
+		Buffers.RotationAmountCurve[Index] = Component->GetAnimCurveValue(ELocomotionCurve::RotationAmount);
+		Buffers.CurrentSettings[Index] = Component->CurrentMovementSettings;
+
+		Buffers.LastVelocityRotation[Index] = Component->LastVelocityRotation;
+		Buffers.LastMovementInputRotation[Index] = Component->LastMovementInputRotation;
+		Buffers.Gait[Index] = Component->Gait;
+		Buffers.TargetRotation[Index] = Component->TargetRotation;
+		Buffers.InAirRotation[Index] = Component->InAirRotation;
+	}
+}
+
+void ULocomotionSubsystem::UpdateCharacter(FLocomotionBatchBuffers& B, int32 Index, float DeltaTime)
+{
+	// Essential values, see ULocomotionComponent::SetEssentialValues.
+	const FVector& Velocity = B.Velocity[Index];
+	B.PhysicalAcceleration[Index] = (Velocity - B.PreviousVelocity[Index]) / DeltaTime;
+
+	const float Speed = FVector(Velocity.X, Velocity.Y, 0.0f).Length();
+	B.Speed[Index] = Speed;
+	B.bIsMoving[Index] = Speed > 1.0f;
+	if (B.bIsMoving[Index])
+	{
+		B.LastVelocityRotation[Index] = Velocity.ToOrientationRotator();
+	}
+
+	const FVector& MovementInput = B.MovementInput[Index];
+	const float MovementInputAmount = MovementInput.Length() / B.MaxAcceleration[Index];
+	B.MovementInputAmount[Index] = MovementInputAmount;
+	B.bHasMovementInput[Index] = MovementInputAmount > 0.0f;
+	if (B.bHasMovementInput[Index])
+	{
+		B.LastMovementInputRotation[Index] = MovementInput.ToOrientationRotator();
+	}
+
+	B.AimYawRate[Index] = FMath::Abs((B.ControlRotation[Index].Yaw - B.PreviousAimYaw[Index]) / DeltaTime);
+
+	B.ActorInterpSpeed[Index] = 0.0f;
+	B.bRotationChanged[Index] = false;
+	B.NewActorRotation[Index] = B.ActorRotation[Index];
+
+	switch (B.MovementState[Index])
+	{
+	case EMovementState::MS_Grounded:
+		{
+			// Simulated proxies keep the gait replicated by the server.
+			const FMovementModelEntry& CurrentSettings = *B.CurrentSettings[Index];
+			if (!B.bSimulatedProxy[Index])
+			{
+				// Gait, see ULocomotionComponent::UpdateCharacterMovement.
+				const EStanceState Stance = B.Stance[Index];
+				const ERotationMode RotationMode = B.RotationMode[Index];
+				const EGaitState DesiredGait = B.DesiredGait[Index];
+				const bool bWantsToSprint = DesiredGait == EGaitState::GS_Sprinting && Stance == EStanceState::SS_Standing && RotationMode != ERotationMode::RM_Aiming;
+				const bool bCanSprint = bWantsToSprint && LocomotionMath::CanSprint(RotationMode, B.bHasMovementInput[Index], MovementInputAmount,
+				                                                                            MovementInput, B.ControlRotation[Index]);
+				const EGaitState AllowedGait = LocomotionMath::AllowedGait(Stance, RotationMode, DesiredGait, bCanSprint);
+				B.Gait[Index] = LocomotionMath::ActualGait(AllowedGait, Speed, CurrentSettings.WalkSpeed, CurrentSettings.RunSpeed);
+			}
+
+			const float MappedSpeed = LocomotionMath::MappedSpeed(Speed, CurrentSettings.WalkSpeed, CurrentSettings.RunSpeed, CurrentSettings.SprintSpeed);
+			UpdateGroundedRotation(B, Index, DeltaTime, MappedSpeed, CurrentSettings.BakedRotationRateCurve.Get());
+		}
+		break;
+	case EMovementState::MS_InAir:
+		UpdateInAirRotation(B, Index, DeltaTime);
+		break;
+	default:
+		checkNoEntry();
+	}
+}
+
+void ULocomotionSubsystem::UpdateGroundedRotation(FLocomotionBatchBuffers& B, int32 Index, float DeltaTime, float MappedSpeed, const FBakedCurveFloat* RotationRateCurve)
+{
+	if (B.MovementAction[Index] != EMovementAction::MA_None)
+	{
+		// TODO: Rolling
+		checkNoEntry();
+		return;
+	}
+
+	const ERotationMode RotationMode = B.RotationMode[Index];
+	const FRotator& ControlRotation = B.ControlRotation[Index];
+
+	const bool bCanUpdateMovementRotation = ((B.bIsMoving[Index] && B.bHasMovementInput[Index]) || B.Speed[Index] > 150.0f) && !B.bHasAnyRootMotion[Index];
+	if (bCanUpdateMovementRotation)
+	{
+		const auto GroundedRotationRate = [&B, Index, MappedSpeed, RotationRateCurve]()
+		{
+			check(RotationRateCurve);
+			return LocomotionMath::GroundedRotationRate(RotationRateCurve->Evaluate(MappedSpeed), B.AimYawRate[Index]);
+		};
+
+		// Looking Direction Rotation
+		if (RotationMode == ERotationMode::RM_Looking)
+		{
+			const EGaitState Gait = B.Gait[Index];
+			if (Gait == EGaitState::GS_Walking || Gait == EGaitState::GS_Running)
+			{
+				const float TargetYaw = ControlRotation.Yaw + B.YawOffsetCurve[Index];
+				SmoothRotation(B, Index, FRotator(0.0f, TargetYaw, 0.0f), DeltaTime, 500.0f, GroundedRotationRate());
+			}
+			else if (Gait == EGaitState::GS_Sprinting)
+			{
+				SmoothRotation(B, Index, FRotator(0.0f, B.LastVelocityRotation[Index].Yaw, 0.0f), DeltaTime, 500.0f, GroundedRotationRate());
+			}
+		}
+		// Aiming Rotation
+		else if (RotationMode == ERotationMode::RM_Aiming)
+		{
+			SmoothRotation(B, Index, FRotator(0.0f, ControlRotation.Yaw, 0.0f), DeltaTime, 1000.0f, GroundedRotationRate());
+		}
+	}
+	else
+	{
+		// Not Moving, see ULocomotionComponent::LimitRotation.
+		if (RotationMode == ERotationMode::RM_Aiming)
+		{
+			const float AimYawMin = -100.0f;
+			const float AimYawMax = 100.0f;
+			const float DeltaYaw = UKismetMathLibrary::NormalizedDeltaRotator(ControlRotation, B.NewActorRotation[Index]).Yaw;
+			if (!UKismetMathLibrary::InRange_FloatFloat(DeltaYaw, AimYawMin, AimYawMax, true, true))
+			{
+				const float TargetYaw = ControlRotation.Yaw + (DeltaYaw > 0.0f ? AimYawMin : AimYawMax);
+				SmoothRotation(B, Index, FRotator(0.0f, TargetYaw, 0.0f), DeltaTime, 0.0f, 20.0f);
+			}
+		}
+
+		// Apply the RotationAmount curve from Turn In Place Animations.
+		const float RotationAmount = B.RotationAmountCurve[Index];
+		if (FMath::Abs(RotationAmount) > 0.001f)
+		{
+			const float DeltaYaw = RotationAmount * (DeltaTime / (1.0f / 30.0f));
+			const FRotator NewRotation = (FRotator(0.0f, DeltaYaw, 0.0f).Quaternion() * B.NewActorRotation[Index].Quaternion()).Rotator();
+			B.NewActorRotation[Index] = NewRotation;
+			B.TargetRotation[Index] = NewRotation;
+			B.bRotationChanged[Index] = true;
+		}
+	}
+}
+
+void ULocomotionSubsystem::UpdateInAirRotation(FLocomotionBatchBuffers& B, int32 Index, float DeltaTime)
+{
+	const ERotationMode RotationMode = B.RotationMode[Index];
+	if (RotationMode == ERotationMode::RM_Looking || RotationMode == ERotationMode::RM_Velocity)
+	{
+		// Velocity / Looking Direction Rotation
+		SmoothRotation(B, Index, FRotator(0.0f, B.InAirRotation[Index].Yaw, 0.0f), DeltaTime, 0.0f, 5.0f);
+	}
+	else if (RotationMode == ERotationMode::RM_Aiming)
+	{
+		// Aiming Rotation
+		SmoothRotation(B, Index, FRotator(0.0f, B.ControlRotation[Index].Yaw, 0.0f), DeltaTime, 0.0f, 15.0f);
+		B.InAirRotation[Index] = B.NewActorRotation[Index];
+	}
+}
+
+void ULocomotionSubsystem::SmoothRotation(FLocomotionBatchBuffers& B, int32 Index, const FRotator& Target, float DeltaTime, float TargetInterpSpeed, float ActorInterpSpeed)
+{
+	B.NewActorRotation[Index] = LocomotionMath::SmoothedRotation(B.TargetRotation[Index], Target, B.NewActorRotation[Index],
+	                                                             DeltaTime, TargetInterpSpeed, ActorInterpSpeed);
+	B.ActorInterpSpeed[Index] = ActorInterpSpeed;
+	B.bRotationChanged[Index] = true;
+}
+
+void ULocomotionSubsystem::Scatter()
+{
+	for (int32 Index = 0; Index < BatchComponents.Num(); ++Index)
+	{
+		ULocomotionComponent* Component = BatchComponents[Index];
+
+		Component->PhysicalAcceleration = Buffers.PhysicalAcceleration[Index];
+		Component->Speed = Buffers.Speed[Index];
+		Component->bIsMoving = Buffers.bIsMoving[Index];
+		Component->MovementInputAmount = Buffers.MovementInputAmount[Index];
+		Component->bHasMovementInput = Buffers.bHasMovementInput[Index];
+		Component->AimYawRate = Buffers.AimYawRate[Index];
+		Component->LastVelocityRotation = Buffers.LastVelocityRotation[Index];
+		Component->LastMovementInputRotation = Buffers.LastMovementInputRotation[Index];
+		Component->TargetRotation = Buffers.TargetRotation[Index];
+		Component->InAirRotation = Buffers.InAirRotation[Index];
+		Component->LastActorInterpSpeed = Buffers.ActorInterpSpeed[Index];
+
+		if (Buffers.Gait[Index] != Component->Gait)
+		{
+			Component->SetGait(Buffers.Gait[Index]);
+		}
+
+		if (Buffers.bRotationChanged[Index])
+		{
+			Component->QueueActorRotation(Buffers.NewActorRotation[Index]);
+			Component->ApplyPendingRotation();
+		}
+
+		// Cache certain values to be used in calculations on the next frame, see ULocomotionComponent::CacheValues.
+		Component->PreviousVelocity = Buffers.Velocity[Index];
+		Component->PreviousAimYaw = Buffers.ControlRotation[Index].Yaw;
+
+		Component->UpdateReplicatedState();
+		Component->PublishSnapshot();
+	}
+}
+
+void ULocomotionSubsystem::UpdateAnimParameters(float DeltaTime)
+{
+	if (CVarAnimParameterBatch.GetValueOnGameThread() == 0 || DeltaTime <= 0.0f)
+	{
+		SET_DWORD_STAT(STAT_AnimParameterBatchCharacters, 0);
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_AnimParameterBatch);
+
+	GatherAnimParameters(DeltaTime);
+
+	const int32 Num = AnimParameterInstances.Num();
+	SET_DWORD_STAT(STAT_AnimParameterBatchCharacters, Num);
+	if (Num == 0) return;
+
+	FAnimParameterBatchBuffers& B = AnimParameterBuffers;
+	LocomotionMath::VelocityBlendBatch(B.VelocityX.GetData(), B.VelocityY.GetData(), B.VelocityZ.GetData(), B.ActorYaw.GetData(),
+	                                   B.TargetVelocityBlendF.GetData(), B.TargetVelocityBlendB.GetData(),
+	                                   B.TargetVelocityBlendL.GetData(), B.TargetVelocityBlendR.GetData(), Num);
+	LocomotionMath::InterpToBatch(B.VelocityBlendF.GetData(), B.TargetVelocityBlendF.GetData(), B.DeltaTime.GetData(), B.VelocityBlendInterpSpeed.GetData(), B.NewVelocityBlendF.GetData(), Num);
+	LocomotionMath::InterpToBatch(B.VelocityBlendB.GetData(), B.TargetVelocityBlendB.GetData(), B.DeltaTime.GetData(), B.VelocityBlendInterpSpeed.GetData(), B.NewVelocityBlendB.GetData(), Num);
+	LocomotionMath::InterpToBatch(B.VelocityBlendL.GetData(), B.TargetVelocityBlendL.GetData(), B.DeltaTime.GetData(), B.VelocityBlendInterpSpeed.GetData(), B.NewVelocityBlendL.GetData(), Num);
+	LocomotionMath::InterpToBatch(B.VelocityBlendR.GetData(), B.TargetVelocityBlendR.GetData(), B.DeltaTime.GetData(), B.VelocityBlendInterpSpeed.GetData(), B.NewVelocityBlendR.GetData(), Num);
+
+	LocomotionMath::RelativeAccelerationAmountBatch(B.AccelerationX.GetData(), B.AccelerationY.GetData(), B.AccelerationZ.GetData(),
+	                                                B.VelocityX.GetData(), B.VelocityY.GetData(), B.VelocityZ.GetData(), B.ActorYaw.GetData(),
+	                                                B.MaxAcceleration.GetData(), B.MaxBrakingDeceleration.GetData(),
+	                                                B.RelativeAccelerationX.GetData(), B.RelativeAccelerationY.GetData(), B.RelativeAccelerationZ.GetData(), Num);
+	// The lean targets are the relative acceleration: LR from Y, FB from X.
+	LocomotionMath::InterpToBatch(B.LeanLR.GetData(), B.RelativeAccelerationY.GetData(), B.DeltaTime.GetData(), B.LeanInterpSpeed.GetData(), B.NewLeanLR.GetData(), Num);
+	LocomotionMath::InterpToBatch(B.LeanFB.GetData(), B.RelativeAccelerationX.GetData(), B.DeltaTime.GetData(), B.LeanInterpSpeed.GetData(), B.NewLeanFB.GetData(), Num);
+
+	LocomotionMath::AimingAngleBatch(B.AimingYaw.GetData(), B.AimingPitch.GetData(), B.ActorYaw.GetData(), B.AimingAngleX.GetData(), B.AimingAngleY.GetData(), Num);
+
+	ScatterAnimParameters();
+}
+
+void ULocomotionSubsystem::GatherAnimParameters(float DeltaTime)
+{
+	FAnimParameterBatchBuffers& B = AnimParameterBuffers;
+	B.SetNum(Components.Num());
+	AnimParameterInstances.Reset();
+
+	for (ULocomotionComponent* Component : Components)
+	{
+		if (!IsValid(Component) || !Component->Character) continue;
+
+		// Only the characters whose anim instance runs the full profile this frame, with the delta time known here:
+		// rendered recently, ticking every frame and without update rate optimizations.
+		const ABaseCharacter* Character = Component->Character;
+		const USkeletalMeshComponent* Mesh = Character->GetMesh();
+		UBaseAnimInstance* AnimInstance = Cast<UBaseAnimInstance>(Component->MainAnimInstance);
+		if (!AnimInstance || AnimInstance->bServerAnimationProfile || !Mesh->WasRecentlyRendered()
+			|| Mesh->PrimaryComponentTick.TickInterval > 0.0f || Mesh->bEnableUpdateRateOptimizations)
+		{
+			continue;
+		}
+
+		// The batch kernels only take the yaw.
+		const FLocomotionSnapshot& Snapshot = Component->GetSnapshot();
+		if (!FMath::IsNearlyZero(Snapshot.ActorRotation.Pitch) || !FMath::IsNearlyZero(Snapshot.ActorRotation.Roll)) continue;
+
+		const int32 Index = AnimParameterInstances.Add(AnimInstance);
+		B.DeltaTime[Index] = DeltaTime * Character->CustomTimeDilation;
+		B.VelocityX[Index] = Snapshot.Velocity.X;
+		B.VelocityY[Index] = Snapshot.Velocity.Y;
+		B.VelocityZ[Index] = Snapshot.Velocity.Z;
+		B.AccelerationX[Index] = Snapshot.PhysicalAcceleration.X;
+		B.AccelerationY[Index] = Snapshot.PhysicalAcceleration.Y;
+		B.AccelerationZ[Index] = Snapshot.PhysicalAcceleration.Z;
+		B.ActorYaw[Index] = Snapshot.ActorRotation.Yaw;
+		B.AimingYaw[Index] = Snapshot.AimingRotation.Yaw;
+		B.AimingPitch[Index] = Snapshot.AimingRotation.Pitch;
+		B.MaxAcceleration[Index] = Snapshot.MaxAcceleration;
+		B.MaxBrakingDeceleration[Index] = Snapshot.MaxBrakingDeceleration;
+		B.VelocityBlendInterpSpeed[Index] = AnimInstance->VelocityBlendInterpSpeed;
+		B.LeanInterpSpeed[Index] = AnimInstance->GroundedLeanInterpSpeed;
+		B.VelocityBlendF[Index] = AnimInstance->VelocityBlend.F;
+		B.VelocityBlendB[Index] = AnimInstance->VelocityBlend.B;
+		B.VelocityBlendL[Index] = AnimInstance->VelocityBlend.L;
+		B.VelocityBlendR[Index] = AnimInstance->VelocityBlend.R;
+		B.LeanLR[Index] = AnimInstance->LeanAmount.LR;
+		B.LeanFB[Index] = AnimInstance->LeanAmount.FB;
+	}
+
+	B.SetNum(AnimParameterInstances.Num());
+}
+
+void ULocomotionSubsystem::ScatterAnimParameters()
+{
+	const FAnimParameterBatchBuffers& B = AnimParameterBuffers;
+	for (int32 Index = 0; Index < AnimParameterInstances.Num(); ++Index)
+	{
+		FBatchedAnimParameters& Parameters = AnimParameterInstances[Index]->BatchedParameters;
+		Parameters.DeltaSeconds = B.DeltaTime[Index];
+		Parameters.VelocityBlend.F = B.NewVelocityBlendF[Index];
+		Parameters.VelocityBlend.B = B.NewVelocityBlendB[Index];
+		Parameters.VelocityBlend.L = B.NewVelocityBlendL[Index];
+		Parameters.VelocityBlend.R = B.NewVelocityBlendR[Index];
+		Parameters.RelativeAccelerationAmount = FVector(B.RelativeAccelerationX[Index], B.RelativeAccelerationY[Index], B.RelativeAccelerationZ[Index]);
+		Parameters.LeanAmount.LR = B.NewLeanLR[Index];
+		Parameters.LeanAmount.FB = B.NewLeanFB[Index];
+		Parameters.AimingAngle = FVector2d(B.AimingAngleX[Index], B.AimingAngleY[Index]);
+		Parameters.bValid = true;
+	}
+}
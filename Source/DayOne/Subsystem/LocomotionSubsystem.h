@@ -0,0 +1,210 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DayOne/Data/CharacterState.h"
+#include "DayOne/Data/ModelTable.h"
+#include "LocomotionSubsystem.generated.h"
+
+class UBaseAnimInstance;
+class ULocomotionComponent;
+class ULocomotionSubsystem;
+
+// Runs the batched locomotion update once per frame.
+// It waits for every registered locomotion component (their movement tick),
+// and every character mesh waits for it, so the anim instances see this frame's values.
+USTRUCT()
+struct FLocomotionBatchTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	ULocomotionSubsystem* Subsystem = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FLocomotionBatchTickFunction> : public TStructOpsTypeTraitsBase2<FLocomotionBatchTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+// Structure-of-arrays locomotion state of every registered character.
+// Gathered on the game thread, updated in parallel chunks, then written back.
+struct FLocomotionBatchBuffers
+{
+	// Inputs
+	// Delta time of the update, longer for characters at reduced rate.
+	TArray<float> DeltaTime;
+	TArray<FVector> Velocity;
+	TArray<FVector> PreviousVelocity;
+	TArray<FVector> MovementInput;
+	TArray<float> MaxAcceleration;
+	TArray<FRotator> ControlRotation;
+	TArray<FRotator> ActorRotation;
+	TArray<float> PreviousAimYaw;
+	TArray<EMovementState> MovementState;
+	TArray<EMovementAction> MovementAction;
+	TArray<EStanceState> Stance;
+	TArray<ERotationMode> RotationMode;
+	TArray<EGaitState> DesiredGait;
+	TArray<bool> bHasAnyRootMotion;
+	// Simulated proxies keep the replicated gait and settings, and only run the rotation.
+	TArray<bool> bSimulatedProxy;
+	TArray<float> YawOffsetCurve;
+	TArray<float> RotationAmountCurve;
+	// Settings of the last move, used for gait detection and the rotation rate. Point into the shared movement table.
+	TArray<const FMovementModelEntry*> CurrentSettings;
+
+	// Essential values
+	TArray<FVector> PhysicalAcceleration;
+	TArray<float> Speed;
+	TArray<bool> bIsMoving;
+	TArray<float> MovementInputAmount;
+	TArray<bool> bHasMovementInput;
+	TArray<float> AimYawRate;
+
+	// Input and output
+	TArray<FRotator> LastVelocityRotation;
+	TArray<FRotator> LastMovementInputRotation;
+	TArray<EGaitState> Gait;
+	TArray<FRotator> TargetRotation;
+	TArray<FRotator> InAirRotation;
+
+	// Outputs
+	TArray<float> ActorInterpSpeed;
+	TArray<bool> bRotationChanged;
+	TArray<FRotator> NewActorRotation;
+
+	void SetNum(int32 Num);
+};
+
+// Structure-of-arrays anim parameters of every visible character, see ULocomotionSubsystem::UpdateAnimParameters.
+struct FAnimParameterBatchBuffers
+{
+	// Inputs
+	// Delta time of the character's anim update.
+	TArray<float> DeltaTime;
+	TArray<float> VelocityX;
+	TArray<float> VelocityY;
+	TArray<float> VelocityZ;
+	TArray<float> AccelerationX;
+	TArray<float> AccelerationY;
+	TArray<float> AccelerationZ;
+	TArray<float> ActorYaw;
+	TArray<float> AimingYaw;
+	TArray<float> AimingPitch;
+	TArray<float> MaxAcceleration;
+	TArray<float> MaxBrakingDeceleration;
+	TArray<float> VelocityBlendInterpSpeed;
+	TArray<float> LeanInterpSpeed;
+	// Values of the last anim update, interpolated toward the targets.
+	TArray<float> VelocityBlendF;
+	TArray<float> VelocityBlendB;
+	TArray<float> VelocityBlendL;
+	TArray<float> VelocityBlendR;
+	TArray<float> LeanLR;
+	TArray<float> LeanFB;
+
+	// Targets
+	TArray<float> TargetVelocityBlendF;
+	TArray<float> TargetVelocityBlendB;
+	TArray<float> TargetVelocityBlendL;
+	TArray<float> TargetVelocityBlendR;
+	TArray<float> RelativeAccelerationX;
+	TArray<float> RelativeAccelerationY;
+	TArray<float> RelativeAccelerationZ;
+
+	// Outputs
+	TArray<float> NewVelocityBlendF;
+	TArray<float> NewVelocityBlendB;
+	TArray<float> NewVelocityBlendL;
+	TArray<float> NewVelocityBlendR;
+	TArray<float> NewLeanLR;
+	TArray<float> NewLeanFB;
+	TArray<float> AimingAngleX;
+	TArray<float> AimingAngleY;
+
+	void SetNum(int32 Num);
+};
+
+/**
+ * Updates the locomotion of all ULocomotionComponents in the world as one batch.
+ * Every component still moves in its own tick, but the locomotion logic
+ * (essential values, gait, mapped speed and rotation) runs here in ParallelFor chunks,
+ * so the cost scales with the core count instead of the player count.
+ * The movement settings are not touched here, they are evaluated inside each move (see ULocomotionComponent::UpdateMovementSettings).
+ * Switch between this and the per-component path with DayOne.Locomotion.UpdateMode.
+ * Afterwards, whatever the update mode, the per-character anim parameter math of the visible characters
+ * runs here in SIMD over SoA buffers, before their meshes update (DayOne.Anim.ParameterBatch).
+ */
+UCLASS()
+class DAYONE_API ULocomotionSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	friend struct FLocomotionBatchTickFunction;
+
+	virtual void Deinitialize() override;
+
+	// Is the batched path selected by DayOne.Locomotion.UpdateMode?
+	static bool IsBatchedUpdateEnabled();
+	// Time between two locomotion updates of a character at reduced rate.
+	static float GetReducedUpdateInterval();
+
+	void RegisterComponent(ULocomotionComponent* Component);
+	void UnregisterComponent(ULocomotionComponent* Component);
+
+	// Write the flight recorder of every registered character to Saved/Locomotion, Reason goes in the file names.
+	void DumpFlightRecorders(const FString& Reason) const;
+
+protected:
+	virtual bool DoesSupportWorldType(EWorldType::Type WorldType) const override;
+
+private:
+	void UpdateLocomotion(float DeltaTime);
+
+	// Flag the characters far from every player.
+	// On a dedicated server, those not aiming are put at the reduced rate.
+	void UpdateSignificance();
+	// Copy the locomotion inputs of every component due for an update into the buffers,
+	// the others only interpolate their rotation.
+	void Gather(float DeltaTime);
+	// Run the locomotion logic for the character at Index, touches the buffers only.
+	static void UpdateCharacter(FLocomotionBatchBuffers& Buffers, int32 Index, float DeltaTime);
+	static void UpdateGroundedRotation(FLocomotionBatchBuffers& Buffers, int32 Index, float DeltaTime, float MappedSpeed, const FBakedCurveFloat* RotationRateCurve);
+	static void UpdateInAirRotation(FLocomotionBatchBuffers& Buffers, int32 Index, float DeltaTime);
+	static void SmoothRotation(FLocomotionBatchBuffers& Buffers, int32 Index, const FRotator& Target, float DeltaTime, float TargetInterpSpeed, float ActorInterpSpeed);
+	// Write the results back to the components.
+	void Scatter();
+
+	// Velocity blend, lean, relative acceleration and aiming angle of the anim instances of visible characters,
+	// picked up by UBaseAnimInstance in its update.
+	void UpdateAnimParameters(float DeltaTime);
+	void GatherAnimParameters(float DeltaTime);
+	void ScatterAnimParameters();
+
+	UPROPERTY(Transient)
+	TArray<ULocomotionComponent*> Components;
+
+	// Components updated this frame, in buffer order.
+	TArray<ULocomotionComponent*> BatchComponents;
+	FLocomotionBatchBuffers Buffers;
+
+	FLocomotionBatchTickFunction BatchTickFunction;
+
+	// Anim instances in the anim parameter batch this frame, in buffer order.
+	TArray<UBaseAnimInstance*> AnimParameterInstances;
+	FAnimParameterBatchBuffers AnimParameterBuffers;
+
+	// Real time of the last dump on hitch, dumps are at least HitchDumpCooldown apart.
+	double LastHitchDumpTime = -DBL_MAX;
+};
@@ -0,0 +1,195 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ModelTableSubsystem.h"
+
+#include "CurveBakeSubsystem.h"
+#include "Engine/Engine.h"
+#include "UObject/UObjectGlobals.h"
+
+static_assert(static_cast<int32>(ERotationMode::RM_MAX) == 3, "FMovementSettingsState has one FMovementSettingsStance per rotation mode");
+static_assert(static_cast<int32>(EGaitState::GS_MAX) == 3, "FCameraSettingsGait has one FCameraSettings per gait");
+
+void UModelTableSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddUObject(this, &ThisClass::EvictUnusedTables);
+}
+
+void UModelTableSubsystem::Deinitialize()
+{
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+
+#if WITH_EDITOR
+	for (const TPair<TObjectKey<UDataTable>, FDelegateHandle>& Pair : DataTableChangedHandles)
+	{
+		if (UDataTable* DataTable = Pair.Key.ResolveObjectPtr())
+		{
+			DataTable->OnDataTableChanged().Remove(Pair.Value);
+		}
+	}
+	DataTableChangedHandles.Reset();
+#endif
+
+	MovementModelTables.Reset();
+	CameraModelTables.Reset();
+
+	Super::Deinitialize();
+}
+
+TSharedRef<const FMovementModelTable> UModelTableSubsystem::GetMovementModelTable(UDataTable* DataTable)
+{
+	check(DataTable);
+
+	if (const TSharedRef<FMovementModelTable>* ExistingTable = MovementModelTables.Find(DataTable))
+	{
+		return *ExistingTable;
+	}
+
+	TSharedRef<FMovementModelTable> Table = MakeShared<FMovementModelTable>();
+	BuildMovementModelTable(*DataTable, Table.Get());
+	MovementModelTables.Add(DataTable, Table);
+
+#if WITH_EDITOR
+	if (!DataTableChangedHandles.Contains(DataTable))
+	{
+		DataTableChangedHandles.Add(DataTable, DataTable->OnDataTableChanged().AddUObject(this, &ThisClass::OnDataTableChanged, TObjectKey<UDataTable>(DataTable)));
+	}
+#endif
+
+	return Table;
+}
+
+TSharedRef<const FCameraModelTable> UModelTableSubsystem::GetCameraModelTable(UDataTable* DataTable)
+{
+	check(DataTable);
+
+	if (const TSharedRef<FCameraModelTable>* ExistingTable = CameraModelTables.Find(DataTable))
+	{
+		return *ExistingTable;
+	}
+
+	TSharedRef<FCameraModelTable> Table = MakeShared<FCameraModelTable>();
+	BuildCameraModelTable(*DataTable, Table.Get());
+	CameraModelTables.Add(DataTable, Table);
+
+#if WITH_EDITOR
+	if (!DataTableChangedHandles.Contains(DataTable))
+	{
+		DataTableChangedHandles.Add(DataTable, DataTable->OnDataTableChanged().AddUObject(this, &ThisClass::OnDataTableChanged, TObjectKey<UDataTable>(DataTable)));
+	}
+#endif
+
+	return Table;
+}
+
+void UModelTableSubsystem::BuildMovementModelTable(const UDataTable& DataTable, FMovementModelTable& OutTable)
+{
+	// Rows are named after the display name of their EMovementModel.
+	const UEnum* MovementModelEnum = StaticEnum<EMovementModel>();
+
+	const FString NormalRowName = MovementModelEnum->GetDisplayNameTextByIndex(static_cast<int32>(EMovementModel::MM_Normal)).ToString();
+	const FMovementSettingsState* NormalRow = DataTable.FindRow<FMovementSettingsState>(*NormalRowName, TEXT("MovementModel.Normal"));
+	check(NormalRow);
+
+	for (int32 ModelIndex = 0; ModelIndex < static_cast<int32>(EMovementModel::MM_MAX); ++ModelIndex)
+	{
+		// Buff/debuff models without a row of their own move like the normal one.
+		const FString RowName = MovementModelEnum->GetDisplayNameTextByIndex(ModelIndex).ToString();
+		const FMovementSettingsState* Row = DataTable.FindRow<FMovementSettingsState>(*RowName, TEXT("MovementModel"), false);
+		if (!Row)
+		{
+			Row = NormalRow;
+		}
+
+		const FMovementSettingsStance* RotationModes[] = { &Row->Velocity, &Row->Looking, &Row->Aiming };
+		for (int32 RotationModeIndex = 0; RotationModeIndex < UE_ARRAY_COUNT(RotationModes); ++RotationModeIndex)
+		{
+			BuildMovementModelEntry(RotationModes[RotationModeIndex]->Standing,
+			                        OutTable.Settings[ModelIndex][RotationModeIndex][static_cast<int32>(EStanceState::SS_Standing)]);
+			BuildMovementModelEntry(RotationModes[RotationModeIndex]->Crouching,
+			                        OutTable.Settings[ModelIndex][RotationModeIndex][static_cast<int32>(EStanceState::SS_Crouching)]);
+		}
+	}
+}
+
+void UModelTableSubsystem::BuildMovementModelEntry(const FMovementSettings& Settings, FMovementModelEntry& OutEntry)
+{
+	UCurveBakeSubsystem* CurveBakeSubsystem = GEngine->GetEngineSubsystem<UCurveBakeSubsystem>();
+	check(CurveBakeSubsystem);
+
+	OutEntry.WalkSpeed = Settings.WalkSpeed;
+	OutEntry.RunSpeed = Settings.RunSpeed;
+	OutEntry.SprintSpeed = Settings.SprintSpeed;
+	OutEntry.BakedMovementCurve = CurveBakeSubsystem->GetBakedCurve(Settings.MovementCurve);
+	OutEntry.BakedRotationRateCurve = CurveBakeSubsystem->GetBakedCurve(Settings.RotationRateCurve);
+}
+
+void UModelTableSubsystem::BuildCameraModelTable(const UDataTable& DataTable, FCameraModelTable& OutTable)
+{
+	// Rows are named after the display name of their EStanceState.
+	const UEnum* StanceEnum = StaticEnum<EStanceState>();
+
+	for (int32 StanceIndex = 0; StanceIndex < static_cast<int32>(EStanceState::SS_MAX); ++StanceIndex)
+	{
+		const FString RowName = StanceEnum->GetDisplayNameTextByIndex(StanceIndex).ToString();
+		const FCameraSettingsGait* Row = DataTable.FindRow<FCameraSettingsGait>(*RowName, TEXT("CameraModel"));
+		check(Row);
+
+		OutTable.Settings[StanceIndex][static_cast<int32>(EGaitState::GS_Walking)] = Row->Walking;
+		OutTable.Settings[StanceIndex][static_cast<int32>(EGaitState::GS_Running)] = Row->Running;
+		OutTable.Settings[StanceIndex][static_cast<int32>(EGaitState::GS_Sprinting)] = Row->Sprinting;
+	}
+}
+
+void UModelTableSubsystem::EvictUnusedTables()
+{
+	// Only this subsystem holds a unique table, the characters that used it are gone.
+	for (auto It = MovementModelTables.CreateIterator(); It; ++It)
+	{
+		if (It->Value.IsUnique() || !It->Key.ResolveObjectPtr())
+		{
+			It.RemoveCurrent();
+		}
+	}
+	for (auto It = CameraModelTables.CreateIterator(); It; ++It)
+	{
+		if (It->Value.IsUnique() || !It->Key.ResolveObjectPtr())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+#if WITH_EDITOR
+	for (auto It = DataTableChangedHandles.CreateIterator(); It; ++It)
+	{
+		if (MovementModelTables.Contains(It->Key) || CameraModelTables.Contains(It->Key))
+		{
+			continue;
+		}
+		if (UDataTable* DataTable = It->Key.ResolveObjectPtr())
+		{
+			DataTable->OnDataTableChanged().Remove(It->Value);
+		}
+		It.RemoveCurrent();
+	}
+#endif
+}
+
+#if WITH_EDITOR
+void UModelTableSubsystem::OnDataTableChanged(TObjectKey<UDataTable> DataTableKey)
+{
+	const UDataTable* DataTable = DataTableKey.ResolveObjectPtr();
+	if (!DataTable) return;
+
+	if (TSharedRef<FMovementModelTable>* Table = MovementModelTables.Find(DataTableKey))
+	{
+		BuildMovementModelTable(*DataTable, Table->Get());
+	}
+	if (TSharedRef<FCameraModelTable>* Table = CameraModelTables.Find(DataTableKey))
+	{
+		BuildCameraModelTable(*DataTable, Table->Get());
+	}
+}
+#endif
@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/EngineSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "DayOne/Data/ModelTable.h"
+#include "ModelTableSubsystem.generated.h"
+
+/**
+ * Owns the flattened movement and camera model tables.
+ * Every DataTable is resolved row by row only once, the first time a character asks for it,
+ * and the same table is handed to every character that uses it.
+ * The curves of every movement entry are baked by UCurveBakeSubsystem along with it.
+ * In editor, a table is rebuilt in place when its DataTable changes, so references into it stay valid.
+ * After every garbage collection, the tables of destroyed DataTables and the tables no character holds any more are released,
+ * so they do not outlive the worlds that used them.
+ */
+UCLASS()
+class DAYONE_API UModelTableSubsystem : public UEngineSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	TSharedRef<const FMovementModelTable> GetMovementModelTable(UDataTable* DataTable);
+	TSharedRef<const FCameraModelTable> GetCameraModelTable(UDataTable* DataTable);
+
+private:
+	static void BuildMovementModelTable(const UDataTable& DataTable, FMovementModelTable& OutTable);
+	static void BuildMovementModelEntry(const FMovementSettings& Settings, FMovementModelEntry& OutEntry);
+	static void BuildCameraModelTable(const UDataTable& DataTable, FCameraModelTable& OutTable);
+
+	void EvictUnusedTables();
+	FDelegateHandle PostGarbageCollectHandle;
+
+#if WITH_EDITOR
+	void OnDataTableChanged(TObjectKey<UDataTable> DataTableKey);
+
+	TMap<TObjectKey<UDataTable>, FDelegateHandle> DataTableChangedHandles;
+#endif
+
+	TMap<TObjectKey<UDataTable>, TSharedRef<FMovementModelTable>> MovementModelTables;
+	TMap<TObjectKey<UDataTable>, TSharedRef<FCameraModelTable>> CameraModelTables;
+};
@@ -10,6 +10,8 @@
 #include "Engine/SkeletalMeshSocket.h"
 #include "Net/UnrealNetwork.h"
 
+const FName AWeapon::LeftHandSocketName(TEXT("LeftHandSocket"));
+
 AWeapon::AWeapon()
 {
 	// Disable actor tick
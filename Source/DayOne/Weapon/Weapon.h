@@ -3,6 +3,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "DayOne/Data/CharacterState.h"
 #include "GameFramework/Actor.h"
 #include "Weapon.generated.h"
 
@@ -35,6 +36,12 @@ public:
 
 	FORCEINLINE USkeletalMeshComponent* GetMesh() { return Mesh; }
 
+	// Socket the left hand IK reaches for.
+	static const FName LeftHandSocketName;
+	FORCEINLINE bool HasAnimatedLeftHandSocket() const { return bAnimatedLeftHandSocket; }
+	// Overlay layer the holder links while this weapon is equipped.
+	FORCEINLINE EOverlayState GetOverlayState() const { return OverlayState; }
+
 	virtual void Fire(const FVector& HitResult);
 
 protected:
@@ -66,6 +73,11 @@ private:
 	class USphereComponent* Collider;
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (AllowPrivateAccess = "true"))
 	class UAnimationAsset* FireAnim;
+	// Set if the weapon mesh animation moves LeftHandSocket, the left hand IK then reads the socket every frame.
+	UPROPERTY(EditDefaultsOnly, Category = "Combat")
+	bool bAnimatedLeftHandSocket = false;
+	UPROPERTY(EditDefaultsOnly, Category = "Combat")
+	EOverlayState OverlayState = EOverlayState::OS_Rifle;
 	
 	UPROPERTY(ReplicatedUsing=OnRep_CurrentState)
 	EWeaponState CurrentState = EWeaponState::EWS_Init;
@@ -9,6 +9,6 @@ public class DayOneEditorTarget : TargetRules
 	{
 		Type = TargetType.Editor;
 		DefaultBuildSettings = BuildSettingsVersion.V2;
-		ExtraModuleNames.AddRange( new string[] { "DayOne" } );
+		ExtraModuleNames.AddRange( new string[] { "DayOne", "DayOneEditor" } );
 	}
 }
@@ -0,0 +1,20 @@
+#include "AnimGraphNode_FootLock.h"
+
+#define LOCTEXT_NAMESPACE "DayOneAnimGraphNodes"
+
+FText UAnimGraphNode_FootLock::GetNodeTitle(ENodeTitleType::Type TitleType) const
+{
+	return GetControllerDescription();
+}
+
+FText UAnimGraphNode_FootLock::GetTooltipText() const
+{
+	return LOCTEXT("FootLockTooltip", "Blends the IK foot toward its locked transform by the foot lock alpha of UBaseAnimInstance.");
+}
+
+FText UAnimGraphNode_FootLock::GetControllerDescription() const
+{
+	return LOCTEXT("FootLock", "Foot Lock");
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,20 @@
+#include "AnimGraphNode_FootOffset.h"
+
+#define LOCTEXT_NAMESPACE "DayOneAnimGraphNodes"
+
+FText UAnimGraphNode_FootOffset::GetNodeTitle(ENodeTitleType::Type TitleType) const
+{
+	return GetControllerDescription();
+}
+
+FText UAnimGraphNode_FootOffset::GetTooltipText() const
+{
+	return LOCTEXT("FootOffsetTooltip", "Adds the foot offset of UBaseAnimInstance to the IK foot, in world space.");
+}
+
+FText UAnimGraphNode_FootOffset::GetControllerDescription() const
+{
+	return LOCTEXT("FootOffset", "Foot Offset");
+}
+
+#undef LOCTEXT_NAMESPACE
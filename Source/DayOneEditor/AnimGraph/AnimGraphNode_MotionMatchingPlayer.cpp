@@ -0,0 +1,17 @@
+#include "AnimGraphNode_MotionMatchingPlayer.h"
+
+#define LOCTEXT_NAMESPACE "DayOneAnimGraphNodes"
+
+FText UAnimGraphNode_MotionMatchingPlayer::GetNodeTitle(ENodeTitleType::Type TitleType) const
+{
+	return LOCTEXT("MotionMatchingPlayer", "Motion Matching Player");
+}
+
+FText UAnimGraphNode_MotionMatchingPlayer::GetTooltipText() const
+{
+	return LOCTEXT("MotionMatchingPlayerTooltip",
+		"Plays the pose motion matching picked in UBaseAnimInstance, or the source pose while motion matching is off.\n"
+		"Requests an inertial blend on every jump, place an Inertialization node after it.");
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AnimGraphNode_Base.h"
+#include "DayOne/Animation/AnimNode_MotionMatchingPlayer.h"
+#include "AnimGraphNode_MotionMatchingPlayer.generated.h"
+
+UCLASS()
+class DAYONEEDITOR_API UAnimGraphNode_MotionMatchingPlayer : public UAnimGraphNode_Base
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	FAnimNode_MotionMatchingPlayer Node;
+
+public:
+	virtual FText GetNodeTitle(ENodeTitleType::Type TitleType) const override;
+	virtual FText GetTooltipText() const override;
+};
@@ -0,0 +1,20 @@
+#include "AnimGraphNode_PelvisOffset.h"
+
+#define LOCTEXT_NAMESPACE "DayOneAnimGraphNodes"
+
+FText UAnimGraphNode_PelvisOffset::GetNodeTitle(ENodeTitleType::Type TitleType) const
+{
+	return GetControllerDescription();
+}
+
+FText UAnimGraphNode_PelvisOffset::GetTooltipText() const
+{
+	return LOCTEXT("PelvisOffsetTooltip", "Adds the pelvis offset of UBaseAnimInstance, scaled by its pelvis alpha, in world space.");
+}
+
+FText UAnimGraphNode_PelvisOffset::GetControllerDescription() const
+{
+	return LOCTEXT("PelvisOffset", "Pelvis Offset");
+}
+
+#undef LOCTEXT_NAMESPACE
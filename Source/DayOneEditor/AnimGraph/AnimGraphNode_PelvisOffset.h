@@ -0,0 +1,23 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AnimGraphNode_SkeletalControlBase.h"
+#include "DayOne/Animation/AnimNode_LocomotionIK.h"
+#include "AnimGraphNode_PelvisOffset.generated.h"
+
+UCLASS()
+class DAYONEEDITOR_API UAnimGraphNode_PelvisOffset : public UAnimGraphNode_SkeletalControlBase
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	FAnimNode_PelvisOffset Node;
+
+public:
+	virtual FText GetNodeTitle(ENodeTitleType::Type TitleType) const override;
+	virtual FText GetTooltipText() const override;
+
+protected:
+	virtual FText GetControllerDescription() const override;
+	virtual const FAnimNode_SkeletalControlBase* GetNode() const override { return &Node; }
+};